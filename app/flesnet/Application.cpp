@@ -18,6 +18,8 @@ Application::Application(Parameters const& par,
     : par_(par), signal_status_(signal_status) {
   zmq_context_ = std::unique_ptr<void, std::function<int(void*)>>(
       zmq_ctx_new(), zmq_ctx_destroy);
+  zmq_ctx_set(zmq_context_.get(), ZMQ_IO_THREADS,
+              static_cast<int>(par_.zeromq_io_threads()));
   create_input_channel_senders();
   create_timeslice_buffers();
   set_node();
@@ -65,17 +67,23 @@ void Application::create_timeslice_buffers() {
 
     if (par_.transport() == Transport::ZeroMQ) {
       std::unique_ptr<TimesliceBuilderZeromq> builder(
-          new TimesliceBuilderZeromq(i, *tsb, input_server_addresses,
-                                     output_size, par_.timeslice_size(),
-                                     par_.max_timeslice_number(),
-                                     signal_status_, zmq_context_.get()));
+          new TimesliceBuilderZeromq(
+              i, *tsb, input_server_addresses, output_size,
+              par_.timeslice_size(), par_.max_timeslice_number(),
+              par_.zeromq_requests(),
+              par_.assignment() == Assignment::Dynamic, signal_status_,
+              zmq_context_.get()));
       timeslice_builders_zeromq_.push_back(std::move(builder));
     } else if (par_.transport() == Transport::LibFabric) {
 #ifdef HAVE_LIBFABRIC
       std::unique_ptr<tl_libfabric::TimesliceBuilder> builder(
           new tl_libfabric::TimesliceBuilder(
               i, *tsb, par_.base_port() + i, input_size, par_.timeslice_size(),
-              signal_status_, false, par_.outputs().at(i).host));
+              signal_status_, par_.assignment() == Assignment::Dynamic,
+              par_.libfabric_rma_sync(), par_.libfabric_remote_cq_data(),
+              par_.libfabric_idle_wait(), par_.libfabric_spin_time(),
+              par_.libfabric_completeness_timeout(), false,
+              par_.outputs().at(i).host));
       timeslice_builders_.push_back(std::move(builder));
 #else
       L_(fatal) << "flesnet built without LIBFABRIC support";
@@ -152,6 +160,9 @@ void Application::create_input_channel_senders() {
       uint64_t delay_ns = 0;
       if (param.count("delay"))
         delay_ns = stoul(param.at("delay"));
+      uint32_t timestamp = 0;
+      if (param.count("timestamp"))
+        timestamp = stou(param.at("timestamp"));
 
       L_(info) << "input buffer " << index
                << " size: " << human_readable_count(UINT64_C(1) << datasize)
@@ -164,7 +175,7 @@ void Application::create_input_channel_senders() {
       data_sources_.push_back(std::unique_ptr<InputBufferReadInterface>(
           new FlesnetPatternGenerator(datasize, descsize, index, size_mean,
                                       (pattern != 0), (size_var != 0),
-                                      delay_ns)));
+                                      delay_ns, (timestamp != 0))));
     } else {
       L_(fatal) << "unknown input scheme: " << scheme;
     }
@@ -181,7 +192,8 @@ void Application::create_input_channel_senders() {
       std::unique_ptr<ComponentSenderZeromq> sender(new ComponentSenderZeromq(
           index, *(data_sources_.at(c).get()), listen_address,
           par_.timeslice_size(), overlap_size, par_.max_timeslice_number(),
-          signal_status_, zmq_context_.get()));
+          static_cast<uint32_t>(par_.outputs().size()), signal_status_,
+          zmq_context_.get()));
       component_senders_zeromq_.push_back(std::move(sender));
     } else if (par_.transport() == Transport::LibFabric) {
 #ifdef HAVE_LIBFABRIC
@@ -189,7 +201,11 @@ void Application::create_input_channel_senders() {
           new tl_libfabric::InputChannelSender(
               index, *(data_sources_.at(c).get()), output_hosts,
               output_services, par_.timeslice_size(), overlap_size,
-              par_.max_timeslice_number(), par_.inputs().at(c).host));
+              par_.max_timeslice_number(),
+              par_.assignment() == Assignment::Dynamic,
+              par_.libfabric_rma_sync(), par_.libfabric_remote_cq_data(),
+              par_.libfabric_idle_wait(), par_.libfabric_spin_time(),
+              par_.libfabric_failure_timeout(), par_.inputs().at(c).host));
       input_channel_senders_.push_back(std::move(sender));
 #else
       L_(fatal) << "flesnet built without LIBFABRIC support";
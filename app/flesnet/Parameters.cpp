@@ -48,6 +48,33 @@ std::ostream& operator<<(std::ostream& out, const Transport& transport) {
   return out;
 }
 
+std::istream& operator>>(std::istream& in, Assignment& assignment) {
+  std::string token;
+  in >> token;
+  std::transform(std::begin(token), std::end(token), std::begin(token),
+                 [](const unsigned char i) { return tolower(i); });
+
+  if (token == "roundrobin" || token == "r")
+    assignment = Assignment::RoundRobin;
+  else if (token == "dynamic" || token == "d")
+    assignment = Assignment::Dynamic;
+  else
+    throw po::invalid_option_value(token);
+  return in;
+}
+
+std::ostream& operator<<(std::ostream& out, const Assignment& assignment) {
+  switch (assignment) {
+  case Assignment::RoundRobin:
+    out << "RoundRobin";
+    break;
+  case Assignment::Dynamic:
+    out << "Dynamic";
+    break;
+  }
+  return out;
+}
+
 std::istream& operator>>(std::istream& in, InterfaceSpecification& ifspec) {
   in >> ifspec.full_uri;
   try {
@@ -137,6 +164,65 @@ void Parameters::parse_options(int argc, char* argv[]) {
                  ->value_name("<id>"),
              "select transport implementation; possible values "
              "(case-insensitive) are: RDMA, LibFabric, ZeroMQ");
+  config_add("zeromq-requests",
+             po::value<uint32_t>(&zeromq_requests_)
+                 ->default_value(zeromq_requests_)
+                 ->value_name("<n>"),
+             "number of outstanding timeslice component requests per input "
+             "(ZeroMQ transport)");
+  config_add("timeslice-assignment",
+             po::value<Assignment>(&assignment_)
+                 ->default_value(assignment_)
+                 ->value_name("<id>"),
+             "select timeslice to compute node assignment (ZeroMQ and "
+             "LibFabric transports); possible values (case-insensitive) "
+             "are: RoundRobin, Dynamic");
+  config_add("zeromq-io-threads",
+             po::value<uint32_t>(&zeromq_io_threads_)
+                 ->default_value(zeromq_io_threads_)
+                 ->value_name("<n>"),
+             "number of ZeroMQ I/O threads (ZeroMQ transport)");
+  config_add("libfabric-rma-sync",
+             po::value<bool>(&libfabric_rma_sync_)
+                 ->default_value(libfabric_rma_sync_)
+                 ->implicit_value(true)
+                 ->value_name("<bool>"),
+             "exchange buffer positions by one-sided RDMA writes instead of "
+             "status messages (LibFabric transport)");
+  config_add("libfabric-remote-cq-data",
+             po::value<bool>(&libfabric_remote_cq_data_)
+                 ->default_value(libfabric_remote_cq_data_)
+                 ->implicit_value(true)
+                 ->value_name("<bool>"),
+             "signal timeslice component arrival by remote CQ data "
+             "(LibFabric transport)");
+  config_add("libfabric-idle-wait",
+             po::value<bool>(&libfabric_idle_wait_)
+                 ->default_value(libfabric_idle_wait_)
+                 ->implicit_value(true)
+                 ->value_name("<bool>"),
+             "block on completion and connection events instead of busy "
+             "polling when idle (LibFabric transport)");
+  config_add("libfabric-spin-time",
+             po::value<uint32_t>(&libfabric_spin_time_)
+                 ->default_value(libfabric_spin_time_)
+                 ->value_name("<us>"),
+             "idle time in microseconds before blocking (LibFabric "
+             "transport, with libfabric-idle-wait)");
+  config_add("libfabric-failure-timeout",
+             po::value<uint32_t>(&libfabric_failure_timeout_)
+                 ->default_value(libfabric_failure_timeout_)
+                 ->value_name("<ms>"),
+             "continue with the remaining compute nodes if one does not "
+             "answer within this time or disconnects, 0 to disable "
+             "(LibFabric transport)");
+  config_add("libfabric-completeness-timeout",
+             po::value<uint32_t>(&libfabric_completeness_timeout_)
+                 ->default_value(libfabric_completeness_timeout_)
+                 ->value_name("<ms>"),
+             "publish a timeslice without the missing components if it is "
+             "not complete within this time after its first component "
+             "arrived, 0 to disable (LibFabric transport)");
   config_add("monitoring-address",
              po::value<std::string>(&monitoringdb.datastring_)
                  ->default_value(monitoringdb.datastring_)
@@ -187,6 +273,33 @@ void Parameters::parse_options(int argc, char* argv[]) {
     throw ParametersException("timeslice size cannot be zero");
   }
 
+  if (zeromq_requests_ < 1) {
+    throw ParametersException("number of zeromq requests cannot be zero");
+  }
+
+  if (zeromq_io_threads_ < 1) {
+    throw ParametersException("number of zeromq I/O threads cannot be zero");
+  }
+
+  if (libfabric_rma_sync_ && assignment_ == Assignment::Dynamic) {
+    throw ParametersException(
+        "dynamic timeslice assignment cannot be combined with RMA sync");
+  }
+
+  if (transport_ == Transport::LibFabric &&
+      assignment_ == Assignment::Dynamic && libfabric_failure_timeout_ == 0) {
+    // without a timeout, a lost assignment would stall the other inputs
+    throw ParametersException(
+        "dynamic timeslice assignment requires a libfabric failure timeout");
+  }
+
+  if (transport_ != Transport::LibFabric &&
+      libfabric_completeness_timeout_ > 0) {
+    // the other timeslice builders wait for every component
+    throw ParametersException(
+        "completeness timeout is only supported by the LibFabric transport");
+  }
+
 #ifndef HAVE_RDMA
   if (transport_ == Transport::RDMA) {
     throw ParametersException("flesnet built without RDMA support");
@@ -31,6 +31,12 @@ enum class Transport { RDMA, LibFabric, ZeroMQ };
 std::istream& operator>>(std::istream& in, Transport& transport);
 std::ostream& operator<<(std::ostream& out, const Transport& transport);
 
+/// Timeslice to compute node assignment enum.
+enum class Assignment { RoundRobin, Dynamic };
+
+std::istream& operator>>(std::istream& in, Assignment& assignment);
+std::ostream& operator<<(std::ostream& out, const Assignment& assignment);
+
 /// Global run parameter class.
 /** A Parameters object stores the information given on the command
     line or in a configuration file. */
@@ -61,6 +67,40 @@ public:
   /// Retrieve the selected transport implementation.
   Transport transport() const { return transport_; }
 
+  /// Retrieve the number of outstanding ZeroMQ requests per input.
+  uint32_t zeromq_requests() const { return zeromq_requests_; }
+
+  /// Retrieve the timeslice to compute node assignment.
+  Assignment assignment() const { return assignment_; }
+
+  /// Retrieve the number of ZeroMQ I/O threads.
+  uint32_t zeromq_io_threads() const { return zeromq_io_threads_; }
+
+  /// Retrieve whether LibFabric buffer positions are exchanged by RDMA
+  /// writes.
+  bool libfabric_rma_sync() const { return libfabric_rma_sync_; }
+
+  /// Retrieve whether LibFabric timeslice component arrival is signaled by
+  /// remote CQ data.
+  bool libfabric_remote_cq_data() const { return libfabric_remote_cq_data_; }
+
+  /// Retrieve whether LibFabric event loops block when idle.
+  bool libfabric_idle_wait() const { return libfabric_idle_wait_; }
+
+  /// Retrieve the LibFabric idle time before blocking (in microseconds).
+  uint32_t libfabric_spin_time() const { return libfabric_spin_time_; }
+
+  /// Retrieve the LibFabric compute node failure timeout (in milliseconds).
+  uint32_t libfabric_failure_timeout() const {
+    return libfabric_failure_timeout_;
+  }
+
+  /// Retrieve the LibFabric timeslice completeness timeout (in
+  /// milliseconds).
+  uint32_t libfabric_completeness_timeout() const {
+    return libfabric_completeness_timeout_;
+  }
+
   /// Retrieve the list of participating inputs.
   std::vector<InterfaceSpecification> const inputs() const { return inputs_; }
 
@@ -112,6 +152,36 @@ private:
   /// The selected transport implementation.
   Transport transport_ = Transport::RDMA;
 
+  /// The number of outstanding ZeroMQ requests per input.
+  uint32_t zeromq_requests_ = 4;
+
+  /// The timeslice to compute node assignment.
+  Assignment assignment_ = Assignment::RoundRobin;
+
+  /// The number of ZeroMQ I/O threads.
+  uint32_t zeromq_io_threads_ = 1;
+
+  /// Whether LibFabric buffer positions are exchanged by RDMA writes.
+  bool libfabric_rma_sync_ = false;
+
+  /// Whether LibFabric timeslice component arrival is signaled by remote CQ
+  /// data.
+  bool libfabric_remote_cq_data_ = false;
+
+  /// Whether LibFabric event loops block when idle.
+  bool libfabric_idle_wait_ = false;
+
+  /// The LibFabric idle time before blocking (in microseconds).
+  uint32_t libfabric_spin_time_ = 100;
+
+  /// The LibFabric compute node failure timeout (in milliseconds, zero
+  /// disables failure handling).
+  uint32_t libfabric_failure_timeout_ = 0;
+
+  /// The LibFabric timeslice completeness timeout (in milliseconds, zero
+  /// disables partial timeslices).
+  uint32_t libfabric_completeness_timeout_ = 0;
+
   /// The list of participating inputs.
   std::vector<InterfaceSpecification> inputs_;
 
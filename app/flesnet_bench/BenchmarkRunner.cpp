@@ -0,0 +1,148 @@
+#include "BenchmarkRunner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <regex>
+#include <thread>
+
+double BenchmarkResult::percentile(double p) const {
+  if (ns_per_op.empty()) {
+    return 0;
+  }
+  // linear interpolation between closest ranks
+  double rank = p / 100.0 * static_cast<double>(ns_per_op.size() - 1);
+  auto lower = static_cast<std::size_t>(std::floor(rank));
+  std::size_t upper = std::min(lower + 1, ns_per_op.size() - 1);
+  double fraction = rank - static_cast<double>(lower);
+  return ns_per_op[lower] + fraction * (ns_per_op[upper] - ns_per_op[lower]);
+}
+
+double BenchmarkResult::mean() const {
+  if (ns_per_op.empty()) {
+    return 0;
+  }
+  return std::accumulate(ns_per_op.begin(), ns_per_op.end(), 0.0) /
+         static_cast<double>(ns_per_op.size());
+}
+
+double BenchmarkResult::mb_per_s() const {
+  double median = percentile(50);
+  if (median <= 0) {
+    return 0;
+  }
+  return bytes_per_op / median * 1e3;
+}
+
+void BenchmarkRunner::add(std::string name, Setup setup) {
+  entries_.push_back({std::move(name), std::move(setup)});
+}
+
+std::vector<std::string> BenchmarkRunner::names() const {
+  std::vector<std::string> result;
+  for (const auto& entry : entries_) {
+    result.push_back(entry.name);
+  }
+  return result;
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(
+    const std::string& filter,
+    std::size_t samples,
+    double sample_time_s,
+    const std::function<void(const BenchmarkResult&)>& callback) {
+  std::regex re(filter);
+  std::vector<BenchmarkResult> results;
+  for (const auto& entry : entries_) {
+    if (!std::regex_search(entry.name, re)) {
+      continue;
+    }
+    results.push_back(run_single(entry, samples, sample_time_s));
+    if (callback) {
+      callback(results.back());
+    }
+  }
+  return results;
+}
+
+BenchmarkResult BenchmarkRunner::run_single(const Entry& entry,
+                                            std::size_t samples,
+                                            double sample_time_s) {
+  using clock = std::chrono::steady_clock;
+
+  Body body = entry.setup();
+  auto timed = [&body](uint64_t iterations, uint64_t& bytes) {
+    auto begin = clock::now();
+    bytes = body(iterations);
+    auto end = clock::now();
+    return std::chrono::duration<double>(end - begin).count();
+  };
+
+  // first call may include one-time initialization
+  uint64_t bytes = 0;
+  timed(1, bytes);
+
+  // calibrate number of iterations per sample
+  uint64_t iterations = 1;
+  for (;;) {
+    double t = timed(iterations, bytes);
+    if (t >= sample_time_s || iterations >= (UINT64_C(1) << 40)) {
+      break;
+    }
+    double factor = (t > 0) ? 1.2 * sample_time_s / t : 10;
+    factor = std::max(2.0, std::min(10.0, factor));
+    iterations = static_cast<uint64_t>(static_cast<double>(iterations) *
+                                       factor);
+  }
+
+  // warm-up sample with calibrated size
+  timed(iterations, bytes);
+
+  BenchmarkResult result;
+  result.name = entry.name;
+  result.iterations = iterations;
+  result.bytes_per_op =
+      static_cast<double>(bytes) / static_cast<double>(iterations);
+  for (std::size_t s = 0; s < samples; ++s) {
+    double t = timed(iterations, bytes);
+    result.ns_per_op.push_back(t * 1e9 / static_cast<double>(iterations));
+  }
+  std::sort(result.ns_per_op.begin(), result.ns_per_op.end());
+  return result;
+}
+
+void BenchmarkRunner::write_csv(std::ostream& out,
+                                const std::vector<BenchmarkResult>& results) {
+  out << "benchmark,samples,iterations,bytes_per_op,ns_min,ns_p50,ns_p90,"
+         "ns_p99,ns_max,ns_mean,mb_per_s\n";
+  for (const auto& r : results) {
+    out << r.name << "," << r.ns_per_op.size() << "," << r.iterations << ","
+        << r.bytes_per_op << "," << r.percentile(0) << "," << r.percentile(50)
+        << "," << r.percentile(90) << "," << r.percentile(99) << ","
+        << r.percentile(100) << "," << r.mean() << "," << r.mb_per_s()
+        << "\n";
+  }
+}
+
+void BenchmarkRunner::write_json(std::ostream& out,
+                                 const std::vector<BenchmarkResult>& results,
+                                 const std::string& revision) {
+  out << "{\n  \"revision\": \"" << revision << "\",\n"
+      << "  \"hardware_threads\": " << std::thread::hardware_concurrency()
+      << ",\n  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << r.name
+        << "\", \"samples\": " << r.ns_per_op.size()
+        << ", \"iterations\": " << r.iterations
+        << ", \"bytes_per_op\": " << r.bytes_per_op
+        << ", \"ns_min\": " << r.percentile(0)
+        << ", \"ns_p50\": " << r.percentile(50)
+        << ", \"ns_p90\": " << r.percentile(90)
+        << ", \"ns_p99\": " << r.percentile(99)
+        << ", \"ns_max\": " << r.percentile(100)
+        << ", \"ns_mean\": " << r.mean() << ", \"mb_per_s\": " << r.mb_per_s()
+        << "}";
+  }
+  out << "\n  ]\n}\n";
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// Timing statistics of a single micro-benchmark.
+struct BenchmarkResult {
+  std::string name;
+
+  /// Number of operations per timed sample
+  uint64_t iterations = 0;
+
+  /// Bytes processed per operation (0 if not applicable)
+  double bytes_per_op = 0;
+
+  /// Time per operation of each sample (ns), sorted in ascending order
+  std::vector<double> ns_per_op;
+
+  /// Retrieve the given percentile (0..100) of the time per operation.
+  double percentile(double p) const;
+
+  /// Retrieve the mean time per operation.
+  double mean() const;
+
+  /// Retrieve the throughput at the median time per operation (MB/s).
+  double mb_per_s() const;
+};
+
+/**
+ * \brief Runner for repeatable micro-benchmarks.
+ *
+ * A benchmark is registered as a setup function that prepares its state and
+ * returns the benchmark body. The body is called with a number of
+ * operations to run and returns the number of bytes processed. The number
+ * of operations per sample is calibrated to reach a minimum sample time,
+ * then a fixed number of samples is taken after a warm-up sample.
+ */
+class BenchmarkRunner {
+public:
+  using Body = std::function<uint64_t(uint64_t iterations)>;
+  using Setup = std::function<Body()>;
+
+  /// Register a benchmark.
+  void add(std::string name, Setup setup);
+
+  /// Retrieve the names of all registered benchmarks.
+  std::vector<std::string> names() const;
+
+  /**
+   * \brief Run all benchmarks with names matching the regular expression
+   * `filter`.
+   *
+   * The `callback` is called after each completed benchmark.
+   */
+  std::vector<BenchmarkResult>
+  run(const std::string& filter,
+      std::size_t samples,
+      double sample_time_s,
+      const std::function<void(const BenchmarkResult&)>& callback = nullptr);
+
+  /// Write results as CSV table.
+  static void write_csv(std::ostream& out,
+                        const std::vector<BenchmarkResult>& results);
+
+  /// Write results as JSON document, including the given revision string.
+  static void write_json(std::ostream& out,
+                         const std::vector<BenchmarkResult>& results,
+                         const std::string& revision);
+
+private:
+  struct Entry {
+    std::string name;
+    Setup setup;
+  };
+
+  static BenchmarkResult
+  run_single(const Entry& entry, std::size_t samples, double sample_time_s);
+
+  std::vector<Entry> entries_;
+};
@@ -0,0 +1,545 @@
+#include "CoreBenchmarks.hpp"
+#include "Crc32c.hpp"
+#include "DualRingBuffer.hpp"
+#include "FlesnetPatternChecker.hpp"
+#include "FlesnetPatternGenerator.hpp"
+#include "FlesnetPatternKernel.hpp"
+#include "MicrosliceReceiver.hpp"
+#include "MicrosliceTransmitter.hpp"
+#include "RingBuffer.hpp"
+#include "StorableTimeslice.hpp"
+#include "TimesliceAnalyzer.hpp"
+#include "TimesliceBuffer.hpp"
+#include "TimesliceMerger.hpp"
+#include "TimesliceReceiver.hpp"
+#include "interface.h" // crcutil_interface
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+/// Sink for computed values to keep them from being optimized away.
+volatile uint64_t value_sink;
+
+std::vector<uint8_t> random_bytes(std::size_t size) {
+  std::mt19937_64 rng(42);
+  std::vector<uint8_t> data(size);
+  for (auto& b : data) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return data;
+}
+
+std::string shm_identifier(const std::string& name) {
+  return "flesnet_bench_" + name + "_" + std::to_string(getpid()) + "_";
+}
+
+/// In-memory input buffer connecting a writer and a reader.
+class LoopbackBuffer : public InputBufferWriteInterface,
+                       public InputBufferReadInterface {
+public:
+  LoopbackBuffer(std::size_t data_size_exp, std::size_t desc_size_exp)
+      : data_(data_size_exp), desc_(desc_size_exp),
+        data_view_(data_.ptr(), data_size_exp),
+        desc_view_(desc_.ptr(), desc_size_exp) {}
+
+  RingBufferView<uint8_t>& data_buffer() override { return data_view_; }
+  RingBufferView<fles::MicrosliceDescriptor>& desc_buffer() override {
+    return desc_view_;
+  }
+  DualIndex get_read_index() override { return read_index_; }
+  void set_read_index(DualIndex index) override { read_index_ = index; }
+  DualIndex get_write_index() override { return write_index_; }
+  void set_write_index(DualIndex index) override { write_index_ = index; }
+  bool get_eof() override { return eof_; }
+  void set_eof(bool eof) override { eof_ = eof; }
+
+private:
+  RingBuffer<uint8_t> data_;
+  RingBuffer<fles::MicrosliceDescriptor> desc_;
+  RingBufferView<uint8_t> data_view_;
+  RingBufferView<fles::MicrosliceDescriptor> desc_view_;
+  DualIndex read_index_{0, 0};
+  DualIndex write_index_{0, 0};
+  bool eof_ = false;
+};
+
+/// Copy `size` bytes to the ring buffer at `offset`, handling wrap-around.
+void copy_to_ring(RingBufferView<uint8_t>& ring,
+                  uint64_t offset,
+                  const uint8_t* src,
+                  std::size_t size) {
+  std::size_t pos = offset & ring.size_mask();
+  std::size_t part1 = std::min(size, ring.bytes() - pos);
+  std::memcpy(ring.ptr() + pos, src, part1);
+  std::memcpy(ring.ptr(), src + part1, size - part1);
+}
+
+/// Copy `size` bytes from the ring buffer at `offset`.
+void copy_from_ring(RingBufferView<uint8_t>& ring,
+                    uint64_t offset,
+                    uint8_t* dst,
+                    std::size_t size) {
+  std::size_t pos = offset & ring.size_mask();
+  std::size_t part1 = std::min(size, ring.bytes() - pos);
+  std::memcpy(dst, ring.ptr() + pos, part1);
+  std::memcpy(dst + part1, ring.ptr(), size - part1);
+}
+
+void add_ring_buffer_benchmarks(BenchmarkRunner& runner) {
+  runner.add("ring_buffer/write_read_u64", [] {
+    auto rb = std::make_shared<RingBuffer<uint64_t>>(16);
+    auto pos = std::make_shared<uint64_t>(0);
+    return [rb, pos](uint64_t iterations) {
+      uint64_t sum = 0;
+      uint64_t p = *pos;
+      for (uint64_t i = 0; i < iterations; ++i, ++p) {
+        rb->at(p) = i;
+        sum += rb->at(p - 1024);
+      }
+      *pos = p;
+      value_sink = sum;
+      return iterations * sizeof(uint64_t);
+    };
+  });
+
+  for (std::size_t size : {64, 1024, 16384}) {
+    runner.add("dual_ring_buffer/put_get_" + std::to_string(size), [size] {
+      auto buffer = std::make_shared<LoopbackBuffer>(22, 14);
+      auto content = std::make_shared<std::vector<uint8_t>>(random_bytes(size));
+      auto received = std::make_shared<std::vector<uint8_t>>(size);
+      return [buffer, content, received, size](uint64_t iterations) {
+        InputBufferWriteInterface& writer = *buffer;
+        InputBufferReadInterface& reader = *buffer;
+        for (uint64_t i = 0; i < iterations; ++i) {
+          // writer side
+          DualIndex wi = reader.get_write_index();
+          fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+          desc.idx = wi.desc;
+          desc.offset = wi.data;
+          desc.size = static_cast<uint32_t>(size);
+          copy_to_ring(writer.data_buffer(), wi.data, content->data(), size);
+          writer.desc_buffer().at(wi.desc) = desc;
+          writer.set_write_index({wi.desc + 1, wi.data + size});
+
+          // reader side
+          DualIndex ri = reader.get_read_index();
+          const fles::MicrosliceDescriptor& rd =
+              reader.desc_buffer().at(ri.desc);
+          copy_from_ring(reader.data_buffer(), rd.offset, received->data(),
+                         rd.size);
+          reader.set_read_index({ri.desc + 1, rd.offset + rd.size});
+        }
+        value_sink = received->back();
+        return iterations * size;
+      };
+    });
+  }
+}
+
+void add_microslice_benchmarks(BenchmarkRunner& runner) {
+  for (std::size_t size : {1024, 65536}) {
+    for (bool crc : {false, true}) {
+      std::string name = "microslice/transmit_receive_" +
+                         std::to_string(size) + (crc ? "_crc" : "");
+      runner.add(name, [size, crc] {
+        auto buffer = std::make_shared<LoopbackBuffer>(24, 14);
+        auto transmitter =
+            std::make_shared<fles::MicrosliceTransmitter>(*buffer);
+        auto receiver = std::make_shared<fles::MicrosliceReceiver>(*buffer);
+        fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+        if (crc) {
+          desc.flags = static_cast<uint16_t>(fles::MicrosliceFlags::CrcValid);
+        }
+        auto ms = std::make_shared<fles::StorableMicroslice>(
+            desc, random_bytes(size));
+        ms->initialize_crc();
+        return [buffer, transmitter, receiver, ms, size](uint64_t iterations) {
+          for (uint64_t i = 0; i < iterations; ++i) {
+            transmitter->put(ms);
+            value_sink = receiver->get()->desc().size;
+          }
+          if (receiver->crc_errors() != 0) {
+            throw std::runtime_error("unexpected crc errors");
+          }
+          return iterations * size;
+        };
+      });
+    }
+  }
+}
+
+void add_crc_benchmarks(BenchmarkRunner& runner) {
+  const std::size_t size = 1 << 20;
+  runner.add("crc32c/copy_then_crc32c", [size] {
+    auto data = std::make_shared<std::vector<uint8_t>>(random_bytes(size));
+    auto copy = std::make_shared<std::vector<uint8_t>>(size);
+    return [data, copy, size](uint64_t iterations) {
+      for (uint64_t i = 0; i < iterations; ++i) {
+        std::copy_n(data->data(), size, copy->data());
+        value_sink = fles::crc32c(copy->data(), size);
+      }
+      return iterations * size;
+    };
+  });
+
+  runner.add("crc32c/copy_crc32c", [size] {
+    auto data = std::make_shared<std::vector<uint8_t>>(random_bytes(size));
+    auto copy = std::make_shared<std::vector<uint8_t>>(size);
+    return [data, copy, size](uint64_t iterations) {
+      for (uint64_t i = 0; i < iterations; ++i) {
+        value_sink = fles::copy_crc32c(copy->data(), data->data(), size);
+      }
+      return iterations * size;
+    };
+  });
+  for (bool pclmul : {false, true}) {
+    if (pclmul && !crcutil_interface::CRC::IsPCLMULAvailable()) {
+      continue;
+    }
+    std::string name =
+        std::string("crcutil/crc32c_") + (pclmul ? "pclmul" : "sse42");
+    runner.add(name, [pclmul, size] {
+      auto data = std::make_shared<std::vector<uint8_t>>(random_bytes(size));
+      std::shared_ptr<crcutil_interface::CRC> crc(
+          crcutil_interface::CRC::Create(
+              0x82f63b78, 0, 32, true, 0, 0, 0,
+              crcutil_interface::CRC::IsSSE42Available(), pclmul, nullptr),
+          [](crcutil_interface::CRC* c) { c->Delete(); });
+      return [data, crc, size](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) {
+          crcutil_interface::UINT64 crc64 = 0;
+          crc->Compute(data->data(), size, &crc64);
+          value_sink = crc64;
+        }
+        return iterations * size;
+      };
+    });
+  }
+}
+
+/// Timeslice of 4 components with 10 microslices of 16 KiB each.
+std::shared_ptr<fles::StorableTimeslice> make_timeslice() {
+  const uint32_t num_components = 4;
+  const uint32_t num_microslices = 10;
+  auto ts = std::make_shared<fles::StorableTimeslice>(num_microslices, 0);
+  std::vector<uint8_t> content = random_bytes(16384);
+  for (uint32_t c = 0; c < num_components; ++c) {
+    ts->append_component(num_microslices);
+    for (uint32_t m = 0; m < num_microslices; ++m) {
+      fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+      desc.idx = m;
+      desc.size = static_cast<uint32_t>(content.size());
+      ts->append_microslice(c, m, desc, content.data());
+    }
+  }
+  return ts;
+}
+
+uint64_t content_bytes(const fles::Timeslice& ts) {
+  uint64_t bytes = 0;
+  for (uint64_t c = 0; c < ts.num_components(); ++c) {
+    for (uint64_t m = 0; m < ts.num_microslices(c); ++m) {
+      bytes += ts.descriptor(c, m).size;
+    }
+  }
+  return bytes;
+}
+
+void add_archive_benchmarks(BenchmarkRunner& runner) {
+  // a new archive is used per item to avoid object tracking across items
+  runner.add("archive/serialize_timeslice", [] {
+    auto ts = make_timeslice();
+    auto stream = std::make_shared<std::stringstream>();
+    return [ts, stream](uint64_t iterations) {
+      for (uint64_t i = 0; i < iterations; ++i) {
+        // overwrite the previous item, stream size remains constant
+        stream->seekp(0);
+        boost::archive::binary_oarchive oa(*stream,
+                                           boost::archive::no_header);
+        oa << *ts;
+      }
+      return iterations * content_bytes(*ts);
+    };
+  });
+
+  runner.add("archive/deserialize_timeslice", [] {
+    auto stream = std::make_shared<std::stringstream>();
+    {
+      boost::archive::binary_oarchive oa(*stream, boost::archive::no_header);
+      oa << *make_timeslice();
+    }
+    auto ts = std::make_shared<fles::StorableTimeslice>(0);
+    return [stream, ts](uint64_t iterations) {
+      for (uint64_t i = 0; i < iterations; ++i) {
+        stream->seekg(0);
+        boost::archive::binary_iarchive ia(*stream, boost::archive::no_header);
+        ia >> *ts;
+      }
+      return iterations * content_bytes(*ts);
+    };
+  });
+}
+
+/// Message timestamp is the 64-bit message value itself.
+struct WordTime {
+  uint64_t operator()(const uint8_t* message,
+                      const fles::MicrosliceDescriptor& /* desc */) const {
+    uint64_t word;
+    std::memcpy(&word, message, sizeof(word));
+    return word;
+  }
+};
+
+using WordDecoder = fles::FixedSizeMessageDecoder<sizeof(uint64_t), WordTime>;
+using IndexedWordDecoder =
+    fles::FixedSizeMessageDecoder<sizeof(uint64_t), WordTime, true>;
+
+/// Timeslice of 16 components with 64 microslices of 2048 ascending
+/// timestamps each.
+std::shared_ptr<fles::StorableTimeslice> make_merge_timeslice() {
+  const uint32_t num_components = 16;
+  const uint64_t num_microslices = 64;
+  std::mt19937_64 rng(99);
+  auto ts = std::make_shared<fles::StorableTimeslice>(
+      static_cast<uint32_t>(num_microslices), 0);
+  for (uint32_t c = 0; c < num_components; ++c) {
+    ts->append_component(num_microslices);
+    for (uint64_t m = 0; m < num_microslices; ++m) {
+      std::vector<uint64_t> words(2048);
+      for (auto& w : words) {
+        w = m * 1000 + rng() % 1000;
+      }
+      std::sort(words.begin(), words.end());
+      fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+      desc.idx = m * 1000;
+      desc.size = static_cast<uint32_t>(words.size() * sizeof(uint64_t));
+      ts->append_microslice(c, m, desc,
+                            reinterpret_cast<const uint8_t*>(words.data()));
+    }
+  }
+  return ts;
+}
+
+void add_merger_benchmarks(BenchmarkRunner& runner) {
+  runner.add("merger/serial", [] {
+    auto ts = make_merge_timeslice();
+    return [ts](uint64_t iterations) {
+      for (uint64_t i = 0; i < iterations; ++i) {
+        uint64_t last = 0;
+        fles::TimesliceMerger<WordDecoder> merger(*ts);
+        merger.for_each([&last](const fles::MergedMessage& m) {
+          if (m.time < last) {
+            throw std::runtime_error("merged messages out of order");
+          }
+          last = m.time;
+        });
+        value_sink = last;
+      }
+      return iterations * content_bytes(*ts);
+    };
+  });
+
+  runner.add("merger/parallel_4", [] {
+    auto ts = make_merge_timeslice();
+    return [ts](uint64_t iterations) {
+      const std::vector<uint64_t> split_times{16000, 32000, 48000};
+      for (uint64_t i = 0; i < iterations; ++i) {
+        uint64_t last[4] = {0, 0, 0, 0};
+        fles::merge_parallel<IndexedWordDecoder>(
+            *ts, split_times,
+            [&last](std::size_t r, const fles::MergedMessage& m) {
+              last[r] = std::max(last[r], m.time);
+            });
+        value_sink = last[3];
+      }
+      return iterations * content_bytes(*ts);
+    };
+  });
+}
+
+void add_pattern_benchmarks(BenchmarkRunner& runner) {
+  const std::size_t words = 8192;
+  const std::pair<flesnet_pattern::Isa, std::string> isas[] = {
+      {flesnet_pattern::Isa::Scalar, "scalar"},
+      {flesnet_pattern::Isa::AVX2, "avx2"},
+      {flesnet_pattern::Isa::AVX512, "avx512"}};
+  for (const auto& isa : isas) {
+    if (!flesnet_pattern::is_supported(isa.first)) {
+      continue;
+    }
+    flesnet_pattern::Isa i = isa.first;
+    runner.add("pattern/fill_" + isa.second, [i, words] {
+      auto buffer = std::make_shared<std::vector<uint64_t>>(words);
+      return [i, buffer, words](uint64_t iterations) {
+        uint64_t x = 0;
+        for (uint64_t n = 0; n < iterations; ++n) {
+          x ^= flesnet_pattern::fill(buffer->data(), words, 7, 0, i);
+        }
+        value_sink = x;
+        return iterations * words * sizeof(uint64_t);
+      };
+    });
+    runner.add("pattern/check_" + isa.second, [i, words] {
+      auto buffer = std::make_shared<std::vector<uint64_t>>(words);
+      flesnet_pattern::fill(buffer->data(), words, 7, 0);
+      return [i, buffer, words](uint64_t iterations) {
+        for (uint64_t n = 0; n < iterations; ++n) {
+          uint64_t x = 0;
+          if (!flesnet_pattern::check(buffer->data(), words, 7, 0, x, i)) {
+            throw std::runtime_error("pattern check failed");
+          }
+          value_sink = x;
+        }
+        return iterations * words * sizeof(uint64_t);
+      };
+    });
+  }
+
+  runner.add("pattern/generate_receive_check_16384", [] {
+    auto generator =
+        std::make_shared<FlesnetPatternGenerator>(20, 10, 0, 16384, true);
+    auto receiver = std::make_shared<fles::MicrosliceReceiver>(*generator);
+    auto checker = std::make_shared<FlesnetPatternChecker>(0);
+    return [generator, receiver, checker](uint64_t iterations) {
+      uint64_t bytes = 0;
+      for (uint64_t i = 0; i < iterations; ++i) {
+        auto ms = receiver->get();
+        if (!checker->check(*ms)) {
+          throw std::runtime_error("pattern check failed");
+        }
+        bytes += ms->desc().size;
+      }
+      return bytes;
+    };
+  });
+}
+
+/// Timeslice of 16 components with 10 microslices of FLESnet ramp pattern
+/// content (64 KiB each).
+std::shared_ptr<fles::StorableTimeslice> make_pattern_timeslice() {
+  const uint32_t num_components = 16;
+  const uint32_t num_microslices = 10;
+  auto ts = std::make_shared<fles::StorableTimeslice>(num_microslices, 0);
+  std::vector<uint64_t> data(8192);
+  for (uint32_t c = 0; c < num_components; ++c) {
+    ts->append_component(num_microslices);
+    for (uint32_t m = 0; m < num_microslices; ++m) {
+      fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+      desc.hdr_id =
+          static_cast<uint8_t>(fles::HeaderFormatIdentifier::Standard);
+      desc.sys_id = static_cast<uint8_t>(fles::SubsystemIdentifier::FLES);
+      desc.sys_ver =
+          static_cast<uint8_t>(fles::SubsystemFormatFLES::BasicRampPattern);
+      desc.idx = m;
+      desc.size = static_cast<uint32_t>(data.size() * sizeof(uint64_t));
+      desc.crc = flesnet_pattern::fold(
+          flesnet_pattern::fill(data.data(), data.size(), c, 0));
+      ts->append_microslice(c, m, desc,
+                            reinterpret_cast<const uint8_t*>(data.data()));
+    }
+  }
+  return ts;
+}
+
+/// Timeslice analyzer together with its output stream.
+struct AnalyzerState {
+  explicit AnalyzerState(unsigned num_threads)
+      : analyzer(UINT64_MAX, out, "", num_threads) {}
+  std::ostringstream out;
+  TimesliceAnalyzer analyzer;
+};
+
+void add_analyzer_benchmarks(BenchmarkRunner& runner) {
+  for (unsigned threads : {1u, 4u}) {
+    std::string name =
+        "analyzer/check_timeslice_" + std::to_string(threads) + "_threads";
+    runner.add(name, [threads] {
+      auto ts = make_pattern_timeslice();
+      auto state = std::make_shared<AnalyzerState>(threads);
+      return [ts, state](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) {
+          state->analyzer.put(ts);
+        }
+        return iterations * content_bytes(*ts);
+      };
+    });
+  }
+}
+
+void add_timeslice_buffer_benchmarks(BenchmarkRunner& runner) {
+  const uint32_t data_size_exp = 20;
+  const uint32_t desc_size_exp = 8;
+  const uint32_t num_components = 4;
+
+  // writing the component descriptors to the shared memory index
+  runner.add("timeslice_buffer/desc_write", [=] {
+    auto buffer = std::make_shared<TimesliceBuffer>(
+        shm_identifier("desc"), data_size_exp, desc_size_exp, num_components);
+    auto pos = std::make_shared<uint64_t>(0);
+    return [buffer, pos, num_components](uint64_t iterations) {
+      uint64_t p = *pos;
+      for (uint64_t i = 0; i < iterations; ++i, ++p) {
+        for (uint32_t c = 0; c < num_components; ++c) {
+          buffer->get_desc(c, p) = {p, p * 64, 64, 1};
+        }
+      }
+      *pos = p;
+      return iterations * num_components *
+             sizeof(fles::TimesliceComponentDescriptor);
+    };
+  });
+
+  // complete round trip: write index entries, send work item, receive and
+  // release timeslice, receive completion
+  runner.add("timeslice_buffer/work_item_completion", [=] {
+    std::string id = shm_identifier("ipc");
+    auto buffer = std::make_shared<TimesliceBuffer>(id, data_size_exp,
+                                                    desc_size_exp,
+                                                    num_components);
+    auto receiver = std::make_shared<fles::TimesliceReceiver>(id);
+    auto pos = std::make_shared<uint64_t>(0);
+    return [=](uint64_t iterations) {
+      uint64_t p = *pos;
+      for (uint64_t i = 0; i < iterations; ++i, ++p) {
+        for (uint32_t c = 0; c < num_components; ++c) {
+          buffer->get_desc(c, p) = {p, 0, 0, 0};
+        }
+        fles::TimesliceWorkItem wi = {{p, p, 0, num_components},
+                                      data_size_exp,
+                                      desc_size_exp,
+                                      0,
+                                      {}};
+        buffer->send_work_item(wi);
+        auto ts = receiver->get();
+        value_sink = ts->index();
+        ts.reset();
+        fles::TimesliceCompletion completion;
+        while (!buffer->try_receive_completion(completion)) {
+        }
+      }
+      *pos = p;
+      return UINT64_C(0);
+    };
+  });
+}
+
+} // namespace
+
+void add_core_benchmarks(BenchmarkRunner& runner) {
+  add_ring_buffer_benchmarks(runner);
+  add_crc_benchmarks(runner);
+  add_microslice_benchmarks(runner);
+  add_archive_benchmarks(runner);
+  add_merger_benchmarks(runner);
+  add_pattern_benchmarks(runner);
+  add_analyzer_benchmarks(runner);
+  add_timeslice_buffer_benchmarks(runner);
+}
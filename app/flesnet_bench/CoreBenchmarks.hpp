@@ -0,0 +1,13 @@
+#pragma once
+
+#include "BenchmarkRunner.hpp"
+
+/**
+ * \brief Register the micro-benchmarks of the core libraries.
+ *
+ * Covers ring buffer operations, CRC-32C computation, microslice
+ * transmission through a dual ring buffer, timeslice serialization,
+ * time-ordered merging of timeslice components, pattern generation and
+ * checking, timeslice analysis, and the shared memory timeslice buffer IPC.
+ */
+void add_core_benchmarks(BenchmarkRunner& runner);
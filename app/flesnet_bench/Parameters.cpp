@@ -0,0 +1,54 @@
+#include "Parameters.hpp"
+#include "GitRevision.hpp"
+#include "log.hpp"
+#include <boost/program_options.hpp>
+#include <iostream>
+
+namespace po = boost::program_options;
+
+void Parameters::parse_options(int argc, char* argv[]) {
+  unsigned log_level = 2;
+
+  po::options_description desc("Allowed options");
+  auto desc_add = desc.add_options();
+  desc_add("version,V", "print version string");
+  desc_add("help,h", "produce help message");
+  desc_add("log-level,l", po::value<unsigned>(&log_level),
+           "set the log level (default:2, all:0)");
+  desc_add("list", po::value<bool>(&list)->implicit_value(true),
+           "list the available benchmarks and exit");
+  desc_add("filter,f", po::value<std::string>(&filter),
+           "run only benchmarks matching the given regular expression");
+  desc_add("samples,s", po::value<std::size_t>(&samples),
+           "number of timed samples per benchmark (default: 30)");
+  desc_add("sample-time,t", po::value<double>(&sample_time_ms),
+           "minimum duration of a single sample in ms (default: 20)");
+  desc_add("format", po::value<std::string>(&format),
+           "output format, \"csv\" or \"json\" (default: csv)");
+  desc_add("output,o", po::value<std::string>(&output),
+           "name of the output file (default: standard output)");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help") != 0u) {
+    std::cout << "flesnet_bench, git revision " << g_GIT_REVISION << std::endl;
+    std::cout << desc << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  if (vm.count("version") != 0u) {
+    std::cout << "flesnet_bench, git revision " << g_GIT_REVISION << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+
+  logging::add_console(static_cast<severity_level>(log_level));
+
+  if (format != "csv" && format != "json") {
+    throw ParametersException("unknown output format: " + format);
+  }
+  if (samples == 0) {
+    throw ParametersException("number of samples must be positive");
+  }
+}
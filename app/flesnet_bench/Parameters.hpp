@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+/// Run parameters exception class.
+class ParametersException : public std::runtime_error {
+public:
+  explicit ParametersException(const std::string& what_arg = "")
+      : std::runtime_error(what_arg) {}
+};
+
+/// Global run parameters.
+struct Parameters {
+  Parameters(int argc, char* argv[]) { parse_options(argc, argv); }
+  void parse_options(int argc, char* argv[]);
+
+  std::string filter = ".*";
+  std::size_t samples = 30;
+  double sample_time_ms = 20;
+  std::string format = "csv";
+  std::string output;
+  bool list = false;
+};
@@ -0,0 +1,121 @@
+#include "ToolBenchmarks.hpp"
+#include "NdpbEpochToMsSorter.hpp"
+#include "NgdpbBulkDecoder.hpp"
+#include "StorableMicroslice.hpp"
+#include "rocMess_wGet4v1.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Sink for computed values to keep them from being optimized away.
+volatile uint64_t value_sink;
+
+using ms_vector = std::vector<std::shared_ptr<const fles::Microslice>>;
+
+/// Synthetic nDPB stream: per epoch an epoch message followed by hits with
+/// random timestamps and a few aux/sync messages.
+ms_vector make_ndpb_stream(std::size_t nb_ms,
+                           std::size_t ep_per_ms,
+                           std::size_t hits_per_ep) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> ts_dist(0, 0x3fff);
+  std::uniform_int_distribution<uint32_t> bit_dist(0, 1);
+
+  ms_vector stream;
+  uint32_t epoch = 1000;
+  for (std::size_t m = 0; m < nb_ms; ++m) {
+    std::vector<uint64_t> data;
+    for (std::size_t e = 0; e < ep_per_ms; ++e, ++epoch) {
+      ngdpb::Message ep;
+      ep.setMessageType(ngdpb::MSG_EPOCH);
+      ep.setField(8, 32, epoch);
+      data.push_back(ep.getData());
+      for (std::size_t h = 0; h < hits_per_ep; ++h) {
+        ngdpb::Message hit;
+        hit.setMessageType(ngdpb::MSG_HIT);
+        hit.setField(11, 14, ts_dist(rng));
+        hit.setField(25, 7, h % 128);
+        hit.setBit(47, static_cast<uint8_t>(bit_dist(rng)));
+        data.push_back(hit.getData());
+        if (h % 64 == 0) {
+          ngdpb::Message aux;
+          aux.setMessageType(h % 128 == 0 ? ngdpb::MSG_AUX : ngdpb::MSG_SYNC);
+          aux.setField(13, 13, ts_dist(rng) >> 1);
+          data.push_back(aux.getData());
+        }
+      }
+    }
+    fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+    desc.hdr_id = static_cast<uint8_t>(fles::HeaderFormatIdentifier::Standard);
+    desc.idx = m;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+    stream.push_back(std::make_shared<fles::StorableMicroslice>(
+        desc, std::vector<uint8_t>(p, p + data.size() * sizeof(uint64_t))));
+  }
+  return stream;
+}
+
+void add_sorter_benchmarks(BenchmarkRunner& runner) {
+  runner.add("ndpb_sorter/sort_stream", [] {
+    auto stream = std::make_shared<ms_vector>(make_ndpb_stream(20, 10, 200));
+    uint64_t bytes = 0;
+    for (const auto& ms : *stream) {
+      bytes += ms->desc().size;
+    }
+    return [stream, bytes](uint64_t iterations) {
+      for (uint64_t i = 0; i < iterations; ++i) {
+        fles::NdpbEpochToMsSorter sorter(4, true);
+        for (const auto& ms : *stream) {
+          auto out = sorter.exchange_item(ms);
+          while (out.first) {
+            value_sink = out.first->desc().size;
+            if (!out.second) {
+              break;
+            }
+            out = sorter.exchange_item(nullptr);
+          }
+        }
+      }
+      return iterations * bytes;
+    };
+  });
+}
+
+void add_decoder_benchmarks(BenchmarkRunner& runner) {
+  const std::size_t count = 65536;
+  for (bool avx2 : {false, true}) {
+    if (avx2 && !ngdpb::BulkDecoder::is_avx2_available()) {
+      continue;
+    }
+    std::string name = std::string("ngdpb_decoder/decode_") +
+                       (avx2 ? "avx2" : "scalar");
+    runner.add(name, [avx2, count] {
+      std::mt19937_64 rng(1234);
+      auto messages = std::make_shared<std::vector<uint64_t>>(count);
+      for (auto& m : *messages) {
+        m = rng();
+      }
+      auto decoder = std::make_shared<ngdpb::BulkDecoder>(avx2);
+      auto block = std::make_shared<ngdpb::MessageBlock>();
+      return [messages, decoder, block, count](uint64_t iterations) {
+        for (uint64_t i = 0; i < iterations; ++i) {
+          for (std::size_t pos = 0; pos < count;) {
+            pos += decoder->decode(&(*messages)[pos], count - pos, *block);
+          }
+          value_sink = block->size;
+        }
+        return iterations * count * sizeof(uint64_t);
+      };
+    });
+  }
+}
+
+} // namespace
+
+void add_tool_benchmarks(BenchmarkRunner& runner) {
+  add_sorter_benchmarks(runner);
+  add_decoder_benchmarks(runner);
+}
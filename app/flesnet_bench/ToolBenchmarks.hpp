@@ -0,0 +1,11 @@
+#pragma once
+
+#include "BenchmarkRunner.hpp"
+
+/**
+ * \brief Register the micro-benchmarks of the data analysis tools.
+ *
+ * Covers the nDPB epoch sorting filter and the block-wise nDPB message
+ * decoder.
+ */
+void add_tool_benchmarks(BenchmarkRunner& runner);
@@ -0,0 +1,51 @@
+#include "BenchmarkRunner.hpp"
+#include "CoreBenchmarks.hpp"
+#include "GitRevision.hpp"
+#include "Parameters.hpp"
+#include "ToolBenchmarks.hpp"
+#include "log.hpp"
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+  try {
+    Parameters par(argc, argv);
+
+    BenchmarkRunner runner;
+    add_core_benchmarks(runner);
+    add_tool_benchmarks(runner);
+
+    if (par.list) {
+      for (const auto& name : runner.names()) {
+        std::cout << name << std::endl;
+      }
+      return EXIT_SUCCESS;
+    }
+
+    auto results = runner.run(
+        par.filter, par.samples, par.sample_time_ms / 1000.0,
+        [](const BenchmarkResult& r) {
+          L_(info) << r.name << ": median " << r.percentile(50)
+                   << " ns/op, p99 " << r.percentile(99) << " ns/op";
+        });
+
+    std::ofstream file;
+    if (!par.output.empty()) {
+      file.open(par.output);
+      if (!file) {
+        throw std::runtime_error("could not open output file " + par.output);
+      }
+    }
+    std::ostream& out = par.output.empty() ? std::cout : file;
+    if (par.format == "json") {
+      BenchmarkRunner::write_json(out, results, g_GIT_REVISION);
+    } else {
+      BenchmarkRunner::write_csv(out, results);
+    }
+  } catch (std::exception const& e) {
+    L_(fatal) << e.what();
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -44,6 +44,11 @@ Application::Application(Parameters const& par) : par_(par) {
         new NgdpbMicrosliceDumper(std::cout, par_.dump_verbosity)));
   }
 
+  if (par_.monitor) {
+    sinks_.push_back(std::unique_ptr<fles::MicrosliceSink>(
+        new NgdpbMicrosliceMonitor(par_.monitor_interval, std::cout)));
+  }
+
   if (!par_.output_archive.empty()) {
     if (par_.sorter) {
       filtered_output_archive_ =
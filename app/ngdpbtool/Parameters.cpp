@@ -47,11 +47,16 @@ void Parameters::parse_options(int argc, char* argv[]) {
   opmode_add("sortmesg", po::value<bool>(&sortmesg)->implicit_value(true),
              "enable/disable message sorting inside epoch buffer before "
              "creation of new ms");
+  opmode_add("monitor,m", po::value<bool>(&monitor)->implicit_value(true),
+             "enable/disable quick-look monitoring (message type and channel "
+             "histograms)");
 
   po::options_description sink("Sink options");
   auto sink_add = sink.add_options();
   sink_add("dump_verbosity,v", po::value<size_t>(&dump_verbosity),
            "set output debug dump verbosity");
+  sink_add("monitor-interval", po::value<uint64_t>(&monitor_interval),
+           "number of microslices between monitoring outputs (default: 1000)");
   sink_add("output-shm,O", po::value<std::string>(&output_shm),
            "name of a shared memory to write to");
   sink_add("output-archive,o", po::value<std::string>(&output_archive),
@@ -88,4 +93,7 @@ void Parameters::parse_options(int argc, char* argv[]) {
   if (input_sources > 1) {
     throw ParametersException("more than one input source specified");
   }
+  if (monitor_interval == 0) {
+    throw ParametersException("monitor interval must be positive");
+  }
 }
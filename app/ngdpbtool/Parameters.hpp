@@ -31,9 +31,11 @@ struct Parameters {
   bool sorter = false;
   uint32_t epoch_per_ms = 1;
   bool sortmesg = false;
+  bool monitor = false;
 
   // sink selection
   size_t dump_verbosity = 0;
+  uint64_t monitor_interval = 1000;
   std::string output_shm;
   std::string output_archive;
 };
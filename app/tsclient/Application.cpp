@@ -4,6 +4,7 @@
 #include "TimesliceAnalyzer.hpp"
 #include "TimesliceDebugger.hpp"
 #include "TimesliceInputArchive.hpp"
+#include "TimesliceLatencyMonitor.hpp"
 #include "TimesliceOutputArchive.hpp"
 #include "TimeslicePublisher.hpp"
 #include "TimesliceReceiver.hpp"
@@ -30,7 +31,13 @@ Application::Application(Parameters const& par) : par_(par) {
     std::string output_prefix =
         boost::lexical_cast<std::string>(par_.client_index()) + ": ";
     sinks_.push_back(std::unique_ptr<fles::TimesliceSink>(
-        new TimesliceAnalyzer(10000, status_log_.stream, output_prefix)));
+        new TimesliceAnalyzer(10000, status_log_.stream, output_prefix,
+                              par_.analyze_threads())));
+  }
+
+  if (!par_.latency_trace().empty()) {
+    sinks_.push_back(std::unique_ptr<fles::TimesliceSink>(
+        new TimesliceLatencyMonitor(par_.latency_trace())));
   }
 
   if (par_.verbosity() > 0) {
@@ -24,6 +24,9 @@ void Parameters::parse_options(int argc, char* argv[]) {
   desc_add("analyze-pattern,a",
            po::value<bool>(&analyze_)->implicit_value(true),
            "enable/disable pattern check");
+  desc_add("analyze-threads", po::value<unsigned>(&analyze_threads_),
+           "number of threads used for pattern check (default: 1, 0: one "
+           "per hardware thread)");
   desc_add("benchmark,b", po::value<bool>(&benchmark_)->implicit_value(true),
            "run benchmark test only");
   desc_add("verbose,v", po::value<size_t>(&verbosity_), "set output verbosity");
@@ -56,6 +59,9 @@ void Parameters::parse_options(int argc, char* argv[]) {
            "unlimited)");
   desc_add("rate-limit", po::value<double>(&rate_limit_),
            "limit the item rate to given frequency (in Hz)");
+  desc_add("latency-trace", po::value<std::string>(&latency_trace_),
+           "write per-timeslice latency trace to given file (requires "
+           "timestamped pattern generator input)");
 
   po::variables_map vm;
   po::store(po::parse_command_line(argc, argv, desc), vm);
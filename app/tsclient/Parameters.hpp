@@ -36,6 +36,8 @@ public:
 
   bool analyze() const { return analyze_; }
 
+  unsigned analyze_threads() const { return analyze_threads_; }
+
   bool benchmark() const { return benchmark_; }
 
   size_t verbosity() const { return verbosity_; }
@@ -48,6 +50,8 @@ public:
 
   double rate_limit() const { return rate_limit_; }
 
+  std::string latency_trace() const { return latency_trace_; }
+
 private:
   void parse_options(int argc, char* argv[]);
 
@@ -59,10 +63,12 @@ private:
   size_t output_archive_items_ = SIZE_MAX;
   size_t output_archive_bytes_ = SIZE_MAX;
   bool analyze_ = false;
+  unsigned analyze_threads_ = 1;
   bool benchmark_ = false;
   size_t verbosity_ = 0;
   std::string publish_address_;
   std::string subscribe_address_;
   uint64_t maximum_number_ = UINT64_MAX;
   double rate_limit_ = 0.0;
+  std::string latency_trace_;
 };
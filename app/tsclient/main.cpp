@@ -1,10 +1,26 @@
 // Copyright 2012-2015 Jan de Cuveland <cmail@cuveland.de>
 
 #include "Application.hpp"
+#include "LatencyTracer.hpp"
 #include "Parameters.hpp"
 #include "log.hpp"
+#include <csignal>
+#include <memory>
+
+namespace {
+volatile sig_atomic_t trace_dump_requested = 0;
+}
+
+static void trace_dump_handler(int /* sig */) { trace_dump_requested = 1; }
 
 int main(int argc, char* argv[]) {
+  // dump the latency trace (FLESNET_TRACE) on SIGUSR1
+  std::unique_ptr<fles::LatencyTraceDumper> trace_dumper;
+  if (fles::LatencyTracer::instance().enabled()) {
+    std::signal(SIGUSR1, trace_dump_handler);
+    trace_dumper.reset(new fles::LatencyTraceDumper(&trace_dump_requested));
+  }
+
   try {
     Parameters par(argc, argv);
     Application app(par);
@@ -14,5 +30,9 @@ int main(int argc, char* argv[]) {
     return EXIT_FAILURE;
   }
 
+  // no-op unless tracing to a file is enabled (FLESNET_TRACE)
+  trace_dumper.reset();
+  fles::LatencyTracer::instance().dump();
+
   return EXIT_SUCCESS;
 }
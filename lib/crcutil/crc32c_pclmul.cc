@@ -0,0 +1,216 @@
+// Implements CRC32C using carry-less multiplication (PCLMULQDQ) folding.
+
+#include "crc32c_pclmul.h"
+
+#if CRCUTIL_USE_PCLMUL
+
+#include <immintrin.h>
+
+namespace crcutil {
+
+namespace {
+
+// CRC32C polynomial, reflected bit order.
+const uint32 kPoly = 0x82f63b78;
+
+// Multiplies a(x) and b(x) modulo P(x) (reflected, x^0 is the MSB).
+uint32 MultiplyModP(uint32 a, uint32 b) {
+  uint32 product = 0;
+  for (uint32 m = 1u << 31; m != 0; m >>= 1) {
+    if ((a & m) != 0) {
+      product ^= b;
+    }
+    b = (b & 1) != 0 ? (b >> 1) ^ kPoly : b >> 1;
+  }
+  return product;
+}
+
+// Returns x^n mod P(x) (reflected).
+uint32 XPowNModP(size_t n) {
+  uint32 result = 1u << 31;  // x^0
+  uint32 power = 1u << 30;   // x^1
+  for (; n != 0; n >>= 1) {
+    if ((n & 1) != 0) {
+      result = MultiplyModP(power, result);
+    }
+    power = MultiplyModP(power, power);
+  }
+  return result;
+}
+
+// Minimum number of bytes for the folding implementations.
+const size_t kMinFoldBytes = 256;
+const size_t kMinVpclmulBytes = 1024;
+
+// In reflected bit order, a carry-less product of two 64-bit values is
+// shifted by one bit, which is compensated for in the constants. Given a
+// 128-bit value A = H * x^64 + L (H in the low quadword), the value
+// A * x^D mod P is congruent to H * x^(D+64) + L * x^D, which is computed
+// as clmul(H, x^(D+63) mod P) ^ clmul(L, x^(D-1) mod P).
+__attribute__((target("pclmul,sse4.2"))) inline __m128i Fold128(
+    __m128i value, __m128i constants) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x00),
+                       _mm_clmulepi64_si128(value, constants, 0x11));
+}
+
+__attribute__((target("pclmul,sse4.2"))) inline __m128i LoadConstants(
+    const uint64 constants[2]) {
+  return _mm_set_epi64x(static_cast<long long>(constants[1]),
+                        static_cast<long long>(constants[0]));
+}
+
+// Reduces a 128-bit value to a raw CRC using the crc32 instruction.
+__attribute__((target("pclmul,sse4.2"))) inline uint64 Reduce128(
+    __m128i value) {
+  uint64 crc = _mm_crc32_u64(0, static_cast<uint64>(_mm_cvtsi128_si64(value)));
+  return _mm_crc32_u64(
+      crc, static_cast<uint64>(_mm_extract_epi64(value, 1)));
+}
+
+// Folds the data in multiples of 64 bytes, returns the raw CRC of the
+// processed bytes and advances "src" and "bytes" accordingly.
+__attribute__((target("pclmul,sse4.2"))) uint64 FoldPclmul(
+    const uint8 *&src, size_t &bytes, uint64 crc, const uint64 (*fold)[2]) {
+  const __m128i *p = reinterpret_cast<const __m128i *>(src);
+  __m128i x0 = _mm_xor_si128(_mm_loadu_si128(p + 0),
+                             _mm_cvtsi64_si128(static_cast<long long>(crc)));
+  __m128i x1 = _mm_loadu_si128(p + 1);
+  __m128i x2 = _mm_loadu_si128(p + 2);
+  __m128i x3 = _mm_loadu_si128(p + 3);
+  p += 4;
+  size_t blocks = bytes / 64 - 1;
+
+  const __m128i k512 = LoadConstants(fold[3]);
+  for (; blocks != 0; --blocks, p += 4) {
+    x0 = _mm_xor_si128(Fold128(x0, k512), _mm_loadu_si128(p + 0));
+    x1 = _mm_xor_si128(Fold128(x1, k512), _mm_loadu_si128(p + 1));
+    x2 = _mm_xor_si128(Fold128(x2, k512), _mm_loadu_si128(p + 2));
+    x3 = _mm_xor_si128(Fold128(x3, k512), _mm_loadu_si128(p + 3));
+  }
+
+  __m128i x = _mm_xor_si128(Fold128(x0, LoadConstants(fold[2])), x3);
+  x = _mm_xor_si128(x, Fold128(x1, LoadConstants(fold[1])));
+  x = _mm_xor_si128(x, Fold128(x2, LoadConstants(fold[0])));
+
+  size_t processed = reinterpret_cast<const uint8 *>(p) - src;
+  src += processed;
+  bytes -= processed;
+  return Reduce128(x);
+}
+
+// Same as LoadConstants(), replicated to all four 128-bit lanes.
+__attribute__((target("avx512f"))) inline __m512i LoadConstants512(
+    const uint64 constants[2]) {
+  return _mm512_set_epi64(static_cast<long long>(constants[1]),
+                          static_cast<long long>(constants[0]),
+                          static_cast<long long>(constants[1]),
+                          static_cast<long long>(constants[0]),
+                          static_cast<long long>(constants[1]),
+                          static_cast<long long>(constants[0]),
+                          static_cast<long long>(constants[1]),
+                          static_cast<long long>(constants[0]));
+}
+
+// Same as FoldPclmul(), but in multiples of 256 bytes using four 512-bit
+// lanes.
+__attribute__((target("avx512f,vpclmulqdq,pclmul,sse4.2"))) uint64
+FoldVpclmul(const uint8 *&src, size_t &bytes, uint64 crc,
+            const uint64 (*fold)[2]) {
+  const uint8 *p = src;
+  __m512i x0 = _mm512_xor_si512(
+      _mm512_loadu_si512(p),
+      _mm512_zextsi128_si512(_mm_cvtsi64_si128(static_cast<long long>(crc))));
+  __m512i x1 = _mm512_loadu_si512(p + 64);
+  __m512i x2 = _mm512_loadu_si512(p + 128);
+  __m512i x3 = _mm512_loadu_si512(p + 192);
+  p += 256;
+  size_t blocks = bytes / 256 - 1;
+
+  const __m512i k2048 = LoadConstants512(fold[6]);
+  for (; blocks != 0; --blocks, p += 256) {
+    x0 = _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x0, k2048, 0x00),
+                                   _mm512_clmulepi64_epi128(x0, k2048, 0x11),
+                                   _mm512_loadu_si512(p), 0x96);
+    x1 = _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x1, k2048, 0x00),
+                                   _mm512_clmulepi64_epi128(x1, k2048, 0x11),
+                                   _mm512_loadu_si512(p + 64), 0x96);
+    x2 = _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x2, k2048, 0x00),
+                                   _mm512_clmulepi64_epi128(x2, k2048, 0x11),
+                                   _mm512_loadu_si512(p + 128), 0x96);
+    x3 = _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x3, k2048, 0x00),
+                                   _mm512_clmulepi64_epi128(x3, k2048, 0x11),
+                                   _mm512_loadu_si512(p + 192), 0x96);
+  }
+
+  // Fold four 512-bit lanes into one.
+  const __m512i k1536 = LoadConstants512(fold[5]);
+  const __m512i k1024 = LoadConstants512(fold[4]);
+  const __m512i k512 = LoadConstants512(fold[3]);
+  __m512i x = _mm512_ternarylogic_epi64(
+      _mm512_clmulepi64_epi128(x0, k1536, 0x00),
+      _mm512_clmulepi64_epi128(x0, k1536, 0x11), x3, 0x96);
+  x = _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x1, k1024, 0x00),
+                                _mm512_clmulepi64_epi128(x1, k1024, 0x11), x,
+                                0x96);
+  x = _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x2, k512, 0x00),
+                                _mm512_clmulepi64_epi128(x2, k512, 0x11), x,
+                                0x96);
+
+  // Fold four 128-bit lanes into one.
+  __m128i lanes[4];
+  _mm512_storeu_si512(lanes, x);
+  __m128i y = _mm_xor_si128(Fold128(lanes[0], LoadConstants(fold[2])),
+                            lanes[3]);
+  y = _mm_xor_si128(y, Fold128(lanes[1], LoadConstants(fold[1])));
+  y = _mm_xor_si128(y, Fold128(lanes[2], LoadConstants(fold[0])));
+
+  size_t processed = static_cast<size_t>(p - src);
+  src += processed;
+  bytes -= processed;
+  return Reduce128(y);
+}
+
+}  // namespace
+
+void Crc32cPclmul::InitFolding() {
+  static const size_t kDistances[kNumFoldConstants] = {
+      128, 256, 384, 512, 1024, 1536, 2048};
+  for (size_t i = 0; i < kNumFoldConstants; ++i) {
+    // 32-bit constants occupy the upper half of the 64-bit operands.
+    fold_[i][0] = static_cast<uint64>(XPowNModP(kDistances[i] + 63)) << 32;
+    fold_[i][1] = static_cast<uint64>(XPowNModP(kDistances[i] - 1)) << 32;
+  }
+  use_vpclmul_ = IsVpclmulAvailable();
+}
+
+bool Crc32cPclmul::IsPclmulAvailable() {
+  return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.2");
+}
+
+bool Crc32cPclmul::IsVpclmulAvailable() {
+  return IsPclmulAvailable() && __builtin_cpu_supports("avx512f") &&
+         __builtin_cpu_supports("vpclmulqdq");
+}
+
+size_t Crc32cPclmul::CrcDefault(const void *data,
+                                size_t bytes,
+                                const Crc &start) const {
+  if (bytes < kMinFoldBytes) {
+    return Crc32c(data, bytes, start);
+  }
+
+  const uint8 *src = static_cast<const uint8 *>(data);
+  uint64 crc = static_cast<uint32>(start ^ Base().Canonize());
+  if (use_vpclmul_ && bytes >= kMinVpclmulBytes) {
+    crc = FoldVpclmul(src, bytes, crc, fold_);
+  } else {
+    crc = FoldPclmul(src, bytes, crc, fold_);
+  }
+
+  // Process the remaining bytes with the Crc32cSSE4 implementation.
+  return Crc32c(src, bytes, static_cast<Crc>(crc) ^ Base().Canonize());
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_PCLMUL
@@ -0,0 +1,73 @@
+// Implements CRC32C using carry-less multiplication (PCLMULQDQ) folding.
+//
+// The data is folded in four parallel 128-bit lanes (PCLMULQDQ) or four
+// 512-bit lanes (VPCLMULQDQ with AVX-512), the remaining 128-bit value and
+// the tail are reduced with the SSE4.2 crc32 instruction. Short inputs and
+// CPUs without PCLMULQDQ use the Crc32cSSE4 implementation, so results are
+// always identical.
+
+#ifndef CRCUTIL_CRC32C_PCLMUL_H_
+#define CRCUTIL_CRC32C_PCLMUL_H_
+
+#include "crc32c_sse4.h"
+
+#if HAVE_AMD64 && CRCUTIL_USE_MM_CRC32
+
+#define CRCUTIL_USE_PCLMUL 1
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc32cPclmul : public Crc32cSSE4 {
+ public:
+  Crc32cPclmul() {}
+
+  // Initializes the tables, see Crc32cSSE4.
+  Crc32cPclmul(const Crc &generating_polynomial,
+               size_t degree,
+               bool canonical)
+      : Crc32cSSE4(generating_polynomial, degree, canonical) {
+    InitFolding();
+  }
+
+  // Computes CRC32.
+  size_t CrcDefault(const void *data, size_t bytes, const Crc &crc) const;
+
+  // Returns true iff PCLMULQDQ and SSE4.2 instructions are available.
+  static bool IsPclmulAvailable();
+
+  // Returns true iff VPCLMULQDQ and AVX-512F instructions are available.
+  static bool IsVpclmulAvailable();
+
+ protected:
+  void InitFolding();
+
+  // Folding constants (x^(D+63) mod P, x^(D-1) mod P) for fold
+  // distances D of 128, 256, 384, 512, 1024, 1536, and 2048 bits.
+  enum {
+    kFold128,
+    kFold256,
+    kFold384,
+    kFold512,
+    kFold1024,
+    kFold1536,
+    kFold2048,
+    kNumFoldConstants
+  };
+  uint64 fold_[kNumFoldConstants][2];
+
+  bool use_vpclmul_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#else
+
+#define CRCUTIL_USE_PCLMUL 0
+
+#endif  // HAVE_AMD64 && CRCUTIL_USE_MM_CRC32
+
+#endif  // CRCUTIL_CRC32C_PCLMUL_H_
@@ -17,6 +17,7 @@
 #include "interface.h"
 
 #include "aligned_alloc.h"
+#include "crc32c_pclmul.h"
 #include "crc32c_sse4.h"
 #include "generic_crc.h"
 #include "protected_crc.h"
@@ -219,6 +220,14 @@ bool CRC::IsSSE42Available() {
 #endif  // HAVE_AMD64 || HAVE_I386
 }
 
+bool CRC::IsPCLMULAvailable() {
+#if CRCUTIL_USE_PCLMUL
+  return Crc32cPclmul::IsPclmulAvailable();
+#else
+  return false;
+#endif  // CRCUTIL_USE_PCLMUL
+}
+
 CRC::~CRC() {}
 CRC::CRC() {}
 
@@ -231,6 +240,21 @@ CRC *CRC::Create(UINT64 poly_lo,
                  size_t roll_length,
                  bool use_sse4_2,
                  const void **allocated_memory) {
+  return Create(poly_lo, poly_hi, degree, canonical, roll_start_value_lo,
+                roll_start_value_hi, roll_length, use_sse4_2, false,
+                allocated_memory);
+}
+
+CRC *CRC::Create(UINT64 poly_lo,
+                 UINT64 poly_hi,
+                 size_t degree,
+                 bool canonical,
+                 UINT64 roll_start_value_lo,
+                 UINT64 roll_start_value_hi,
+                 size_t roll_length,
+                 bool use_sse4_2,
+                 bool use_pclmul,
+                 const void **allocated_memory) {
   if (degree == 0) {
     return NULL;
   }
@@ -276,6 +300,17 @@ CRC *CRC::Create(UINT64 poly_lo,
       if (roll_start_value_hi != 0 || (roll_start_value_lo >> 32) != 0) {
         return NULL;
       }
+#if CRCUTIL_USE_PCLMUL
+    if (use_pclmul && Crc32cPclmul::IsPclmulAvailable()) {
+      return Implementation<Crc32cPclmul, RollingCrc32cSSE4>::Create(
+          static_cast<size_t>(poly_lo),
+          degree,
+          canonical,
+          static_cast<size_t>(roll_start_value_lo),
+          static_cast<size_t>(roll_length),
+          allocated_memory);
+    }
+#endif  // CRCUTIL_USE_PCLMUL
     return Implementation<Crc32cSSE4, RollingCrc32cSSE4>::Create(
         static_cast<size_t>(poly_lo),
         degree,
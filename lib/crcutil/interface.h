@@ -69,12 +69,33 @@ class CRC {
                      bool use_sse4_2,
                      const void **allocated_memory);
 
+  // Same as above, but allows to control the use of carry-less
+  // multiplication (PCLMULQDQ/VPCLMULQDQ) folding for CRC32C.
+  //
+  // use_pclmul - if true and use_sse4_2 is set, use PCLMULQDQ folding
+  //              (VPCLMULQDQ with AVX-512 if available) to compute CRC32C
+  //              if supported by the CPU. The other Create() function
+  //              behaves as if use_pclmul were false.
+  static CRC *Create(UINT64 poly_lo,
+                     UINT64 poly_hi,
+                     size_t degree,
+                     bool canonical,
+                     UINT64 roll_start_value_lo,
+                     UINT64 roll_start_value_hi,
+                     size_t roll_window_bytes,
+                     bool use_sse4_2,
+                     bool use_pclmul,
+                     const void **allocated_memory);
+
   // Deletes the instance of CRC class.
   virtual void Delete() = 0;
 
   // Returns true if SSE4.2 is available.
   static bool IsSSE42Available();
 
+  // Returns true if PCLMULQDQ (and SSE4.2) is available.
+  static bool IsPCLMULAvailable();
+
   // Returns generating polynomial.
   virtual void GeneratingPolynomial(/* OUT */ UINT64 *lo,
                                     /* OUT */ UINT64 *hi = NULL) const = 0;
@@ -1,6 +1,7 @@
 // Copyright 2015 Jan de Cuveland <cmail@cuveland.de>
 
 #include "Benchmark.hpp"
+#include "Crc32c.hpp"
 #include "interface.h" // crcutil_interface
 #include <algorithm>   // std::generate_n
 #include <boost/crc.hpp>
@@ -91,11 +92,13 @@ uint32_t Benchmark::compute_crc32(Algorithm algorithm) {
     break;
   }
 
-  case Algorithm::CrcUtil_C: {
+  case Algorithm::CrcUtil_C:
+  case Algorithm::CrcUtil_C_Pclmul: {
     // Castagnoli
     crcutil_interface::CRC* crc_32 = crcutil_interface::CRC::Create(
         0x82f63b78, 0, 32, true, 0, 0, 0,
-        crcutil_interface::CRC::IsSSE42Available(), NULL);
+        crcutil_interface::CRC::IsSSE42Available(),
+        algorithm == Algorithm::CrcUtil_C_Pclmul, NULL);
     crcutil_interface::UINT64 crc64 = 0;
     for (size_t i = 0; i < cycles_; ++i) {
       crc_32->Compute(random_data_.data(), random_data_.size(), &crc64);
@@ -118,6 +121,14 @@ uint32_t Benchmark::compute_crc32(Algorithm algorithm) {
     crc_32->Delete();
     break;
   }
+
+  case Algorithm::Fles_C: {
+    // Castagnoli
+    for (size_t i = 0; i < cycles_; ++i) {
+      crc = fles::crc32c(random_data_.data(), random_data_.size(), crc);
+    }
+    break;
+  }
   }
 
   return crc;
@@ -134,8 +145,14 @@ void Benchmark::run() {
   run_single(Algorithm::Intrinsic64);
   std::cout << "CRC32 Benchmark: CrcUtil (Castagnoli)" << std::endl;
   run_single(Algorithm::CrcUtil_C);
+  if (crcutil_interface::CRC::IsPCLMULAvailable()) {
+    std::cout << "CRC32 Benchmark: CrcUtil PCLMUL (Castagnoli)" << std::endl;
+    run_single(Algorithm::CrcUtil_C_Pclmul);
+  }
   std::cout << "CRC32 Benchmark: CrcUtil (IEEE)" << std::endl;
   run_single(Algorithm::CrcUtil_I);
+  std::cout << "CRC32 Benchmark: fles::crc32c (Castagnoli)" << std::endl;
+  run_single(Algorithm::Fles_C);
 }
 
 void Benchmark::run_single(Algorithm algorithm) {
@@ -17,7 +17,9 @@ public:
     Intrinsic32,
     Intrinsic64,
     CrcUtil_C,
-    CrcUtil_I
+    CrcUtil_C_Pclmul,
+    CrcUtil_I,
+    Fles_C
   };
   uint32_t compute_crc32(Algorithm algorithm);
   void run_single(Algorithm algorithm);
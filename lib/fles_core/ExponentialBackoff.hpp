@@ -0,0 +1,58 @@
+/// \file
+/// \brief Defines the ExponentialBackoff class.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+/// Retry schedule with exponentially growing delays.
+/** The first attempt is due immediately. Each failed attempt doubles the
+   delay until the next one, up to a maximum delay. */
+class ExponentialBackoff {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /// The ExponentialBackoff constructor.
+  /**
+   \param initial_delay Delay after the first failed attempt
+   \param max_delay     Upper limit of the delay
+   */
+  ExponentialBackoff(std::chrono::milliseconds initial_delay,
+                     std::chrono::milliseconds max_delay)
+      : initial_delay_(initial_delay), max_delay_(max_delay),
+        delay_(initial_delay) {}
+
+  /// Check if the next attempt is due.
+  bool due(clock::time_point now) const { return now >= next_attempt_; }
+
+  /// Record a failed attempt and schedule the next one.
+  void failed(clock::time_point now) {
+    ++failures_;
+    next_attempt_ = now + delay_;
+    delay_ = std::min(delay_ * 2, max_delay_);
+  }
+
+  /// Start over after a successful attempt.
+  void reset() {
+    failures_ = 0;
+    delay_ = initial_delay_;
+    next_attempt_ = clock::time_point();
+  }
+
+  /// Retrieve the number of failed attempts since the last reset.
+  uint32_t failures() const { return failures_; }
+
+  /// Retrieve the time of the next attempt.
+  clock::time_point next_attempt() const { return next_attempt_; }
+
+private:
+  std::chrono::milliseconds initial_delay_;
+  std::chrono::milliseconds max_delay_;
+
+  /// Delay to apply after the next failed attempt.
+  std::chrono::milliseconds delay_;
+
+  uint32_t failures_ = 0;
+  clock::time_point next_attempt_;
+};
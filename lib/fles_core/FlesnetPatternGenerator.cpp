@@ -1,6 +1,9 @@
 // Copyright 2012-2014 Jan de Cuveland <cmail@cuveland.de>
 
 #include "FlesnetPatternGenerator.hpp"
+#include "FlesnetPatternKernel.hpp"
+#include "LatencyTracer.hpp"
+#include <cstring>
 
 void FlesnetPatternGenerator::proceed() {
   const DualIndex min_avail = {desc_buffer_.size() / 4,
@@ -57,14 +60,31 @@ void FlesnetPatternGenerator::proceed() {
 
     // write to data buffer
     if (generate_pattern_) {
-      for (uint64_t i = 0; i < content_bytes; i += sizeof(uint64_t)) {
-        uint64_t data_word = (input_index_ << 48L) | i;
-        reinterpret_cast<uint64_t&>(data_buffer_.at(write_index_.data)) =
-            data_word;
-        write_index_.data += sizeof(uint64_t);
-        crc ^= (data_word & 0xffffffff) ^ (data_word >> 32L);
+      // fill in up to two contiguous segments (wrap-around of ring buffer)
+      uint64_t xor_sum = 0;
+      std::size_t words = content_bytes / sizeof(uint64_t);
+      std::size_t first_word = 0;
+      while (first_word < words) {
+        std::size_t pos = write_index_.data & data_buffer_.size_mask();
+        std::size_t segment_words =
+            std::min(words - first_word,
+                     (data_buffer_.bytes() - pos) / sizeof(uint64_t));
+        xor_sum ^= flesnet_pattern::fill(
+            reinterpret_cast<uint64_t*>(data_buffer_.ptr() + pos),
+            segment_words, input_index_, first_word);
+        first_word += segment_words;
+        write_index_.data += segment_words * sizeof(uint64_t);
       }
+      crc = flesnet_pattern::fold(xor_sum);
     } else {
+      if (write_timestamps_ && content_bytes >= sizeof(uint64_t)) {
+        // offsets are multiples of the word size, so this does not wrap
+        uint64_t now = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch())
+                .count());
+        std::memcpy(&data_buffer_.at(write_index_.data), &now, sizeof(now));
+      }
       write_index_.data += content_bytes;
     }
 
@@ -73,5 +93,6 @@ void FlesnetPatternGenerator::proceed() {
         desc_buffer_.at(write_index_.desc++)) =
         fles::MicrosliceDescriptor({hdr_id, hdr_ver, eq_id, flags, sys_id,
                                     sys_ver, idx, crc, size, offset});
+    fles::trace_microslice(idx);
   }
 }
@@ -20,14 +20,16 @@ public:
                           uint32_t typical_content_size,
                           bool generate_pattern = false,
                           bool randomize_sizes = false,
-                          uint64_t delay_ns = 0)
+                          uint64_t delay_ns = 0,
+                          bool write_timestamps = false)
       : data_buffer_(data_buffer_size_exp), desc_buffer_(desc_buffer_size_exp),
         data_buffer_view_(data_buffer_.ptr(), data_buffer_size_exp),
         desc_buffer_view_(desc_buffer_.ptr(), desc_buffer_size_exp),
         input_index_(input_index), generate_pattern_(generate_pattern),
         typical_content_size_(typical_content_size),
         randomize_sizes_(randomize_sizes),
-        random_distribution_(typical_content_size), delay_ns_(delay_ns) {
+        random_distribution_(typical_content_size), delay_ns_(delay_ns),
+        write_timestamps_(write_timestamps) {
     begin_ = std::chrono::high_resolution_clock::now();
   }
 
@@ -78,6 +80,10 @@ private:
   uint64_t delay_ns_;
   std::chrono::high_resolution_clock::time_point begin_;
 
+  /// Write the generation time (ns since epoch, system clock) to the first
+  /// content word of each microslice. Only used without pattern.
+  bool write_timestamps_;
+
   /// Number of acknowledged data bytes and microslices. Updated by input
   /// node.
   DualIndex read_index_{0, 0};
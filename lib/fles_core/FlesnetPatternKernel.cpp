@@ -0,0 +1,271 @@
+#include "FlesnetPatternKernel.hpp"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FLESNET_PATTERN_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define FLESNET_PATTERN_HAVE_X86 0
+#endif
+
+namespace flesnet_pattern {
+
+namespace {
+
+/// Number of words verified between two early-exit tests
+constexpr std::size_t check_chunk_words = 64;
+
+inline uint64_t pattern_word(uint64_t tag, std::size_t index) {
+  return (tag << 48) | (index * sizeof(uint64_t));
+}
+
+uint64_t fill_scalar(uint64_t* dst,
+                     std::size_t begin,
+                     std::size_t end,
+                     uint64_t tag,
+                     std::size_t first_word) {
+  uint64_t sum = 0;
+  for (std::size_t i = begin; i < end; ++i) {
+    uint64_t data_word = pattern_word(tag, first_word + i);
+    dst[i] = data_word;
+    sum ^= data_word;
+  }
+  return sum;
+}
+
+bool check_scalar(const uint64_t* src,
+                  std::size_t begin,
+                  std::size_t end,
+                  uint64_t tag,
+                  std::size_t first_word,
+                  uint64_t& sum) {
+  for (std::size_t i = begin; i < end; ++i) {
+    uint64_t data_word = src[i];
+    if (data_word != pattern_word(tag, first_word + i)) {
+      return false;
+    }
+    sum ^= data_word;
+  }
+  return true;
+}
+
+#if FLESNET_PATTERN_HAVE_X86
+
+__attribute__((target("avx2"))) inline uint64_t
+horizontal_xor_avx2(__m256i v) {
+  __m128i x = _mm_xor_si128(_mm256_castsi256_si128(v),
+                            _mm256_extracti128_si256(v, 1));
+  return static_cast<uint64_t>(_mm_cvtsi128_si64(x)) ^
+         static_cast<uint64_t>(_mm_extract_epi64(x, 1));
+}
+
+// Byte offsets of the four words starting at word `first`
+__attribute__((target("avx2"))) inline __m256i
+offsets_avx2(std::size_t first) {
+  return _mm256_add_epi64(
+      _mm256_set1_epi64x(static_cast<long long>(first * sizeof(uint64_t))),
+      _mm256_set_epi64x(24, 16, 8, 0));
+}
+
+__attribute__((target("avx2"))) std::size_t fill_avx2(uint64_t* dst,
+                                                      std::size_t words,
+                                                      uint64_t tag,
+                                                      std::size_t first_word,
+                                                      uint64_t& sum) {
+  const __m256i tag_bits =
+      _mm256_set1_epi64x(static_cast<long long>(tag << 48));
+  const __m256i step = _mm256_set1_epi64x(4 * sizeof(uint64_t));
+  __m256i offset = offsets_avx2(first_word);
+  __m256i acc = _mm256_setzero_si256();
+
+  std::size_t i = 0;
+  for (; i + 4 <= words; i += 4) {
+    __m256i data = _mm256_or_si256(tag_bits, offset);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), data);
+    acc = _mm256_xor_si256(acc, data);
+    offset = _mm256_add_epi64(offset, step);
+  }
+  sum = horizontal_xor_avx2(acc);
+  return i;
+}
+
+// Returns the number of verified words, or `words` + 1 on mismatch
+__attribute__((target("avx2"))) std::size_t check_avx2(const uint64_t* src,
+                                                       std::size_t words,
+                                                       uint64_t tag,
+                                                       std::size_t first_word,
+                                                       uint64_t& sum) {
+  const __m256i tag_bits =
+      _mm256_set1_epi64x(static_cast<long long>(tag << 48));
+  const __m256i step = _mm256_set1_epi64x(4 * sizeof(uint64_t));
+  const std::size_t vector_words = words & ~std::size_t(3);
+  __m256i offset = offsets_avx2(first_word);
+  __m256i acc = _mm256_setzero_si256();
+
+  std::size_t i = 0;
+  while (i < vector_words) {
+    std::size_t end = std::min(vector_words, i + check_chunk_words);
+    __m256i diff = _mm256_setzero_si256();
+    for (; i < end; i += 4) {
+      __m256i data =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      __m256i expected = _mm256_or_si256(tag_bits, offset);
+      diff = _mm256_or_si256(diff, _mm256_xor_si256(data, expected));
+      acc = _mm256_xor_si256(acc, data);
+      offset = _mm256_add_epi64(offset, step);
+    }
+    if (_mm256_testz_si256(diff, diff) == 0) {
+      return words + 1;
+    }
+  }
+  sum = horizontal_xor_avx2(acc);
+  return i;
+}
+
+__attribute__((target("avx512f"))) inline uint64_t
+horizontal_xor_avx512(__m512i v) {
+  uint64_t lanes[8];
+  _mm512_storeu_si512(lanes, v);
+  uint64_t sum = 0;
+  for (uint64_t lane : lanes) {
+    sum ^= lane;
+  }
+  return sum;
+}
+
+// Byte offsets of the eight words starting at word `first`
+__attribute__((target("avx512f"))) inline __m512i
+offsets_avx512(std::size_t first) {
+  return _mm512_add_epi64(
+      _mm512_set1_epi64(static_cast<long long>(first * sizeof(uint64_t))),
+      _mm512_set_epi64(56, 48, 40, 32, 24, 16, 8, 0));
+}
+
+__attribute__((target("avx512f"))) std::size_t
+fill_avx512(uint64_t* dst,
+            std::size_t words,
+            uint64_t tag,
+            std::size_t first_word,
+            uint64_t& sum) {
+  const __m512i tag_bits = _mm512_set1_epi64(static_cast<long long>(tag << 48));
+  const __m512i step = _mm512_set1_epi64(8 * sizeof(uint64_t));
+  __m512i offset = offsets_avx512(first_word);
+  __m512i acc = _mm512_setzero_si512();
+
+  std::size_t i = 0;
+  for (; i + 8 <= words; i += 8) {
+    __m512i data = _mm512_or_si512(tag_bits, offset);
+    _mm512_storeu_si512(dst + i, data);
+    acc = _mm512_xor_si512(acc, data);
+    offset = _mm512_add_epi64(offset, step);
+  }
+  sum = horizontal_xor_avx512(acc);
+  return i;
+}
+
+// Returns the number of verified words, or `words` + 1 on mismatch
+__attribute__((target("avx512f"))) std::size_t
+check_avx512(const uint64_t* src,
+             std::size_t words,
+             uint64_t tag,
+             std::size_t first_word,
+             uint64_t& sum) {
+  const __m512i tag_bits = _mm512_set1_epi64(static_cast<long long>(tag << 48));
+  const __m512i step = _mm512_set1_epi64(8 * sizeof(uint64_t));
+  const std::size_t vector_words = words & ~std::size_t(7);
+  __m512i offset = offsets_avx512(first_word);
+  __m512i acc = _mm512_setzero_si512();
+
+  std::size_t i = 0;
+  while (i < vector_words) {
+    std::size_t end = std::min(vector_words, i + check_chunk_words);
+    __m512i diff = _mm512_setzero_si512();
+    for (; i < end; i += 8) {
+      __m512i data = _mm512_loadu_si512(src + i);
+      __m512i expected = _mm512_or_si512(tag_bits, offset);
+      diff = _mm512_or_si512(diff, _mm512_xor_si512(data, expected));
+      acc = _mm512_xor_si512(acc, data);
+      offset = _mm512_add_epi64(offset, step);
+    }
+    if (_mm512_test_epi64_mask(diff, diff) != 0) {
+      return words + 1;
+    }
+  }
+  sum = horizontal_xor_avx512(acc);
+  return i;
+}
+
+#endif
+
+} // namespace
+
+bool is_supported(Isa isa) {
+  switch (isa) {
+  case Isa::Scalar:
+    return true;
+#if FLESNET_PATTERN_HAVE_X86
+  case Isa::AVX2:
+    return __builtin_cpu_supports("avx2");
+  case Isa::AVX512:
+    return __builtin_cpu_supports("avx512f");
+#endif
+  default:
+    return false;
+  }
+}
+
+Isa best_isa() {
+  static const Isa isa = is_supported(Isa::AVX512)
+                             ? Isa::AVX512
+                             : (is_supported(Isa::AVX2) ? Isa::AVX2
+                                                        : Isa::Scalar);
+  return isa;
+}
+
+uint64_t fill(uint64_t* dst,
+              std::size_t words,
+              uint64_t tag,
+              std::size_t first_word,
+              Isa isa) {
+  uint64_t sum = 0;
+  std::size_t done = 0;
+#if FLESNET_PATTERN_HAVE_X86
+  if (isa == Isa::AVX512) {
+    done = fill_avx512(dst, words, tag, first_word, sum);
+  } else if (isa == Isa::AVX2) {
+    done = fill_avx2(dst, words, tag, first_word, sum);
+  }
+#else
+  (void)isa;
+#endif
+  return sum ^ fill_scalar(dst, done, words, tag, first_word);
+}
+
+bool check(const uint64_t* src,
+           std::size_t words,
+           uint64_t tag,
+           std::size_t first_word,
+           uint64_t& xor_sum,
+           Isa isa) {
+  uint64_t sum = 0;
+  std::size_t done = 0;
+#if FLESNET_PATTERN_HAVE_X86
+  if (isa == Isa::AVX512) {
+    done = check_avx512(src, words, tag, first_word, sum);
+  } else if (isa == Isa::AVX2) {
+    done = check_avx2(src, words, tag, first_word, sum);
+  }
+  if (done > words) {
+    return false;
+  }
+#else
+  (void)isa;
+#endif
+  if (!check_scalar(src, done, words, tag, first_word, sum)) {
+    return false;
+  }
+  xor_sum ^= sum;
+  return true;
+}
+
+} // namespace flesnet_pattern
@@ -0,0 +1,57 @@
+/// \file
+/// \brief Defines vectorized kernels for the FLESnet ramp pattern.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Generation and verification of the FLESnet ramp pattern.
+ *
+ * The pattern consists of 64-bit words `(tag << 48) | byte_offset`, where
+ * `byte_offset` is the position of the word in the microslice content. The
+ * descriptor CRC field holds the XOR of all 32-bit halves of these words.
+ *
+ * The kernels process a segment of `words` words starting at word
+ * `first_word` of the microslice. They return the XOR of all words of the
+ * segment, so that the checksum of several segments can be combined before
+ * calling fold(). Implementations using AVX2 and AVX-512 are selected at
+ * runtime based on the CPU features; all produce identical results.
+ */
+namespace flesnet_pattern {
+
+/// Instruction set used by the kernels.
+enum class Isa { Scalar, AVX2, AVX512 };
+
+/// Return the best instruction set supported by the CPU.
+Isa best_isa();
+
+/// Check if the given instruction set is supported by the CPU.
+bool is_supported(Isa isa);
+
+/// Fill a segment with the pattern, return the XOR of all written words.
+uint64_t fill(uint64_t* dst,
+              std::size_t words,
+              uint64_t tag,
+              std::size_t first_word,
+              Isa isa = best_isa());
+
+/**
+ * \brief Verify a segment against the pattern.
+ *
+ * Returns false if any word differs from the pattern. Otherwise, the XOR of
+ * all words is XORed into `xor_sum`.
+ */
+bool check(const uint64_t* src,
+           std::size_t words,
+           uint64_t tag,
+           std::size_t first_word,
+           uint64_t& xor_sum,
+           Isa isa = best_isa());
+
+/// Fold a 64-bit XOR sum into the 32-bit descriptor checksum.
+inline uint32_t fold(uint64_t xor_sum) {
+  return static_cast<uint32_t>((xor_sum & 0xffffffff) ^ (xor_sum >> 32));
+}
+
+} // namespace flesnet_pattern
@@ -1,6 +1,8 @@
 // Copyright 2015 Jan de Cuveland <cmail@cuveland.de>
 
 #include "MicrosliceReceiver.hpp"
+#include "Crc32c.hpp"
+#include "log.hpp"
 #include <chrono>
 #include <thread>
 
@@ -27,9 +29,37 @@ StorableMicroslice* MicrosliceReceiver::try_get() {
 
     const uint8_t* data_end = &data_source_.data_buffer().at(offset_end);
 
+    const bool crc_valid =
+        (desc.flags & static_cast<uint16_t>(MicrosliceFlags::CrcValid)) != 0;
+
     StorableMicroslice* sms;
 
-    if (data_begin <= data_end) {
+    if (crc_valid) {
+      // copy to vector and verify the CRC in a single pass
+      std::vector<uint8_t> data(desc.size);
+      uint32_t crc;
+      if (data_begin <= data_end) {
+        crc = copy_crc32c(data.data(), data_begin, desc.size);
+      } else {
+        const uint8_t* buffer_begin = data_source_.data_buffer().ptr();
+        std::size_t part1_size =
+            data_source_.data_buffer().bytes() -
+            (desc.offset & data_source_.data_buffer().size_mask());
+        crc = copy_crc32c(data.data(), data_begin, part1_size);
+        crc = copy_crc32c(data.data() + part1_size, buffer_begin,
+                          desc.size - part1_size, crc);
+      }
+      if (crc != desc.crc) {
+        if (crc_errors_ == 0) {
+          L_(error) << "crc failure in microslice " << desc.idx;
+        }
+        ++crc_errors_;
+      }
+
+      sms = new StorableMicroslice(
+          const_cast<const fles::MicrosliceDescriptor&>(desc),
+          std::move(data));
+    } else if (data_begin <= data_end) {
       sms = new StorableMicroslice(
           const_cast<const fles::MicrosliceDescriptor&>(desc),
           const_cast<const uint8_t*>(data_begin));
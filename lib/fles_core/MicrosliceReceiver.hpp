@@ -15,6 +15,9 @@ namespace fles {
 /**
  * \brief The MicrosliceReceiver class implements a mechanism to receive
  * Microslices from an InputBufferReadInterface object.
+ *
+ * The CRC of microslices flagged as CrcValid is verified while copying the
+ * content from the data source.
  */
 class MicrosliceReceiver : public MicrosliceSource {
 public:
@@ -41,6 +44,9 @@ public:
 
   bool eos() const override { return eos_; }
 
+  /// Retrieve the number of microslices with CRC mismatch.
+  uint64_t crc_errors() const { return crc_errors_; }
+
 private:
   StorableMicroslice* do_get() override;
 
@@ -53,5 +59,8 @@ private:
   uint64_t read_index_desc_;
 
   bool eos_ = false;
+
+  /// Number of microslices with CrcValid flag and CRC mismatch
+  uint64_t crc_errors_ = 0;
 };
 } // namespace fles
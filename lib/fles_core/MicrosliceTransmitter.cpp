@@ -1,6 +1,8 @@
 // Copyright 2015 Jan de Cuveland <cmail@cuveland.de>
 
 #include "MicrosliceTransmitter.hpp"
+#include "Crc32c.hpp"
+#include "log.hpp"
 #include <algorithm>
 #include <cassert>
 #include <chrono>
@@ -34,17 +36,40 @@ bool MicrosliceTransmitter::try_put(std::shared_ptr<const Microslice> item) {
   uint8_t* const data_end =
       &data_sink_.data_buffer().at(write_index_.data + item_size.data);
 
+  const bool crc_valid =
+      (item->desc().flags &
+       static_cast<uint16_t>(MicrosliceFlags::CrcValid)) != 0;
+  uint32_t crc = 0;
+
   if (data_begin <= data_end) {
-    std::copy_n(item->content(), item_size.data, data_begin);
+    if (crc_valid) {
+      crc = copy_crc32c(data_begin, item->content(), item_size.data);
+    } else {
+      std::copy_n(item->content(), item_size.data, data_begin);
+    }
   } else {
     size_t part1_size =
         buffer_size.data -
         (write_index_.data & data_sink_.data_buffer().size_mask());
 
     // copy data into two segments
-    std::copy_n(item->content(), part1_size, data_begin);
-    std::copy_n(item->content() + part1_size, item_size.data - part1_size,
-                data_sink_.data_buffer().ptr());
+    if (crc_valid) {
+      crc = copy_crc32c(data_begin, item->content(), part1_size);
+      crc = copy_crc32c(data_sink_.data_buffer().ptr(),
+                        item->content() + part1_size,
+                        item_size.data - part1_size, crc);
+    } else {
+      std::copy_n(item->content(), part1_size, data_begin);
+      std::copy_n(item->content() + part1_size, item_size.data - part1_size,
+                  data_sink_.data_buffer().ptr());
+    }
+  }
+
+  if (crc_valid && crc != item->desc().crc) {
+    if (crc_errors_ == 0) {
+      L_(error) << "crc failure in microslice " << item->desc().idx;
+    }
+    ++crc_errors_;
   }
 
   data_sink_.desc_buffer().at(write_index_.desc) = item->desc();
@@ -12,6 +12,9 @@ namespace fles {
 /**
  * \brief The MicrosliceTransmitter class implements a mechanism to transmit
  * Microslices to an InputBufferWriteInterface object.
+ *
+ * The CRC of microslices flagged as CrcValid is verified while copying the
+ * content to the data sink.
  */
 class MicrosliceTransmitter : public MicrosliceSink {
 public:
@@ -34,6 +37,9 @@ public:
 
   void end_stream() override { data_sink_.set_eof(true); }
 
+  /// Retrieve the number of microslices with CRC mismatch.
+  uint64_t crc_errors() const { return crc_errors_; }
+
 private:
   bool try_put(std::shared_ptr<const Microslice> item);
 
@@ -42,5 +48,8 @@ private:
 
   DualIndex write_index_ = {0, 0};
   DualIndex read_index_cached_ = {0, 0};
+
+  /// Number of microslices with CrcValid flag and CRC mismatch
+  uint64_t crc_errors_ = 0;
 };
 } // namespace fles
@@ -45,6 +45,12 @@ public:
     event_queue_.emplace(cb, when);
   }
 
+  /// Retrieve the time of the next pending event (max() if none).
+  event::time_type next_event_time() const {
+    return event_queue_.empty() ? event::time_type::max()
+                                : event_queue_.top().when_;
+  }
+
   void timer() {
     event::time_type now = std::chrono::system_clock::now();
 
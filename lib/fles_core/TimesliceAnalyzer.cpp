@@ -4,58 +4,80 @@
 #include "PatternChecker.hpp"
 #include "TimesliceDebugger.hpp"
 #include "Utility.hpp"
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 
 TimesliceAnalyzer::TimesliceAnalyzer(uint64_t arg_output_interval,
                                      std::ostream& arg_out,
-                                     std::string arg_output_prefix)
+                                     std::string arg_output_prefix,
+                                     unsigned arg_num_threads)
     : output_interval_(arg_output_interval), out_(arg_out),
       output_prefix_(std::move(arg_output_prefix)) {
-  // create CRC-32C engine (Castagnoli polynomial)
-  crc32_engine_ = crcutil_interface::CRC::Create(
-      0x82f63b78, 0, 32, true, 0, 0, 0,
-      crcutil_interface::CRC::IsSSE42Available(), NULL);
+  unsigned num_threads = arg_num_threads;
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  // create CRC-32C engines (Castagnoli polynomial)
+  for (unsigned i = 0; i < num_threads; ++i) {
+    crc32_engines_.push_back(crcutil_interface::CRC::Create(
+        0x82f63b78, 0, 32, true, 0, 0, 0,
+        crcutil_interface::CRC::IsSSE42Available(), true, NULL));
+  }
+
+  for (unsigned i = 1; i < num_threads; ++i) {
+    workers_.emplace_back(&TimesliceAnalyzer::worker, this, i);
+  }
 }
 
 TimesliceAnalyzer::~TimesliceAnalyzer() {
-  if (crc32_engine_ != nullptr) {
-    crc32_engine_->Delete();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& w : workers_) {
+    w.join();
+  }
+  for (auto* crc32_engine : crc32_engines_) {
+    crc32_engine->Delete();
   }
 }
 
-uint32_t TimesliceAnalyzer::compute_crc(const fles::MicrosliceView m) const {
-  assert(crc32_engine_);
+uint32_t TimesliceAnalyzer::compute_crc(crcutil_interface::CRC* crc32_engine,
+                                        const fles::MicrosliceView m) {
+  assert(crc32_engine);
 
   crcutil_interface::UINT64 crc64 = 0;
-  crc32_engine_->Compute(m.content(), m.desc().size, &crc64);
+  crc32_engine->Compute(m.content(), m.desc().size, &crc64);
 
   return static_cast<uint32_t>(crc64);
 }
 
-bool TimesliceAnalyzer::check_crc(const fles::MicrosliceView m) const {
-  return compute_crc(m) == m.desc().crc;
+bool TimesliceAnalyzer::check_crc(crcutil_interface::CRC* crc32_engine,
+                                  const fles::MicrosliceView m) {
+  return compute_crc(crc32_engine, m) == m.desc().crc;
 }
 
 bool TimesliceAnalyzer::check_microslice(const fles::MicrosliceView m,
                                          size_t component,
-                                         size_t microslice) {
+                                         size_t microslice,
+                                         crcutil_interface::CRC* crc32_engine,
+                                         std::ostream& out) {
 // disabled, not applicable when using start time instead of index
 #if 0
     if (m.desc().idx != microslice) {
-        out_ << "microslice index " << m.desc().idx << " found in m.desc() "
-             << microslice << std::endl;
+        out << "microslice index " << m.desc().idx << " found in m.desc() "
+            << microslice << std::endl;
         return false;
     }
 #endif
 
-  ++microslice_count_;
-  content_bytes_ += m.desc().size;
-
   if ((m.desc().flags &
        static_cast<uint16_t>(fles::MicrosliceFlags::OverflowFlim)) != 0) {
-    out_ << output_prefix_ << " microslice " << microslice
-         << " truncated by FLIM" << std::endl;
+    out << output_prefix_ << " microslice " << microslice
+        << " truncated by FLIM" << std::endl;
   }
 
   if (!pattern_checkers_.at(component)->check(m)) {
@@ -64,14 +86,94 @@ bool TimesliceAnalyzer::check_microslice(const fles::MicrosliceView m,
 
   if (((m.desc().flags &
         static_cast<uint16_t>(fles::MicrosliceFlags::CrcValid)) != 0) &&
-      !check_crc(m)) {
-    out_ << "crc failure in microslice " << microslice << std::endl;
+      !check_crc(crc32_engine, m)) {
+    out << "crc failure in microslice " << microslice << std::endl;
     return false;
   }
 
   return true;
 }
 
+void TimesliceAnalyzer::check_component(const fles::Timeslice& ts,
+                                        size_t component,
+                                        crcutil_interface::CRC* crc32_engine,
+                                        ComponentResult& result) {
+  std::ostringstream out;
+  pattern_checkers_.at(component)->reset();
+  for (size_t m = 0; m < ts.num_microslices(component); ++m) {
+    fles::MicrosliceView ms = ts.get_microslice(component, m);
+    ++result.microslice_count;
+    result.content_bytes += ms.desc().size;
+    if (!check_microslice(ms, component,
+                          ts.index() * ts.num_core_microslices() + m,
+                          crc32_engine, out)) {
+      result.success = false;
+      result.failed_microslice = m;
+      break;
+    }
+  }
+  result.messages = out.str();
+}
+
+void TimesliceAnalyzer::process_components(
+    const fles::Timeslice& ts, crcutil_interface::CRC* crc32_engine) {
+  size_t c;
+  while ((c = next_component_++) < ts.num_components()) {
+    check_component(ts, c, crc32_engine, results_[c]);
+  }
+}
+
+void TimesliceAnalyzer::worker(size_t index) {
+  uint64_t generation = 0;
+  for (;;) {
+    const fles::Timeslice* ts;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock,
+                    [&] { return stop_ || generation_ != generation; });
+      if (stop_) {
+        return;
+      }
+      generation = generation_;
+      ts = current_ts_;
+    }
+
+    process_components(*ts, crc32_engines_.at(index));
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--active_workers_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+}
+
+void TimesliceAnalyzer::check_components(const fles::Timeslice& ts) {
+  results_.assign(ts.num_components(), ComponentResult());
+  next_component_ = 0;
+
+  if (workers_.empty() || ts.num_components() < 2) {
+    process_components(ts, crc32_engines_.at(0));
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_ts_ = &ts;
+    active_workers_ = workers_.size();
+    ++generation_;
+  }
+  work_cv_.notify_all();
+
+  process_components(ts, crc32_engines_.at(0));
+
+  // all workers must be finished before the next timeslice is posted
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return active_workers_ == 0; });
+  current_ts_ = nullptr;
+}
+
 void TimesliceAnalyzer::initialize(const fles::Timeslice& ts) {
   reference_descriptors_.clear();
   pattern_checkers_.clear();
@@ -108,6 +210,12 @@ bool TimesliceAnalyzer::check_timeslice(const fles::Timeslice& ts) {
       ++timeslice_error_count_;
       return false;
     }
+    if (c >= pattern_checkers_.size()) {
+      out_ << "unexpected component " << c << " in timeslice " << ts.index()
+           << std::endl;
+      ++timeslice_error_count_;
+      return false;
+    }
     // ensure all components start with same time
     uint64_t component_start_time = ts.get_microslice(c, 0).desc().idx;
     if (component_start_time != first_component_start_time) {
@@ -120,24 +228,29 @@ bool TimesliceAnalyzer::check_timeslice(const fles::Timeslice& ts) {
       ++timeslice_error_count_;
       return false;
     }
-    // checke all microslices of component
-    pattern_checkers_.at(c)->reset();
-    for (size_t m = 0; m < ts.num_microslices(c); ++m) {
-      bool success =
-          check_microslice(ts.get_microslice(c, m), c,
-                           ts.index() * ts.num_core_microslices() + m);
-      if (!success) {
-        out_ << "pattern error in timeslice " << ts.index() << ", microslice "
-             << m << ", component " << c << std::endl;
-        if (timeslice_error_count_ == 0) { // full dump for first error
-          out_ << "microslice content:\n"
-               << MicrosliceDescriptorDump(ts.get_microslice(c, m).desc())
-               << BufferDump(ts.get_microslice(c, m).content(),
-                             ts.get_microslice(c, m).desc().size);
-        }
-        ++timeslice_error_count_;
-        return false;
+  }
+
+  // check all microslices of all components
+  check_components(ts);
+
+  // merge results in component order, stop at first error
+  for (size_t c = 0; c < ts.num_components(); ++c) {
+    const ComponentResult& result = results_[c];
+    microslice_count_ += result.microslice_count;
+    content_bytes_ += result.content_bytes;
+    out_ << result.messages;
+    if (!result.success) {
+      size_t m = result.failed_microslice;
+      out_ << "pattern error in timeslice " << ts.index() << ", microslice "
+           << m << ", component " << c << std::endl;
+      if (timeslice_error_count_ == 0) { // full dump for first error
+        out_ << "microslice content:\n"
+             << MicrosliceDescriptorDump(ts.get_microslice(c, m).desc())
+             << BufferDump(ts.get_microslice(c, m).content(),
+                           ts.get_microslice(c, m).desc().size);
       }
+      ++timeslice_error_count_;
+      return false;
     }
   }
   return true;
@@ -5,22 +5,46 @@
 #include "Sink.hpp"
 #include "Timeslice.hpp"
 #include "interface.h" // crcutil_interface
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 class PatternChecker;
 
+/**
+ * \brief The TimesliceAnalyzer class checks the content of timeslices.
+ *
+ * The components of a timeslice are checked in parallel by a pool of
+ * `arg_num_threads` threads (including the calling thread, 0: one per
+ * hardware thread), each with its own CRC engine. Results and error
+ * messages are merged in component order, so the output does not depend on
+ * the number of threads.
+ */
 class TimesliceAnalyzer : public fles::TimesliceSink {
 public:
   TimesliceAnalyzer(uint64_t arg_output_interval,
                     std::ostream& arg_out,
-                    std::string arg_output_prefix);
+                    std::string arg_output_prefix,
+                    unsigned arg_num_threads = 1);
   ~TimesliceAnalyzer() override;
 
   void put(std::shared_ptr<const fles::Timeslice> timeslice) override;
 
 private:
+  /// Result of checking a single timeslice component.
+  struct ComponentResult {
+    bool success = true;
+    size_t microslice_count = 0;
+    size_t content_bytes = 0;
+    size_t failed_microslice = 0;
+    std::string messages;
+  };
+
   bool check_timeslice(const fles::Timeslice& ts);
 
   std::string statistics() const;
@@ -29,17 +53,47 @@ private:
     content_bytes_ = 0;
   }
 
-  uint32_t compute_crc(const fles::MicrosliceView m) const;
+  static uint32_t compute_crc(crcutil_interface::CRC* crc32_engine,
+                              const fles::MicrosliceView m);
 
-  bool check_crc(const fles::MicrosliceView m) const;
+  static bool check_crc(crcutil_interface::CRC* crc32_engine,
+                        const fles::MicrosliceView m);
 
   bool check_microslice(const fles::MicrosliceView m,
                         size_t component,
-                        size_t microslice);
+                        size_t microslice,
+                        crcutil_interface::CRC* crc32_engine,
+                        std::ostream& out);
+
+  void check_component(const fles::Timeslice& ts,
+                       size_t component,
+                       crcutil_interface::CRC* crc32_engine,
+                       ComponentResult& result);
+
+  /// Check all components of the timeslice using the thread pool.
+  void check_components(const fles::Timeslice& ts);
+
+  /// Check components of the current timeslice until none are left.
+  void process_components(const fles::Timeslice& ts,
+                          crcutil_interface::CRC* crc32_engine);
+
+  void worker(size_t index);
 
   void initialize(const fles::Timeslice& ts);
 
-  crcutil_interface::CRC* crc32_engine_ = nullptr;
+  /// CRC-32C engines, one per thread (index 0: calling thread)
+  std::vector<crcutil_interface::CRC*> crc32_engines_;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  const fles::Timeslice* current_ts_ = nullptr;
+  uint64_t generation_ = 0;
+  size_t active_workers_ = 0;
+  bool stop_ = false;
+  std::atomic<size_t> next_component_{0};
+  std::vector<ComponentResult> results_;
 
   std::vector<fles::MicrosliceDescriptor> reference_descriptors_;
   std::vector<std::unique_ptr<PatternChecker>> pattern_checkers_;
@@ -0,0 +1,128 @@
+/// \file
+/// \brief Defines the TimesliceAssignment class.
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+/// Dynamic assignment of timeslices to compute nodes.
+/** The first input channel assigns each timeslice to the compute node with
+   the most free buffer space (credits). The compute nodes forward these
+   assignments to the other input channels, which follow them. If a
+   forwarded assignment does not arrive in time, the following input
+   channel falls back to round-robin assignment for the rest of the run. */
+class TimesliceAssignment {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /// Target index returned while waiting for a forwarded assignment.
+  static constexpr int pending = -1;
+
+  /// Target index returned for a timeslice that has most likely been
+  /// assigned to a failed compute node.
+  static constexpr int lost = -2;
+
+  /// The TimesliceAssignment constructor.
+  /**
+   \param num_targets Number of compute nodes
+   \param timeout     Maximum wait for a forwarded assignment (zero to wait
+                      forever)
+   */
+  TimesliceAssignment(size_t num_targets, std::chrono::milliseconds timeout)
+      : num_targets_(num_targets), timeout_(timeout) {}
+
+  /// Select the target with the most free buffer space.
+  /**
+   The search starts at the round-robin target to spread ties evenly.
+
+   \param usable     Predicate, true if a target can accept the timeslice
+   \param free_space Function returning the free buffer space of a target
+   \return Index of the selected target, or pending if none is usable
+   */
+  template <typename Usable, typename FreeSpace>
+  int select_by_credit(uint64_t timeslice,
+                       Usable usable,
+                       FreeSpace free_space) const {
+    int best = pending;
+    uint64_t best_free = 0;
+    for (size_t i = 0; i < num_targets_; ++i) {
+      int target = static_cast<int>((timeslice + i) % num_targets_);
+      if (!usable(target)) {
+        continue;
+      }
+      uint64_t free = free_space(target);
+      if (best == pending || free > best_free) {
+        best = target;
+        best_free = free;
+      }
+    }
+    return best;
+  }
+
+  /// Record an assignment forwarded by a compute node.
+  void assign(uint64_t timeslice, int target) {
+    if (!fallback_) {
+      assignments_[timeslice] = target;
+    }
+  }
+
+  /// Forget the assignment of a timeslice that has been sent or dropped.
+  void erase(uint64_t timeslice) { assignments_.erase(timeslice); }
+
+  /// Retrieve the target of a timeslice from the forwarded assignments.
+  /**
+   \param timeslice     Index of the next timeslice to send
+   \param target_failed Whether any compute node has failed
+   \param now           Current time
+   \return Target index, pending or lost
+   */
+  int follow(uint64_t timeslice, bool target_failed, clock::time_point now) {
+    if (fallback_) {
+      return static_cast<int>(timeslice % num_targets_);
+    }
+    auto it = assignments_.find(timeslice);
+    if (it != assignments_.end()) {
+      return it->second;
+    }
+    if (timeout_.count() == 0) {
+      return pending;
+    }
+    if (wait_timeslice_ != timeslice) {
+      wait_timeslice_ = timeslice;
+      wait_begin_ = now;
+      return pending;
+    }
+    if (now - wait_begin_ < timeout_) {
+      return pending;
+    }
+    if (target_failed && !assignments_.empty() &&
+        assignments_.rbegin()->first > timeslice) {
+      // later timeslices have been assigned, so this one has most likely
+      // been assigned to a failed compute node that could not forward it
+      return lost;
+    }
+    // the deciding input channel no longer forwards assignments
+    fallback_ = true;
+    assignments_.clear();
+    return static_cast<int>(timeslice % num_targets_);
+  }
+
+  /// Check if the assignment has fallen back to round-robin.
+  bool fallback() const { return fallback_; }
+
+private:
+  size_t num_targets_;
+  std::chrono::milliseconds timeout_;
+
+  /// Forwarded assignments not yet used (timeslice index to target index).
+  std::map<uint64_t, int> assignments_;
+
+  /// Timeslice waiting for its assignment, and the start of the wait.
+  uint64_t wait_timeslice_ = UINT64_MAX;
+  clock::time_point wait_begin_;
+
+  /// Flag, true once forwarded assignments are no longer awaited.
+  bool fallback_ = false;
+};
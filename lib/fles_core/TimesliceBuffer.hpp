@@ -5,10 +5,12 @@
 #include "TimesliceComponentDescriptor.hpp"
 #include "TimesliceWorkItem.hpp"
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/interprocess/ipc/message_queue.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
 
+#include <chrono>
 #include <csignal>
 
 /// Timeslice buffer container class.
@@ -72,6 +74,22 @@ public:
     return true;
   };
 
+  bool timed_receive_completion(fles::TimesliceCompletion& c,
+                                std::chrono::milliseconds timeout) {
+    std::size_t recvd_size;
+    unsigned int priority;
+    boost::posix_time::ptime abs_time =
+        boost::posix_time::microsec_clock::universal_time() +
+        boost::posix_time::milliseconds(timeout.count());
+    if (!completions_mq_->timed_receive(&c, sizeof(c), recvd_size, priority,
+                                        abs_time))
+      return false;
+    if (recvd_size == 0)
+      return false;
+    assert(recvd_size == sizeof(c));
+    return true;
+  };
+
 private:
   std::string shm_identifier_;
 
@@ -0,0 +1,97 @@
+#include "TimesliceLatencyMonitor.hpp"
+#include "Utility.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+TimesliceLatencyMonitor::TimesliceLatencyMonitor(const std::string& trace_file)
+    : trace_(trace_file) {
+  if (!trace_) {
+    throw std::runtime_error("could not open latency trace file " +
+                             trace_file);
+  }
+  trace_ << "index,bytes,receive_ns,latency_ns\n";
+}
+
+TimesliceLatencyMonitor::~TimesliceLatencyMonitor() {
+  L_(info) << "latency monitor: " << timeslice_count_ << " timeslices, "
+           << human_readable_count(content_bytes_);
+  if (last_receive_ns_ > first_receive_ns_) {
+    double seconds = static_cast<double>(last_receive_ns_ - first_receive_ns_) *
+                     1e-9;
+    L_(info) << "latency monitor: "
+             << human_readable_count(
+                    static_cast<uint64_t>(
+                        static_cast<double>(content_bytes_) / seconds),
+                    true, "B/s")
+             << ", "
+             << static_cast<double>(timeslice_count_ - 1) / seconds
+             << " timeslices/s";
+  }
+  if (!latencies_.empty()) {
+    std::sort(latencies_.begin(), latencies_.end());
+    auto at = [this](double p) {
+      return latencies_[static_cast<std::size_t>(
+          p * static_cast<double>(latencies_.size() - 1))];
+    };
+    L_(info) << "latency monitor: latency p50 " << at(0.5) / 1000
+             << " us, p90 " << at(0.9) / 1000 << " us, p99 " << at(0.99) / 1000
+             << " us, max " << latencies_.back() / 1000 << " us";
+  }
+}
+
+uint64_t TimesliceLatencyMonitor::now_ns() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+bool TimesliceLatencyMonitor::latency(const fles::Timeslice& ts,
+                                      uint64_t now_ns,
+                                      int64_t& latency_ns) {
+  uint64_t m = ts.num_core_microslices();
+  if (m == 0) {
+    return false;
+  }
+  uint64_t youngest = 0;
+  for (uint64_t c = 0; c < ts.num_components(); ++c) {
+    if (ts.num_microslices(c) < m ||
+        ts.descriptor(c, m - 1).size < sizeof(uint64_t)) {
+      return false;
+    }
+    uint64_t timestamp;
+    std::memcpy(&timestamp, ts.content(c, m - 1), sizeof(timestamp));
+    youngest = std::max(youngest, timestamp);
+  }
+  latency_ns = static_cast<int64_t>(now_ns - youngest);
+  return true;
+}
+
+void TimesliceLatencyMonitor::put(
+    std::shared_ptr<const fles::Timeslice> timeslice) {
+  uint64_t now = now_ns();
+  uint64_t bytes = 0;
+  for (uint64_t c = 0; c < timeslice->num_components(); ++c) {
+    for (uint64_t m = 0; m < timeslice->num_microslices(c); ++m) {
+      bytes += timeslice->descriptor(c, m).size;
+    }
+  }
+
+  if (timeslice_count_ == 0) {
+    first_receive_ns_ = now;
+  }
+  last_receive_ns_ = now;
+  ++timeslice_count_;
+  content_bytes_ += bytes;
+
+  trace_ << timeslice->index() << "," << bytes << "," << now << ",";
+  int64_t latency_ns;
+  if (latency(*timeslice, now, latency_ns)) {
+    latencies_.push_back(latency_ns);
+    trace_ << latency_ns;
+  }
+  trace_ << "\n";
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Sink.hpp"
+#include "Timeslice.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * \brief The TimesliceLatencyMonitor class records the end-to-end latency
+ * of timeslices.
+ *
+ * Requires microslices that carry their generation time (nanoseconds since
+ * epoch, system clock) in the first content word, as written by the
+ * FlesnetPatternGenerator with `write_timestamps` set. The latency of a
+ * timeslice is the time from the generation of its youngest core
+ * microslice until it is received here. Producer and consumer must be on
+ * the same host.
+ *
+ * For each timeslice, a line `index,bytes,receive_ns,latency_ns` is written
+ * to the trace file (latency_ns is empty if not available). A summary is
+ * logged on destruction.
+ */
+class TimesliceLatencyMonitor : public fles::TimesliceSink {
+public:
+  explicit TimesliceLatencyMonitor(const std::string& trace_file);
+  ~TimesliceLatencyMonitor() override;
+
+  void put(std::shared_ptr<const fles::Timeslice> timeslice) override;
+
+  /// Retrieve the latency (ns) of a timeslice received at time `now_ns`,
+  /// return false if the timeslice does not contain timestamps.
+  static bool latency(const fles::Timeslice& ts,
+                      uint64_t now_ns,
+                      int64_t& latency_ns);
+
+  /// Retrieve the current time in ns since epoch (system clock).
+  static uint64_t now_ns();
+
+private:
+  std::ofstream trace_;
+  std::vector<int64_t> latencies_;
+  uint64_t timeslice_count_ = 0;
+  uint64_t content_bytes_ = 0;
+  uint64_t first_receive_ns_ = 0;
+  uint64_t last_receive_ns_ = 0;
+};
@@ -0,0 +1,75 @@
+/// \file
+/// \brief Defines the TournamentTree class template.
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+/// Tournament tree tracking the minimum of a fixed number of values.
+/** Updating a value takes O(log n) comparisons, retrieving the minimum and
+   its index takes constant time. Of several equal minimum values, the one
+   with the lowest index wins. */
+template <typename T> class TournamentTree {
+public:
+  /// The TournamentTree constructor.
+  explicit TournamentTree(std::size_t size, T initial_value = T())
+      : size_(size) {
+    while (capacity_ < size_) {
+      capacity_ <<= 1;
+    }
+    // unused leaves never win
+    values_.assign(capacity_, std::numeric_limits<T>::max());
+    std::fill(values_.begin(), values_.begin() + static_cast<long>(size_),
+              initial_value);
+    winners_.resize(2 * capacity_);
+    for (std::size_t i = 0; i < capacity_; ++i) {
+      winners_[capacity_ + i] = i;
+    }
+    for (std::size_t node = capacity_ - 1; node > 0; --node) {
+      replay(node);
+    }
+    if (capacity_ == 1) {
+      winners_[1] = 0;
+    }
+  }
+
+  /// Set the value at the given index.
+  void update(std::size_t index, T value) {
+    assert(index < size_);
+    values_[index] = value;
+    for (std::size_t node = (capacity_ + index) / 2; node > 0; node /= 2) {
+      replay(node);
+    }
+  }
+
+  /// Retrieve the value at the given index.
+  T value(std::size_t index) const { return values_[index]; }
+
+  /// Retrieve the minimum value.
+  T min() const { return values_[winners_[1]]; }
+
+  /// Retrieve the index of the minimum value.
+  std::size_t min_index() const { return winners_[1]; }
+
+  /// Retrieve the number of values.
+  std::size_t size() const { return size_; }
+
+private:
+  void replay(std::size_t node) {
+    std::size_t left = winners_[2 * node];
+    std::size_t right = winners_[2 * node + 1];
+    winners_[node] = (values_[right] < values_[left]) ? right : left;
+  }
+
+  std::size_t size_;
+  std::size_t capacity_ = 1;
+
+  /// Values of the leaves (padded to a power of two).
+  std::vector<T> values_;
+
+  /// Index of the winning leaf per node (root at 1, leaves at capacity_).
+  std::vector<std::size_t> winners_;
+};
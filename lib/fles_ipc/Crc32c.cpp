@@ -0,0 +1,196 @@
+#include "Crc32c.hpp"
+#include <cstring>
+
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#define FLES_HAVE_CRC32C_SSE42 1
+#include <nmmintrin.h>
+#else
+#define FLES_HAVE_CRC32C_SSE42 0
+#endif
+
+namespace fles {
+
+namespace {
+
+/// CRC-32C polynomial, reflected bit order
+constexpr uint32_t crc32c_poly = 0x82f63b78;
+
+/// Length of each of the three interleaved streams (bytes), large blocks are
+/// used for long buffers, short blocks for the remainder
+constexpr std::size_t long_stream_bytes = 4096;
+constexpr std::size_t short_stream_bytes = 256;
+
+/// Multiply a(x) and b(x) modulo the CRC polynomial (reflected bit order).
+uint32_t multmodp(uint32_t a, uint32_t b) {
+  uint32_t m = UINT32_C(1) << 31;
+  uint32_t p = 0;
+  for (; m != 0; m >>= 1) {
+    if ((a & m) != 0) {
+      p ^= b;
+    }
+    b = ((b & 1) != 0) ? (b >> 1) ^ crc32c_poly : b >> 1;
+  }
+  return p;
+}
+
+/// Compute x^(8 * n) modulo the CRC polynomial.
+uint32_t x8nmodp(std::size_t n) {
+  uint32_t result = UINT32_C(1) << 31; // x^0
+  uint32_t power = UINT32_C(1) << 23;  // x^8
+  for (; n != 0; n >>= 1) {
+    if ((n & 1) != 0) {
+      result = multmodp(power, result);
+    }
+    power = multmodp(power, power);
+  }
+  return result;
+}
+
+/// Lookup tables for the CRC computation.
+struct Tables {
+  Tables() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = ((c & 1) != 0) ? (c >> 1) ^ crc32c_poly : c >> 1;
+      }
+      bytewise[i] = c;
+    }
+    init_shift(long_shift, long_stream_bytes);
+    init_shift(short_shift, short_stream_bytes);
+  }
+
+  // Shifting a CRC state over n zero bytes is linear in the state, so it can
+  // be split into four byte-indexed tables
+  using ShiftTable = uint32_t[4][256];
+
+  static void init_shift(ShiftTable& shift, std::size_t n) {
+    uint32_t x8n = x8nmodp(n);
+    for (uint32_t j = 0; j < 4; ++j) {
+      for (uint32_t i = 0; i < 256; ++i) {
+        shift[j][i] = multmodp(x8n, i << (8 * j));
+      }
+    }
+  }
+
+  static uint32_t apply_shift(const ShiftTable& shift, uint32_t state) {
+    return shift[0][state & 0xff] ^ shift[1][(state >> 8) & 0xff] ^
+           shift[2][(state >> 16) & 0xff] ^ shift[3][state >> 24];
+  }
+
+  uint32_t bytewise[256];
+  ShiftTable long_shift;
+  ShiftTable short_shift;
+};
+
+const Tables& tables() {
+  static const Tables t;
+  return t;
+}
+
+inline uint64_t load64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline void store64(uint8_t* p, uint64_t v) { std::memcpy(p, &v, sizeof(v)); }
+
+#if FLES_HAVE_CRC32C_SSE42
+
+/// Process blocks of three interleaved streams of `StreamBytes` each and
+/// advance the pointers accordingly.
+template <bool Copy, std::size_t StreamBytes>
+uint32_t update_blocks(uint32_t state,
+                       uint8_t*& dst,
+                       const uint8_t*& src,
+                       std::size_t& size,
+                       const Tables::ShiftTable& shift) {
+  for (; size >= 3 * StreamBytes; size -= 3 * StreamBytes) {
+    uint64_t s0 = state;
+    uint64_t s1 = 0;
+    uint64_t s2 = 0;
+    for (std::size_t i = 0; i < StreamBytes; i += 8) {
+      uint64_t v0 = load64(src + i);
+      uint64_t v1 = load64(src + StreamBytes + i);
+      uint64_t v2 = load64(src + 2 * StreamBytes + i);
+      if (Copy) {
+        store64(dst + i, v0);
+        store64(dst + StreamBytes + i, v1);
+        store64(dst + 2 * StreamBytes + i, v2);
+      }
+      s0 = _mm_crc32_u64(s0, v0);
+      s1 = _mm_crc32_u64(s1, v1);
+      s2 = _mm_crc32_u64(s2, v2);
+    }
+    state = Tables::apply_shift(
+                shift, Tables::apply_shift(shift, static_cast<uint32_t>(s0)) ^
+                           static_cast<uint32_t>(s1)) ^
+            static_cast<uint32_t>(s2);
+    src += 3 * StreamBytes;
+    if (Copy) {
+      dst += 3 * StreamBytes;
+    }
+  }
+  return state;
+}
+
+#endif
+
+/// Update the raw (non-inverted) CRC state, optionally copying the data.
+template <bool Copy>
+uint32_t update(uint32_t state,
+                uint8_t* dst,
+                const uint8_t* src,
+                std::size_t size) {
+#if FLES_HAVE_CRC32C_SSE42
+  const Tables& t = tables();
+  state = update_blocks<Copy, long_stream_bytes>(state, dst, src, size,
+                                                 t.long_shift);
+  state = update_blocks<Copy, short_stream_bytes>(state, dst, src, size,
+                                                  t.short_shift);
+
+  uint64_t s = state;
+  for (; size >= 8; size -= 8) {
+    uint64_t v = load64(src);
+    if (Copy) {
+      store64(dst, v);
+      dst += 8;
+    }
+    s = _mm_crc32_u64(s, v);
+    src += 8;
+  }
+  state = static_cast<uint32_t>(s);
+  for (; size != 0; --size) {
+    if (Copy) {
+      *dst++ = *src;
+    }
+    state = _mm_crc32_u8(state, *src++);
+  }
+  return state;
+#else
+  if (Copy) {
+    std::memcpy(dst, src, size);
+  }
+  const uint32_t* bytewise = tables().bytewise;
+  for (std::size_t i = 0; i < size; ++i) {
+    state = bytewise[(state ^ src[i]) & 0xff] ^ (state >> 8);
+  }
+  return state;
+#endif
+}
+
+} // namespace
+
+uint32_t crc32c(const uint8_t* data, std::size_t size, uint32_t crc) {
+  return ~update<false>(~crc, nullptr, data, size);
+}
+
+uint32_t copy_crc32c(uint8_t* dst,
+                     const uint8_t* src,
+                     std::size_t size,
+                     uint32_t crc) {
+  return ~update<true>(~crc, dst, src, size);
+}
+
+} // namespace fles
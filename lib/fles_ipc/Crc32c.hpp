@@ -0,0 +1,34 @@
+/// \file
+/// \brief Defines CRC-32C checksum functions, including a fused copy.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace fles {
+
+/**
+ * \brief Compute the CRC-32C (Castagnoli) checksum of a buffer.
+ *
+ * The result is the same as that of the reference implementation in
+ * Microslice::compute_crc(). To compute the checksum of data split into
+ * several buffers, pass the result for the preceding buffers as `crc`.
+ *
+ * On CPUs with SSE4.2, three interleaved streams of `crc32` instructions
+ * are used, combined by a table-based shift of the partial checksums.
+ */
+uint32_t crc32c(const uint8_t* data, std::size_t size, uint32_t crc = 0);
+
+/**
+ * \brief Copy a buffer and compute its CRC-32C checksum in the same pass.
+ *
+ * Equivalent to copying `size` bytes from `src` to `dst` (which must not
+ * overlap) followed by crc32c(src, size, crc), but reads the source data
+ * only once.
+ */
+uint32_t copy_crc32c(uint8_t* dst,
+                     const uint8_t* src,
+                     std::size_t size,
+                     uint32_t crc = 0);
+
+} // namespace fles
@@ -0,0 +1,328 @@
+#include "LatencyTracer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <unistd.h>
+
+namespace fles {
+
+namespace {
+uint64_t round_up_pow2(uint64_t value) {
+  uint64_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+} // namespace
+
+const char* trace_stage_name(TraceStage stage) {
+  switch (stage) {
+  case TraceStage::MicrosliceWritten:
+    return "microslice_written";
+  case TraceStage::SenderStart:
+    return "sender_start";
+  case TraceStage::TransferComplete:
+    return "transfer_complete";
+  case TraceStage::WorkItemSent:
+    return "work_item_sent";
+  case TraceStage::ConsumerReceived:
+    return "consumer_received";
+  case TraceStage::Completed:
+    return "completed";
+  }
+  return "unknown";
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+LatencyHistogram::LatencyHistogram()
+    : buckets_((64 - sub_bucket_bits + 1) * sub_bucket_count) {}
+
+std::size_t LatencyHistogram::bucket_index(uint64_t value) {
+  if (value < 2 * sub_bucket_count) {
+    return value;
+  }
+  // values [2^(e+b), 2^(e+b+1)) map to sub-buckets of width 2^e
+  unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+  unsigned e = msb - sub_bucket_bits;
+  return e * sub_bucket_count + (value >> e);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) {
+  if (index < 2 * sub_bucket_count) {
+    return index;
+  }
+  uint64_t e = index / sub_bucket_count - 1;
+  uint64_t sub = index - e * sub_bucket_count;
+  return ((sub + 1) << e) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+  ++buckets_[bucket_index(value)];
+  ++count_;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+  sum_ += static_cast<double>(value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  for (std::size_t i = 0; i < buckets_.size(); ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+  sum_ += other.sum_;
+}
+
+double LatencyHistogram::mean() const {
+  return count_ ? sum_ / static_cast<double>(count_) : 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(count_));
+  rank = std::max(UINT64_C(1), std::min(rank, count_));
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < buckets_.size(); ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return std::max(min_, std::min(max_, bucket_upper_bound(i)));
+    }
+  }
+  return max_;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+LatencySummary::LatencySummary(std::vector<TraceEvent> events) {
+  // latest timestamp per timeslice and stage (0 if not recorded)
+  std::map<uint64_t, std::array<uint64_t, num_trace_stages>> timeslices;
+  for (const auto& event : events) {
+    auto& times = timeslices[event.ts_index];
+    auto& time = times[static_cast<std::size_t>(event.stage)];
+    time = std::max(time, event.time_ns);
+  }
+
+  for (const auto& ts : timeslices) {
+    const auto& times = ts.second;
+    uint64_t first = 0;
+    uint64_t previous = 0;
+    for (std::size_t s = 0; s < num_trace_stages; ++s) {
+      if (times[s] == 0) {
+        continue;
+      }
+      if (previous != 0) {
+        // clocks of different hosts may be slightly out of sync
+        stages_[s].record(times[s] > previous ? times[s] - previous : 0);
+      } else {
+        first = times[s];
+      }
+      previous = times[s];
+    }
+    if (previous != first) {
+      total_.record(previous > first ? previous - first : 0);
+    }
+  }
+}
+
+void LatencySummary::write(std::ostream& out) const {
+  auto write_line = [&out](const char* name, const LatencyHistogram& h) {
+    out << std::left << std::setw(20) << name << std::right << std::setw(10)
+        << h.count() << std::setw(12) << h.min() / 1000.0 << std::setw(12)
+        << h.percentile(50) / 1000.0 << std::setw(12)
+        << h.percentile(90) / 1000.0 << std::setw(12)
+        << h.percentile(99) / 1000.0 << std::setw(12)
+        << h.percentile(99.9) / 1000.0 << std::setw(12) << h.max() / 1000.0
+        << std::setw(12) << h.mean() / 1000.0 << "\n";
+  };
+
+  out << std::left << std::setw(20) << "stage (us)" << std::right
+      << std::setw(10) << "count" << std::setw(12) << "min" << std::setw(12)
+      << "p50" << std::setw(12) << "p90" << std::setw(12) << "p99"
+      << std::setw(12) << "p99.9" << std::setw(12) << "max" << std::setw(12)
+      << "mean"
+      << "\n";
+  auto flags = out.flags();
+  out << std::fixed << std::setprecision(1);
+  for (std::size_t s = 0; s < num_trace_stages; ++s) {
+    if (stages_[s].count() > 0) {
+      write_line(trace_stage_name(static_cast<TraceStage>(s)), stages_[s]);
+    }
+  }
+  if (total_.count() > 0) {
+    write_line("total", total_);
+  }
+  out.flags(flags);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+LatencyTracer& LatencyTracer::instance() {
+  // never destroyed, trace points may be passed during static destruction
+  static LatencyTracer* tracer = new LatencyTracer();
+  return *tracer;
+}
+
+LatencyTracer::LatencyTracer() {
+  const char* prefix = std::getenv("FLESNET_TRACE");
+  if (prefix != nullptr && *prefix != '\0') {
+    enable(prefix);
+  }
+}
+
+void LatencyTracer::enable(const std::string& file_prefix,
+                           std::size_t ring_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (enabled()) {
+    return;
+  }
+  file_prefix_ = file_prefix;
+  ring_size_ = round_up_pow2(std::max(ring_size, std::size_t(1)));
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void LatencyTracer::set_timeslice_geometry(uint32_t timeslice_size,
+                                           uint32_t overlap_size) {
+  timeslice_geometry_.store(
+      (static_cast<uint64_t>(timeslice_size) << 32) | overlap_size,
+      std::memory_order_relaxed);
+}
+
+LatencyTracer::Ring& LatencyTracer::thread_ring() {
+  thread_local Ring* ring = nullptr;
+  if (ring == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rings_.emplace_back(new Ring(ring_size_));
+    ring = rings_.back().get();
+  }
+  return *ring;
+}
+
+void LatencyTracer::record(TraceStage stage, uint64_t ts_index) {
+  Ring& ring = thread_ring();
+  uint64_t head = ring.head.load(std::memory_order_relaxed);
+  Slot& slot = ring.slots[head & (ring.slots.size() - 1)];
+  // a reader that sees the new slot content also sees the previous head,
+  // see events()
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.ts_index.store(ts_index, std::memory_order_relaxed);
+  slot.time_ns.store(now_ns(), std::memory_order_relaxed);
+  slot.stage.store(static_cast<uint8_t>(stage), std::memory_order_relaxed);
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+void LatencyTracer::record_microslice(uint64_t microslice_index) {
+  uint64_t geometry = timeslice_geometry_.load(std::memory_order_relaxed);
+  uint64_t timeslice_size = geometry >> 32;
+  uint64_t overlap_size = geometry & 0xFFFFFFFF;
+  // timeslice n requires microslices up to (n + 1) * size + overlap - 1
+  uint64_t end = microslice_index + 1;
+  if (timeslice_size == 0 || end < timeslice_size + overlap_size ||
+      (end - overlap_size) % timeslice_size != 0) {
+    return;
+  }
+  record(TraceStage::MicrosliceWritten,
+         (end - overlap_size) / timeslice_size - 1);
+}
+
+std::vector<TraceEvent> LatencyTracer::events() const {
+  std::vector<TraceEvent> result;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& ring : rings_) {
+    const uint64_t size = ring->slots.size();
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t begin = ring->tail.load(std::memory_order_relaxed);
+    begin = std::max(begin, head > size ? head - size : 0);
+    std::vector<TraceEvent> copy;
+    for (uint64_t i = begin; i < head; ++i) {
+      const Slot& slot = ring->slots[i & (size - 1)];
+      copy.push_back({slot.ts_index.load(std::memory_order_relaxed),
+                      slot.time_ns.load(std::memory_order_relaxed),
+                      static_cast<TraceStage>(
+                          slot.stage.load(std::memory_order_relaxed))});
+    }
+    // drop events that may have been overwritten while copying, the slot
+    // at new_head may be in the middle of being written
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t new_head = ring->head.load(std::memory_order_relaxed);
+    uint64_t valid = new_head + 1 > size ? new_head + 1 - size : 0;
+    auto skip = std::min(copy.size(),
+                         static_cast<std::size_t>(
+                             valid > begin ? valid - begin : 0));
+    result.insert(result.end(),
+                  copy.begin() + static_cast<std::ptrdiff_t>(skip),
+                  copy.end());
+  }
+  return result;
+}
+
+void LatencyTracer::dump() const {
+  if (file_prefix_.empty()) {
+    return;
+  }
+  std::vector<TraceEvent> all_events = events();
+  std::sort(all_events.begin(), all_events.end(),
+            [](const TraceEvent& a, const TraceEvent& b) {
+              return a.time_ns < b.time_ns;
+            });
+  std::string base = file_prefix_ + "_" + std::to_string(getpid());
+
+  std::ofstream csv(base + ".csv");
+  csv << "ts_index,stage,time_ns\n";
+  for (const auto& event : all_events) {
+    csv << event.ts_index << "," << trace_stage_name(event.stage) << ","
+        << event.time_ns << "\n";
+  }
+
+  std::ofstream txt(base + ".txt");
+  LatencySummary(std::move(all_events)).write(txt);
+}
+
+void LatencyTracer::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& ring : rings_) {
+    ring->tail.store(ring->head.load(std::memory_order_acquire),
+                     std::memory_order_relaxed);
+  }
+}
+
+uint64_t LatencyTracer::now_ns() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+LatencyTraceDumper::LatencyTraceDumper(volatile std::sig_atomic_t* request)
+    : request_(request), thread_(&LatencyTraceDumper::run, this) {}
+
+LatencyTraceDumper::~LatencyTraceDumper() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_all();
+  thread_.join();
+}
+
+void LatencyTraceDumper::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_) {
+    stop_cv_.wait_for(lock, std::chrono::milliseconds(100));
+    if (*request_ != 0) {
+      *request_ = 0;
+      LatencyTracer::instance().dump();
+    }
+  }
+}
+
+} // namespace fles
@@ -0,0 +1,257 @@
+/// \file
+/// \brief Defines the fles::LatencyTracer class and related types.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fles {
+
+/// Pipeline stages of a timeslice, in the order they are passed.
+enum class TraceStage : uint8_t {
+  MicrosliceWritten, ///< Last microslice written by the source
+  SenderStart,       ///< Timeslice picked up by the input sender
+  TransferComplete,  ///< RDMA/ZeroMQ write of the component completed
+  WorkItemSent,      ///< Work item sent by the timeslice builder
+  ConsumerReceived,  ///< Work item received by the TimesliceReceiver
+  Completed          ///< Timeslice completion sent by the consumer
+};
+
+/// Number of pipeline stages in TraceStage.
+constexpr std::size_t num_trace_stages = 6;
+
+/// Retrieve the name of a pipeline stage.
+const char* trace_stage_name(TraceStage stage);
+
+/// A single timestamp of a timeslice passing a pipeline stage.
+struct TraceEvent {
+  uint64_t ts_index; ///< Index of the timeslice
+  uint64_t time_ns;  ///< Time in ns since epoch (system clock)
+  TraceStage stage;  ///< Pipeline stage
+};
+
+/**
+ * \brief The LatencyHistogram class records latency values in a
+ * log-linear (HDR-style) histogram.
+ *
+ * Each power of two is divided into 32 linear sub-buckets, so any value is
+ * resolved with a relative error below 1/32 using a fixed amount of memory.
+ */
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+
+  /// Record a single value.
+  void record(uint64_t value);
+
+  /// Add all values recorded in another histogram.
+  void merge(const LatencyHistogram& other);
+
+  /// Retrieve the number of recorded values.
+  uint64_t count() const { return count_; }
+
+  /// Retrieve the smallest recorded value.
+  uint64_t min() const { return count_ ? min_ : 0; }
+
+  /// Retrieve the largest recorded value.
+  uint64_t max() const { return max_; }
+
+  /// Retrieve the mean of the recorded values.
+  double mean() const;
+
+  /// Retrieve the given percentile (0..100) of the recorded values.
+  uint64_t percentile(double p) const;
+
+private:
+  static constexpr unsigned sub_bucket_bits = 5;
+  static constexpr uint64_t sub_bucket_count = UINT64_C(1) << sub_bucket_bits;
+
+  static std::size_t bucket_index(uint64_t value);
+  static uint64_t bucket_upper_bound(std::size_t index);
+
+  std::vector<uint64_t> buckets_;
+  uint64_t count_ = 0;
+  uint64_t min_ = UINT64_MAX;
+  uint64_t max_ = 0;
+  double sum_ = 0;
+};
+
+/**
+ * \brief The LatencySummary class aggregates trace events per pipeline
+ * stage.
+ *
+ * For each timeslice, the latest timestamp of each stage is used (i.e.,
+ * the slowest component determines the progress of a timeslice). The
+ * histogram of a stage contains the time from the closest preceding stage
+ * recorded for the same timeslice. The total histogram contains the time
+ * from the first to the last recorded stage.
+ */
+class LatencySummary {
+public:
+  /// Aggregate the given trace events.
+  explicit LatencySummary(std::vector<TraceEvent> events);
+
+  /// Retrieve the histogram of intervals ending in the given stage.
+  const LatencyHistogram& stage(TraceStage stage) const {
+    return stages_[static_cast<std::size_t>(stage)];
+  }
+
+  /// Retrieve the histogram of total per-timeslice latencies.
+  const LatencyHistogram& total() const { return total_; }
+
+  /// Write a human-readable table of all non-empty histograms.
+  void write(std::ostream& out) const;
+
+private:
+  std::array<LatencyHistogram, num_trace_stages> stages_;
+  LatencyHistogram total_;
+};
+
+/**
+ * \brief The LatencyTracer class records per-timeslice timestamps at the
+ * pipeline stages.
+ *
+ * Tracing is disabled by default and costs a single relaxed atomic load per
+ * trace point. Once enabled, each thread records into a preallocated ring
+ * buffer of its own, so recording neither allocates nor locks. If a ring
+ * buffer overflows, the oldest events are overwritten.
+ *
+ * Tracing is enabled either explicitly by enable() or by setting the
+ * environment variable `FLESNET_TRACE` to a file name prefix. On dump(), the
+ * events and a histogram summary are written to `<prefix>_<pid>.csv` and
+ * `<prefix>_<pid>.txt`. When to dump is left to the application, see also
+ * LatencyTraceDumper. Timestamps are taken from the system clock, so the
+ * raw events of several processes on synchronized hosts can be merged.
+ */
+class LatencyTracer {
+public:
+  /// Retrieve the process-wide tracer instance.
+  static LatencyTracer& instance();
+
+  /// Delete copy constructor (non-copyable).
+  LatencyTracer(const LatencyTracer&) = delete;
+  /// Delete assignment operator (non-copyable).
+  void operator=(const LatencyTracer&) = delete;
+
+  /**
+   * \brief Enable tracing.
+   *
+   * @param file_prefix Prefix of the dump files (no dump if empty)
+   * @param ring_size   Number of events per thread ring buffer
+   */
+  void enable(const std::string& file_prefix,
+              std::size_t ring_size = default_ring_size);
+
+  /// Query whether tracing is enabled.
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /// Set the timeslice geometry used to map microslices to timeslices.
+  void set_timeslice_geometry(uint32_t timeslice_size, uint32_t overlap_size);
+
+  /// Record a timeslice passing a pipeline stage.
+  void record(TraceStage stage, uint64_t ts_index);
+
+  /// Record a microslice written by a source. Only the last microslice
+  /// required to complete a timeslice is recorded.
+  void record_microslice(uint64_t microslice_index);
+
+  /// Retrieve a snapshot of the events recorded by all threads.
+  std::vector<TraceEvent> events() const;
+
+  /// Write the events and the summary to the dump files.
+  void dump() const;
+
+  /// Discard all recorded events.
+  void clear();
+
+  /// Retrieve the current time in ns since epoch (system clock).
+  static uint64_t now_ns();
+
+  static constexpr std::size_t default_ring_size = 1 << 16;
+
+private:
+  /// A TraceEvent that can be read while the owning thread overwrites it.
+  struct Slot {
+    std::atomic<uint64_t> ts_index{0};
+    std::atomic<uint64_t> time_ns{0};
+    std::atomic<uint8_t> stage{0};
+  };
+
+  struct Ring {
+    explicit Ring(std::size_t size) : slots(size) {}
+    std::vector<Slot> slots;
+    std::atomic<uint64_t> head{0}; ///< Written by the owning thread only
+    std::atomic<uint64_t> tail{0}; ///< Events before tail are discarded
+  };
+
+  LatencyTracer();
+
+  Ring& thread_ring();
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> timeslice_geometry_{0};
+  std::size_t ring_size_ = default_ring_size;
+  std::string file_prefix_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+/**
+ * \brief The LatencyTraceDumper class dumps the latency trace on request.
+ *
+ * A background thread polls a flag owned by the application, which is
+ * typically set from a signal handler, and calls LatencyTracer::dump()
+ * whenever it is set. The library itself does not install any signal
+ * handler.
+ */
+class LatencyTraceDumper {
+public:
+  /// The LatencyTraceDumper constructor, starts the polling thread.
+  explicit LatencyTraceDumper(volatile std::sig_atomic_t* request);
+
+  /// Delete copy constructor (non-copyable).
+  LatencyTraceDumper(const LatencyTraceDumper&) = delete;
+  /// Delete assignment operator (non-copyable).
+  void operator=(const LatencyTraceDumper&) = delete;
+
+  /// The LatencyTraceDumper destructor, stops the polling thread.
+  ~LatencyTraceDumper();
+
+private:
+  void run();
+
+  volatile std::sig_atomic_t* request_;
+  std::mutex mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+/// Record a timeslice passing a pipeline stage if tracing is enabled.
+inline void trace(TraceStage stage, uint64_t ts_index) {
+  LatencyTracer& tracer = LatencyTracer::instance();
+  if (tracer.enabled()) {
+    tracer.record(stage, ts_index);
+  }
+}
+
+/// Record a microslice written by a source if tracing is enabled.
+inline void trace_microslice(uint64_t microslice_index) {
+  LatencyTracer& tracer = LatencyTracer::instance();
+  if (tracer.enabled()) {
+    tracer.record_microslice(microslice_index);
+  }
+}
+
+} // namespace fles
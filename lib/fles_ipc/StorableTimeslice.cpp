@@ -19,6 +19,7 @@ StorableTimeslice::StorableTimeslice(const Timeslice& ts)
     : data_(ts.timeslice_descriptor_.num_components),
       desc_(ts.timeslice_descriptor_.num_components) {
   timeslice_descriptor_ = ts.timeslice_descriptor_;
+  missing_ = ts.missing_;
   for (std::size_t component = 0;
        component < ts.timeslice_descriptor_.num_components; ++component) {
     uint64_t size = ts.desc_ptr_[component]->size;
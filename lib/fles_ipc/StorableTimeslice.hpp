@@ -12,6 +12,7 @@
 
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 // Note: <fstream> has to precede boost/serialization includes for non-obvious
 // reasons to avoid segfault similar to
 // http://lists.debian.org/debian-hppa/2009/11/msg00069.html
@@ -124,10 +125,13 @@ private:
   StorableTimeslice();
 
   template <class Archive>
-  void serialize(Archive& ar, const unsigned int /* version */) {
+  void serialize(Archive& ar, const unsigned int version) {
     ar& timeslice_descriptor_;
     ar& data_;
     ar& desc_;
+    if (version > 0) {
+      ar& missing_;
+    }
 
     init_pointers();
   }
@@ -146,3 +150,8 @@ private:
 };
 
 } // namespace fles
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+BOOST_CLASS_VERSION(fles::StorableTimeslice, 1)
+#pragma GCC diagnostic pop
@@ -40,6 +40,13 @@ public:
     return desc_ptr_[component]->num_microslices;
   }
 
+  /// Check if a component is missing from a partial timeslice.
+  /** A missing component contains no microslices. A component without
+     microslices is not necessarily missing, though. */
+  bool component_missing(uint64_t component) const {
+    return component < missing_.size() && missing_[component];
+  }
+
   /// Retrieve the number of components (contributing input channels).
   uint64_t num_components() const {
     return timeslice_descriptor_.num_components;
@@ -94,6 +101,10 @@ protected:
   /// \brief A vector of pointers to the microslice descriptors, one per
   /// timeslice component.
   std::vector<TimesliceComponentDescriptor*> desc_ptr_;
+
+  /// Flags, true for the components missing from a partial timeslice
+  /// (empty if no component is missing).
+  std::vector<bool> missing_;
 };
 
 } // namespace fles
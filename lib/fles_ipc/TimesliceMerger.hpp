@@ -0,0 +1,309 @@
+/// \file
+/// \brief Defines the fles::TimesliceMerger class template and related
+/// message decoders.
+#pragma once
+
+#include "MicrosliceDescriptor.hpp"
+#include "Timeslice.hpp"
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace fles {
+
+/// A single message of a time-ordered merged timeslice stream.
+struct MergedMessage {
+  uint64_t time;        ///< Timestamp as extracted by the decoder
+  uint32_t component;   ///< Timeslice component the message belongs to
+  const uint8_t* data;  ///< Pointer to the message in the timeslice
+  std::size_t size;     ///< Message size (bytes)
+};
+
+/**
+ * \brief Decoder treating every microslice as a single message.
+ *
+ * The message timestamp is the microslice index (start time). This is the
+ * simplest decoder and allows merging microslices of all components into
+ * one time-ordered stream.
+ *
+ * A decoder must provide the two member functions start_microslice() and
+ * next() as shown here. A separate copy of the decoder is used for each
+ * component, so decoders may keep state across microslices (e.g., epoch
+ * counters). If the decoder timestamps are always within
+ * [desc.idx, next desc.idx) of their microslice, `index_time_base` may be
+ * set to allow skipping of microslices in time range merges.
+ */
+class MicrosliceMessageDecoder {
+public:
+  static constexpr bool index_time_base = true;
+
+  /// Start decoding the given microslice.
+  void start_microslice(const MicrosliceDescriptor& desc,
+                        const uint8_t* content) {
+    desc_ = &desc;
+    content_ = content;
+  }
+
+  /// Decode the next message, return false if the microslice is exhausted.
+  bool next(MergedMessage& m) {
+    if (content_ == nullptr) {
+      return false;
+    }
+    m.time = desc_->idx;
+    m.data = content_;
+    m.size = desc_->size;
+    content_ = nullptr;
+    return true;
+  }
+
+private:
+  const MicrosliceDescriptor* desc_ = nullptr;
+  const uint8_t* content_ = nullptr;
+};
+
+/**
+ * \brief Decoder for microslices containing a sequence of fixed-size
+ * messages.
+ *
+ * The timestamp is extracted from each message by the function object
+ * `TimeFunction`, which is called with a pointer to the message and the
+ * descriptor of the microslice. Trailing incomplete messages are ignored.
+ * Set `IndexTimeBase` if the timestamps are bounded by the microslice index
+ * as described for MicrosliceMessageDecoder.
+ */
+template <std::size_t MessageSize,
+          class TimeFunction,
+          bool IndexTimeBase = false>
+class FixedSizeMessageDecoder {
+public:
+  static constexpr bool index_time_base = IndexTimeBase;
+
+  explicit FixedSizeMessageDecoder(TimeFunction time_function = TimeFunction())
+      : time_function_(time_function) {}
+
+  /// Start decoding the given microslice.
+  void start_microslice(const MicrosliceDescriptor& desc,
+                        const uint8_t* content) {
+    desc_ = &desc;
+    pos_ = content;
+    end_ = content + (desc.size / MessageSize) * MessageSize;
+  }
+
+  /// Decode the next message, return false if the microslice is exhausted.
+  bool next(MergedMessage& m) {
+    if (pos_ == end_) {
+      return false;
+    }
+    m.time = time_function_(pos_, *desc_);
+    m.data = pos_;
+    m.size = MessageSize;
+    pos_ += MessageSize;
+    return true;
+  }
+
+private:
+  TimeFunction time_function_;
+  const MicrosliceDescriptor* desc_ = nullptr;
+  const uint8_t* pos_ = nullptr;
+  const uint8_t* end_ = nullptr;
+};
+
+/**
+ * \brief The TimesliceMerger class provides a single time-ordered message
+ * stream across all components of a timeslice.
+ *
+ * The messages of each component are obtained using a per-component copy of
+ * the `Decoder` (see MicrosliceMessageDecoder for the interface) and are
+ * assumed to be time-ordered within their component. They are merged using
+ * a loser tree, requiring about log2(number of components) comparisons per
+ * message. Messages with equal timestamps are returned in component order.
+ *
+ * Optionally, the output can be restricted to a time range
+ * [begin_time, end_time). This is the basis of merge_parallel().
+ */
+template <class Decoder> class TimesliceMerger {
+public:
+  /// Construct merger for all messages of the timeslice.
+  explicit TimesliceMerger(const Timeslice& ts,
+                           const Decoder& decoder = Decoder())
+      : TimesliceMerger(ts, 0, std::numeric_limits<uint64_t>::max(),
+                        decoder) {}
+
+  /// Construct merger for the messages in the given time range.
+  TimesliceMerger(const Timeslice& ts,
+                  uint64_t begin_time,
+                  uint64_t end_time,
+                  const Decoder& decoder = Decoder())
+      : ts_(ts), end_time_(end_time),
+        k_(static_cast<std::size_t>(ts.num_components())),
+        cursors_(k_, Cursor(decoder)), tree_(k_ > 0 ? k_ : 1, 0) {
+    for (std::size_t c = 0; c < k_; ++c) {
+      Cursor& cur = cursors_[c];
+      cur.message.component = static_cast<uint32_t>(c);
+      cur.num_microslices = ts_.num_microslices(c);
+      if (Decoder::index_time_base) {
+        skip_microslices(c, begin_time);
+      }
+      advance(c);
+      while (cur.valid && cur.message.time < begin_time) {
+        advance(c);
+      }
+    }
+    if (k_ > 0) {
+      tree_[0] = build(1);
+    }
+  }
+
+  /**
+   * \brief Retrieve the next message in time order.
+   *
+   * Returns false if all messages (in the time range) have been retrieved.
+   */
+  bool next(MergedMessage& m) {
+    if (k_ == 0) {
+      return false;
+    }
+    std::size_t winner = tree_[0];
+    Cursor& cur = cursors_[winner];
+    if (!cur.valid || cur.message.time >= end_time_) {
+      return false;
+    }
+    m = cur.message;
+    advance(winner);
+    replay(winner);
+    return true;
+  }
+
+  /// Call `f` for each remaining message in time order.
+  template <class Function> void for_each(Function f) {
+    MergedMessage m;
+    while (next(m)) {
+      f(m);
+    }
+  }
+
+private:
+  struct Cursor {
+    explicit Cursor(const Decoder& d) : decoder(d) {}
+
+    Decoder decoder;
+    MergedMessage message{};
+    uint64_t microslice = 0;
+    uint64_t num_microslices = 0;
+    bool started = false;
+    bool valid = false;
+  };
+
+  /// Skip microslices that end before the given time.
+  void skip_microslices(std::size_t c, uint64_t time) {
+    Cursor& cur = cursors_[c];
+    while (cur.microslice + 1 < cur.num_microslices &&
+           ts_.descriptor(c, cur.microslice + 1).idx <= time) {
+      ++cur.microslice;
+    }
+  }
+
+  /// Advance the cursor of component `c` to its next message.
+  void advance(std::size_t c) {
+    Cursor& cur = cursors_[c];
+    for (;;) {
+      if (cur.started && cur.decoder.next(cur.message)) {
+        cur.valid = true;
+        return;
+      }
+      if (cur.started) {
+        ++cur.microslice;
+      }
+      if (cur.microslice >= cur.num_microslices) {
+        cur.valid = false;
+        return;
+      }
+      cur.decoder.start_microslice(ts_.descriptor(c, cur.microslice),
+                                   ts_.content(c, cur.microslice));
+      cur.started = true;
+    }
+  }
+
+  /// Strict ordering of cursors: valid before exhausted, then by time, then
+  /// by component.
+  bool less(std::size_t a, std::size_t b) const {
+    const Cursor& ca = cursors_[a];
+    const Cursor& cb = cursors_[b];
+    if (ca.valid != cb.valid) {
+      return ca.valid;
+    }
+    if (ca.message.time != cb.message.time) {
+      return ca.message.time < cb.message.time;
+    }
+    return a < b;
+  }
+
+  /// Initialize the subtree at `node`, return its winner.
+  std::size_t build(std::size_t node) {
+    if (node >= k_) {
+      return node - k_; // leaf
+    }
+    std::size_t left = build(2 * node);
+    std::size_t right = build(2 * node + 1);
+    if (less(left, right)) {
+      tree_[node] = right;
+      return left;
+    }
+    tree_[node] = left;
+    return right;
+  }
+
+  /// Replay the matches on the path from leaf `c` to the root.
+  void replay(std::size_t c) {
+    std::size_t winner = c;
+    for (std::size_t node = (c + k_) / 2; node > 0; node /= 2) {
+      if (less(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+  const Timeslice& ts_;
+  uint64_t end_time_;
+  std::size_t k_;
+  std::vector<Cursor> cursors_;
+  /// Loser tree: tree_[0] is the overall winner, tree_[1..k-1] the losers
+  std::vector<std::size_t> tree_;
+};
+
+/**
+ * \brief Merge all components of a timeslice in parallel.
+ *
+ * The time axis is split at the given (ascending) `split_times` into
+ * `split_times.size() + 1` ranges, each merged by a separate thread. The
+ * function object `f` is called as `f(range, message)` for each message,
+ * with messages of each range in time order. Calls for different ranges
+ * happen concurrently.
+ *
+ * Decoders with `index_time_base` skip microslices before their range
+ * without decoding them, others decode each component from the start.
+ */
+template <class Decoder, class Function>
+void merge_parallel(const Timeslice& ts,
+                    const std::vector<uint64_t>& split_times,
+                    Function f,
+                    const Decoder& decoder = Decoder()) {
+  std::vector<std::thread> threads;
+  std::size_t num_ranges = split_times.size() + 1;
+  for (std::size_t r = 0; r < num_ranges; ++r) {
+    uint64_t begin = (r == 0) ? 0 : split_times[r - 1];
+    uint64_t end = (r + 1 == num_ranges) ? std::numeric_limits<uint64_t>::max()
+                                         : split_times[r];
+    threads.emplace_back([&ts, &decoder, &f, r, begin, end] {
+      TimesliceMerger<Decoder> merger(ts, begin, end, decoder);
+      merger.for_each([&f, r](const MergedMessage& m) { f(r, m); });
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+} // namespace fles
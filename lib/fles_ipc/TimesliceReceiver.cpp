@@ -1,6 +1,7 @@
 // Copyright 2013 Jan de Cuveland <cmail@cuveland.de>
 
 #include "TimesliceReceiver.hpp"
+#include "LatencyTracer.hpp"
 #include <boost/version.hpp>
 
 namespace fles {
@@ -94,6 +95,7 @@ TimesliceView* TimesliceReceiver::do_get() {
     return nullptr;
   }
   assert(recvd_size == sizeof(wi));
+  trace(TraceStage::ConsumerReceived, wi.ts_desc.index);
 
   return new TimesliceView(
       wi, reinterpret_cast<uint8_t*>(data_region_->get_address()),
@@ -1,6 +1,7 @@
 // Copyright 2013 Jan de Cuveland <cmail@cuveland.de>
 
 #include "TimesliceView.hpp"
+#include "LatencyTracer.hpp"
 #include <iostream>
 
 namespace fles {
@@ -22,7 +23,19 @@ TimesliceView::TimesliceView(
       ((UINT64_C(1) << work_item.desc_buffer_size_exp) - 1);
   uint64_t data_offset_mask =
       (UINT64_C(1) << work_item.data_buffer_size_exp) - 1;
+  if (work_item.num_missing_components > 0) {
+    missing_desc_.resize(num_components());
+    missing_.resize(num_components());
+  }
   for (size_t c = 0; c < num_components(); ++c) {
+    if (work_item.component_missing(c)) {
+      // never read the buffer slot, it may still be written late
+      missing_[c] = true;
+      missing_desc_[c] = {timeslice_descriptor_.index, 0, 0, 0};
+      desc_ptr_[c] = &missing_desc_[c];
+      data_ptr_[c] = data + (c << work_item.data_buffer_size_exp);
+      continue;
+    }
     desc_ptr_[c] =
         desc + (c << work_item.desc_buffer_size_exp) + descriptor_offset;
     data_ptr_[c] = data + (c << work_item.data_buffer_size_exp) +
@@ -31,6 +44,9 @@ TimesliceView::TimesliceView(
 
   // consistency check
   for (size_t c = 1; c < num_components(); ++c) {
+    if (work_item.component_missing(c)) {
+      continue;
+    }
     if (timeslice_descriptor_.index != desc_ptr_[c]->ts_num) {
       std::cerr << "error: index=" << timeslice_descriptor_.index << ", ts_num["
                 << c << "]=" << desc_ptr_[c]->ts_num << std::endl;
@@ -39,6 +55,7 @@ TimesliceView::TimesliceView(
 }
 
 TimesliceView::~TimesliceView() {
+  trace(TraceStage::Completed, timeslice_descriptor_.index);
   try {
     completions_mq_->send(&completion_, sizeof(completion_), 0);
   } catch (boost::interprocess::interprocess_exception& e) {
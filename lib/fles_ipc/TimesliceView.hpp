@@ -9,6 +9,7 @@
 #include <boost/interprocess/ipc/message_queue.hpp>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace fles {
 
@@ -37,6 +38,9 @@ private:
 
   TimesliceCompletion completion_ = TimesliceCompletion();
 
+  /// Empty descriptors of the components missing from a partial timeslice.
+  std::vector<TimesliceComponentDescriptor> missing_desc_;
+
   std::shared_ptr<boost::interprocess::message_queue> completions_mq_;
 };
 
@@ -5,10 +5,15 @@
 
 #include "TimesliceDescriptor.hpp"
 #include <boost/serialization/access.hpp>
+#include <cassert>
 #include <cstdint>
 
 namespace fles {
 
+/// Maximum number of components that can be flagged as missing in a
+/// TimesliceWorkItem.
+constexpr uint32_t max_flagged_components = 256;
+
 #pragma pack(1)
 
 /**
@@ -21,6 +26,27 @@ struct TimesliceWorkItem {
   uint32_t data_buffer_size_exp;
   /// Size exponential (in bytes) of each descriptor buffer
   uint32_t desc_buffer_size_exp;
+  /// Number of components missing from a partial timeslice
+  uint32_t num_missing_components;
+  /// Bit mask of the components missing from a partial timeslice
+  uint64_t missing_components[max_flagged_components / 64];
+
+  /// Check if a given component is missing from the timeslice.
+  bool component_missing(uint64_t component) const {
+    if (num_missing_components == 0 || component >= max_flagged_components) {
+      return false;
+    }
+    return ((missing_components[component / 64] >> (component % 64)) & 1) != 0;
+  }
+
+  /// Flag a given component as missing from the timeslice.
+  void set_component_missing(uint64_t component) {
+    assert(component < max_flagged_components);
+    if (!component_missing(component)) {
+      missing_components[component / 64] |= UINT64_C(1) << (component % 64);
+      ++num_missing_components;
+    }
+  }
 
   friend class boost::serialization::access;
   /// Provide boost serialization access.
@@ -29,6 +55,8 @@ struct TimesliceWorkItem {
     ar& ts_desc;
     ar& data_buffer_size_exp;
     ar& desc_buffer_size_exp;
+    ar& num_missing_components;
+    ar& missing_components;
   }
 };
 
@@ -5,8 +5,12 @@
 #include "ComputeNodeInfo.hpp"
 #include "LibfabricException.hpp"
 #include "Provider.hpp"
+#include "RemoteCompletionData.hpp"
 #include "RequestIdentifier.hpp"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstring>
 #include <log.hpp>
 #include <rdma/fi_cm.h>
 
@@ -20,17 +24,28 @@ ComputeNodeConnection::ComputeNodeConnection(
     uint8_t* data_ptr,
     uint32_t data_buffer_size_exp,
     fles::TimesliceComponentDescriptor* desc_ptr,
-    uint32_t desc_buffer_size_exp)
+    uint32_t desc_buffer_size_exp,
+    bool rma_sync,
+    bool remote_cq_data)
     : Connection(eq, connection_index, remote_connection_index),
       remote_info_(std::move(remote_info)), data_ptr_(data_ptr),
       data_buffer_size_exp_(data_buffer_size_exp), desc_ptr_(desc_ptr),
-      desc_buffer_size_exp_(desc_buffer_size_exp) {
+      desc_buffer_size_exp_(desc_buffer_size_exp), rma_sync_(rma_sync),
+      remote_cq_data_(remote_cq_data) {
   // send and receive only single StatusMessage struct
   max_send_wr_ = 2; // one additional wr to avoid race (recv before
   // send completion)
   max_send_sge_ = 1;
   max_recv_wr_ = 1;
   max_recv_sge_ = 1;
+  if (rma_sync_) {
+    // one additional wr for acknowledged pointer updates
+    ++max_send_wr_;
+    max_inline_data_ = sizeof(ComputeNodeBufferPosition);
+  }
+  if (remote_cq_data_) {
+    max_recv_wr_ = remote_cq_data_recv_depth;
+  }
 
   if (Provider::getInst()->is_connection_oriented()) {
     connection_oriented_ = true;
@@ -49,10 +64,13 @@ ComputeNodeConnection::ComputeNodeConnection(
     /*InputNodeInfo remote_info, */ uint8_t* data_ptr,
     uint32_t data_buffer_size_exp,
     fles::TimesliceComponentDescriptor* desc_ptr,
-    uint32_t desc_buffer_size_exp)
+    uint32_t desc_buffer_size_exp,
+    bool rma_sync,
+    bool remote_cq_data)
     : Connection(eq, connection_index, remote_connection_index),
       data_ptr_(data_ptr), data_buffer_size_exp_(data_buffer_size_exp),
-      desc_ptr_(desc_ptr), desc_buffer_size_exp_(desc_buffer_size_exp) {
+      desc_ptr_(desc_ptr), desc_buffer_size_exp_(desc_buffer_size_exp),
+      rma_sync_(rma_sync), remote_cq_data_(remote_cq_data) {
 
   // send and receive only single StatusMessage struct
   max_send_wr_ = 2; // one additional wr to avoid race (recv before
@@ -60,6 +78,14 @@ ComputeNodeConnection::ComputeNodeConnection(
   max_send_sge_ = 1;
   max_recv_wr_ = 1;
   max_recv_sge_ = 1;
+  if (rma_sync_) {
+    // one additional wr for acknowledged pointer updates
+    ++max_send_wr_;
+    max_inline_data_ = sizeof(ComputeNodeBufferPosition);
+  }
+  if (remote_cq_data_) {
+    max_recv_wr_ = remote_cq_data_recv_depth;
+  }
 
   if (Provider::getInst()->is_connection_oriented()) {
     connection_oriented_ = true;
@@ -152,6 +178,20 @@ void ComputeNodeConnection::setup_mr(struct fid_domain* pd) {
   send_status_message_.info.data_buffer_size_exp = data_buffer_size_exp_;
   send_status_message_.info.desc_buffer_size_exp = desc_buffer_size_exp_;
   send_status_message_.connect = false;
+
+  if (rma_sync_) {
+    res = fi_mr_reg(pd, const_cast<uint64_t*>(cn_wp_slot_),
+                    sizeof(cn_wp_slot_), FI_REMOTE_WRITE, 0,
+                    Provider::requested_key++, 0, &mr_wp_slot_, nullptr);
+    if (res) {
+      L_(fatal) << "fi_mr_reg failed for wp slot: " << res << "="
+                << fi_strerror(-res);
+      throw LibfabricException("fi_mr_reg failed for wp slot");
+    }
+    send_status_message_.info.wp.addr =
+        reinterpret_cast<uintptr_t>(cn_wp_slot_);
+    send_status_message_.info.wp.rkey = fi_mr_key(mr_wp_slot_);
+  }
 }
 
 void ComputeNodeConnection::setup() {
@@ -182,8 +222,12 @@ void ComputeNodeConnection::setup() {
   send_wr.context = (void*)(ID_SEND_STATUS | (index_ << 8));
 #pragma GCC diagnostic pop
 
-  // post initial receive request
-  post_recv_status_message();
+  // post initial receive requests (all but one are consumed by remote CQ
+  // data on some providers)
+  uint32_t num_recv = remote_cq_data_ ? remote_cq_data_recv_depth : 1;
+  for (uint32_t i = 0; i < num_recv; ++i) {
+    post_recv_status_message();
+  }
 }
 
 void ComputeNodeConnection::on_established(struct fi_eq_cm_entry* event) {
@@ -219,18 +263,109 @@ void ComputeNodeConnection::on_disconnected(struct fi_eq_cm_entry* event) {
     fi_close((struct fid*)mr_data_);
     mr_data_ = nullptr;
   }
+
+  if (mr_wp_slot_) {
+    fi_close((struct fid*)mr_wp_slot_);
+    mr_wp_slot_ = nullptr;
+  }
 #pragma GCC diagnostic pop
 
   Connection::on_disconnected(event);
 }
 
 void ComputeNodeConnection::inc_ack_pointers(uint64_t ack_pos) {
+  // a component of an abandoned timeslice is released only after it has
+  // been written, so that the data position is taken from a valid slot
+  ack_pos = std::min(ack_pos, cn_wp_.desc);
+  if (ack_pos <= cn_ack_.desc) {
+    return;
+  }
   cn_ack_.desc = ack_pos;
 
   const fles::TimesliceComponentDescriptor& acked_ts =
       desc_ptr_[(ack_pos - 1) & ((UINT64_C(1) << desc_buffer_size_exp_) - 1)];
 
   cn_ack_.data = acked_ts.offset + acked_ts.size;
+
+  if (rma_sync_) {
+    try_write_ack_pointers();
+  }
+}
+
+bool ComputeNodeConnection::poll_write_pointers() {
+  uint64_t desc = cn_wp_slot_[1];
+  if (desc == cn_wp_.desc) {
+    return false;
+  }
+  // the descriptors must not be read before the pointer
+  std::atomic_thread_fence(std::memory_order_acquire);
+  cn_wp_.desc = desc;
+  cn_wp_.data = cn_wp_slot_[0];
+  return true;
+}
+
+void ComputeNodeConnection::on_remote_write(uint64_t data,
+                                            bool recv_consumed) {
+  if (recv_consumed) {
+    post_recv_status_message();
+  }
+
+  // descriptor writes of a connection complete in order
+  const fles::TimesliceComponentDescriptor& tscdesc =
+      desc_ptr_[cn_wp_.desc & ((UINT64_C(1) << desc_buffer_size_exp_) - 1)];
+  if ((tscdesc.ts_num & 0xFFFF) != remote_cq_data_timeslice(data)) {
+    L_(fatal) << "[c" << remote_index_ << "] "
+              << "[" << index_ << "] "
+              << "unexpected remote CQ data for timeslice " << tscdesc.ts_num;
+    throw LibfabricException("unexpected remote CQ data");
+  }
+  ++cn_wp_.desc;
+  cn_wp_.data = tscdesc.offset + tscdesc.size;
+}
+
+void ComputeNodeConnection::on_complete_position_write() {
+  ack_write_pending_ = false;
+  try_write_ack_pointers();
+}
+
+void ComputeNodeConnection::try_write_ack_pointers() {
+  if (ack_write_pending_ || ack_target_.addr == 0 || cn_ack_ == posted_ack_) {
+    return;
+  }
+  posted_ack_ = cn_ack_;
+
+  struct iovec sge;
+  sge.iov_base = &posted_ack_;
+  sge.iov_len = sizeof(posted_ack_);
+
+  struct fi_rma_iov rma_iov;
+  rma_iov.addr = ack_target_.addr;
+  rma_iov.len = sizeof(posted_ack_);
+  rma_iov.key = ack_target_.rkey;
+
+  struct fi_msg_rma send_wr_ack;
+  memset(&send_wr_ack, 0, sizeof(send_wr_ack));
+  send_wr_ack.msg_iov = &sge;
+  send_wr_ack.desc = nullptr;
+  send_wr_ack.iov_count = 1;
+  send_wr_ack.rma_iov = &rma_iov;
+  send_wr_ack.rma_iov_count = 1;
+  send_wr_ack.addr = partner_addr_;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+  send_wr_ack.context = (void*)(ID_WRITE_POSITIONS | (index_ << 8));
+#pragma GCC diagnostic pop
+
+  ack_write_pending_ = true;
+  post_send_rdma(&send_wr_ack, FI_COMPLETION | FI_INJECT);
+}
+
+void ComputeNodeConnection::request_abort() {
+  send_status_message_.request_abort = true;
+  if (rma_sync_) {
+    // there is no regular status message to carry the request
+    post_send_status_message();
+  }
 }
 
 void ComputeNodeConnection::on_complete_recv() {
@@ -246,9 +381,25 @@ void ComputeNodeConnection::on_complete_recv() {
               << "COMPLETE RECEIVE status message"
               << " (wp.desc=" << recv_status_message_.wp.desc << ")";
   }
-  cn_wp_ = recv_status_message_.wp;
+  if (rma_sync_) {
+    // the initial message announces the ack target and is not answered
+    ack_target_ = recv_status_message_.ack_target;
+    post_recv_status_message();
+    try_write_ack_pointers();
+    return;
+  }
+  if (!remote_cq_data_) {
+    cn_wp_ = recv_status_message_.wp;
+  }
   post_recv_status_message();
   send_status_message_.ack = cn_ack_;
+  send_status_message_.num_assigned = 0;
+  while (!unforwarded_assignments_.empty() &&
+         send_status_message_.num_assigned < max_forwarded_assignments) {
+    send_status_message_.assigned[send_status_message_.num_assigned++] =
+        unforwarded_assignments_.front();
+    unforwarded_assignments_.pop_front();
+  }
   post_send_status_message();
 }
 
@@ -272,6 +423,7 @@ ComputeNodeConnection::get_private_data() {
   cn_info->index = remote_index_;
   cn_info->data_buffer_size_exp = data_buffer_size_exp_;
   cn_info->desc_buffer_size_exp = desc_buffer_size_exp_;
+  cn_info->wp = send_status_message_.info.wp;
 
   return private_data;
 }
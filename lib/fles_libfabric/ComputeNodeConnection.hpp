@@ -10,6 +10,7 @@
 #include "TimesliceComponentDescriptor.hpp"
 #include <boost/format.hpp>
 #include <chrono>
+#include <deque>
 
 #include <sys/uio.h>
 
@@ -29,7 +30,9 @@ public:
                         uint8_t* data_ptr,
                         uint32_t data_buffer_size_exp,
                         fles::TimesliceComponentDescriptor* desc_ptr,
-                        uint32_t desc_buffer_size_exp);
+                        uint32_t desc_buffer_size_exp,
+                        bool rma_sync,
+                        bool remote_cq_data);
 
   ComputeNodeConnection(struct fid_eq* eq,
                         struct fid_domain* pd,
@@ -40,7 +43,9 @@ public:
                         /*InputNodeInfo remote_info, */ uint8_t* data_ptr,
                         uint32_t data_buffer_size_exp,
                         fles::TimesliceComponentDescriptor* desc_ptr,
-                        uint32_t desc_buffer_size_exp);
+                        uint32_t desc_buffer_size_exp,
+                        bool rma_sync,
+                        bool remote_cq_data);
 
   ComputeNodeConnection(const ComputeNodeConnection&) = delete;
   void operator=(const ComputeNodeConnection&) = delete;
@@ -52,7 +57,7 @@ public:
 
   void post_send_final_status_message();
 
-  void request_abort() { send_status_message_.request_abort = true; }
+  void request_abort();
 
   bool abort_flag() { return recv_status_message_.abort; }
 
@@ -68,8 +73,32 @@ public:
 
   virtual void on_disconnected(struct fi_eq_cm_entry* event) override;
 
+  /// Acknowledge the timeslices up to the given position. The position is
+  /// limited to the components already written by the input channel, the
+  /// rest is acknowledged when they arrive (partial timeslices).
   void inc_ack_pointers(uint64_t ack_pos);
 
+  /// Read the CN write pointers written by the input channel (RMA sync).
+  /// Returns true if they have changed.
+  bool poll_write_pointers();
+
+  /// Handle completion of an acknowledged pointer update (RMA sync).
+  void on_complete_position_write();
+
+  /// Handle the arrival of a timeslice component signaled by remote CQ
+  /// data.
+  /**
+   \param data          Remote CQ data of the descriptor write
+   \param recv_consumed Whether the write consumed a posted receive request
+   */
+  void on_remote_write(uint64_t data, bool recv_consumed);
+
+  /// Queue a timeslice assignment to be forwarded to the input channel
+  /// with the next status message (dynamic assignment).
+  void forward_assignment(uint64_t timeslice) {
+    unforwarded_assignments_.push_back(timeslice);
+  }
+
   void on_complete_recv();
 
   void on_complete_send();
@@ -78,6 +107,8 @@ public:
 
   const ComputeNodeBufferPosition& cn_wp() const { return cn_wp_; }
 
+  const ComputeNodeBufferPosition& cn_ack() const { return cn_ack_; }
+
   virtual std::unique_ptr<std::vector<uint8_t>> get_private_data() override;
 
   struct BufferStatus {
@@ -139,6 +170,10 @@ public:
   bool is_connection_finalized();
 
 private:
+  /// Post an RDMA write of the acknowledged pointers to the input channel
+  /// if they have changed (RMA sync).
+  void try_write_ack_pointers();
+
   ComputeNodeStatusMessage send_status_message_ = ComputeNodeStatusMessage();
   ComputeNodeBufferPosition cn_ack_ = ComputeNodeBufferPosition();
 
@@ -175,6 +210,31 @@ private:
 
   uint32_t pending_send_requests_{0};
 
+  /// Timeslice assignments not yet forwarded to the input channel.
+  std::deque<uint64_t> unforwarded_assignments_;
+
+  /// Flag, true if buffer positions are exchanged by RDMA writes instead of
+  /// status messages.
+  const bool rma_sync_;
+
+  /// CN write pointers (data, desc) written by the input channel (RMA sync)
+  volatile uint64_t cn_wp_slot_[2] = {0, 0};
+
+  struct fid_mr* mr_wp_slot_ = nullptr;
+
+  /// Target of the acknowledged pointer updates on the input channel
+  BufferInfo ack_target_ = BufferInfo();
+
+  /// Acknowledged pointers of the last update written to the input channel
+  ComputeNodeBufferPosition posted_ack_ = ComputeNodeBufferPosition();
+
+  /// Flag, true if an acknowledged pointer update is in flight (RMA sync)
+  bool ack_write_pending_ = false;
+
+  /// Flag, true if the CN write pointers are derived from remote CQ data
+  /// instead of being sent by the input channel.
+  const bool remote_cq_data_;
+
   fi_addr_t partner_addr_;
 };
 } // namespace tl_libfabric
@@ -20,6 +20,7 @@ struct ComputeNodeInfo {
   uint32_t index;
   uint32_t data_buffer_size_exp;
   uint32_t desc_buffer_size_exp;
+  BufferInfo wp; ///< Target of the write pointer updates (RMA sync)
 };
 } // namespace tl_libfabric
 #pragma pack()
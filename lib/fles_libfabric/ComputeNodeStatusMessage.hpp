@@ -5,14 +5,23 @@
 
 #include "ComputeNodeBufferPosition.hpp"
 #include "ComputeNodeInfo.hpp"
+#include <cstdint>
 
 #pragma pack(1)
 
 namespace tl_libfabric {
+/// Maximum number of timeslice assignments forwarded in a single status
+/// message.
+constexpr uint32_t max_forwarded_assignments = 32;
+
 /// Structure representing a status update message sent from compute buffer to
 /// input channel.
 struct ComputeNodeStatusMessage {
   ComputeNodeBufferPosition ack;
+  // timeslices assigned to this compute node by the first input channel
+  // (dynamic assignment), in order of arrival
+  uint32_t num_assigned;
+  uint64_t assigned[max_forwarded_assignments];
   bool request_abort;
   bool final;
   //
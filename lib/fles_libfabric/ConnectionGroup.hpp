@@ -18,7 +18,11 @@
 //#include <vector>
 #include <rdma/fi_domain.h>
 #include <set>
+#include <sys/epoll.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 
 namespace tl_libfabric {
@@ -30,19 +34,37 @@ template <typename CONNECTION>
 class ConnectionGroup : public ConnectionGroupWorker {
 public:
   /// The ConnectionGroup default constructor.
-  ConnectionGroup(std::string local_node_name) {
+  /**
+   \param local_node_name Name of the local node
+   \param idle_wait       Block in idle_wait() instead of busy polling
+   \param spin_time_us    Idle time before blocking (in microseconds)
+   */
+  ConnectionGroup(std::string local_node_name,
+                  bool idle_wait = false,
+                  uint32_t spin_time_us = 0)
+      : spin_time_(spin_time_us) {
     Provider::init(local_node_name);
     // std::cout << "ConnectionGroup constructor" << std::endl;
     struct fi_eq_attr eq_attr;
     memset(&eq_attr, 0, sizeof(eq_attr));
     eq_attr.size = 10;
-    eq_attr.wait_obj = FI_WAIT_NONE;
+    eq_attr.wait_obj = idle_wait ? FI_WAIT_FD : FI_WAIT_NONE;
     int res =
         fi_eq_open(Provider::getInst()->get_fabric(), &eq_attr, &eq_, nullptr);
     if (res) {
       L_(fatal) << "fi_eq_open failed: " << res << "=" << fi_strerror(-res);
       throw LibfabricException("fi_eq_open failed");
     }
+    if (idle_wait) {
+      epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+      if (epoll_fd_ < 0) {
+        throw LibfabricException("epoll_create1 failed");
+      }
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+      add_wait_fd((fid_t)eq_);
+#pragma GCC diagnostic pop
+    }
   }
 
   ConnectionGroup(const ConnectionGroup&) = delete;
@@ -61,6 +83,9 @@ public:
 #pragma GCC diagnostic pop
 
     pep_ = nullptr;
+
+    if (epoll_fd_ >= 0)
+      close(epoll_fd_);
   }
 
   void
@@ -107,7 +132,8 @@ public:
           break;
         }
         case ETIMEDOUT: {
-          // on_rejected(&err_event);
+          // connection request timed out, handled like a rejection
+          on_rejected(&err_event);
           break;
         }
         default: {
@@ -124,42 +150,56 @@ public:
 
   /// The Libfabric completion notification handler.
   int poll_completion() {
-    const int ne_max = 10;
-
-    struct fi_cq_entry wc[ne_max];
-    int ne;
-    int ne_total = 0;
+    if (remote_cq_data_) {
+      return poll_completion_entries<struct fi_cq_data_entry>();
+    }
+    return poll_completion_entries<struct fi_cq_entry>();
+  }
 
-    while (ne_total < conn_.size() && (ne = fi_cq_read(cq_, &wc, ne_max))) {
-      if (ne == -FI_EAVAIL) { // error available
-        struct fi_cq_err_entry err;
-        char buffer[256];
-        ne = fi_cq_readerr(cq_, &err, 0);
-        L_(fatal) << fi_strerror(err.err);
-        L_(fatal) << fi_cq_strerror(cq_, err.prov_errno, err.err_data, buffer,
-                                    256);
-        throw LibfabricException("fi_cq_read failed (fi_cq_readerr)");
-      }
-      if ((ne < 0) && (ne != -FI_EAGAIN)) {
-        L_(fatal) << "fi_cq_read failed: " << ne << "=" << fi_strerror(-ne);
-        throw LibfabricException("fi_cq_read failed");
-      }
+  /// Block until a completion or connection manager event is available.
+  /** Only blocks if enabled and no progress has been made for the spin time.
+   The wait ends at the latest when the next scheduled event is due or after
+   max_idle_wait, so that sources without a wait object (e.g., input data,
+   buffer positions written by RDMA) are still polled regularly.
+   \param progress Flag, true if the caller has just made progress
+   */
+  void idle_wait(bool progress) {
+    if (epoll_fd_ < 0) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (progress) {
+      last_progress_ = now;
+      return;
+    }
+    if (now - last_progress_ < spin_time_) {
+      return;
+    }
 
-      if (ne == -FI_EAGAIN)
-        break;
+    auto timeout = std::min(
+        max_idle_wait,
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            scheduler_.next_event_time() - std::chrono::system_clock::now()));
+    if (timeout.count() <= 0) {
+      return;
+    }
 
-      ne_total += ne;
-      for (int i = 0; i < ne; ++i) {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
-        // L_(trace) << "on_completion(wr_id=" <<
-        // (uintptr_t)wc[i].op_context << ")";
-        on_completion((uintptr_t)wc[i].op_context);
+    struct fid* fids[2] = {(fid_t)eq_, (fid_t)cq_};
 #pragma GCC diagnostic pop
-      }
+    int num_fids = (cq_ != nullptr) ? 2 : 1;
+    // events may only be waited for if none are pending
+    if (fi_trywait(Provider::getInst()->get_fabric(), fids, num_fids) !=
+        FI_SUCCESS) {
+      return;
+    }
+    struct epoll_event events[2];
+    int res =
+        epoll_wait(epoll_fd_, events, 2, static_cast<int>(timeout.count()));
+    if (res < 0 && errno != EINTR) {
+      throw LibfabricException("epoll_wait failed");
     }
-
-    return ne_total;
   }
 
   /// Retrieve the InfiniBand completion queue.
@@ -196,6 +236,15 @@ protected:
   /// Handle RDMA_CM_REJECTED event.
   virtual void on_rejected(struct fi_eq_err_entry* /* event */) {}
 
+  /// Completion error handler. Called by the event loop.
+  virtual void on_completion_error(const struct fi_cq_err_entry& err) {
+    char buffer[256];
+    L_(fatal) << fi_strerror(err.err);
+    L_(fatal) << fi_cq_strerror(cq_, err.prov_errno, err.err_data, buffer,
+                                256);
+    throw LibfabricException("fi_cq_read failed (fi_cq_readerr)");
+  }
+
   virtual void on_connected(struct fid_domain* /*pd*/){};
 
   /// Handle RDMA_CM_EVENT_ESTABLISHED event.
@@ -245,8 +294,9 @@ protected:
     memset(&cq_attr, 0, sizeof(cq_attr));
     cq_attr.size = num_cqe_;
     cq_attr.flags = 0;
-    cq_attr.format = FI_CQ_FORMAT_CONTEXT;
-    cq_attr.wait_obj = FI_WAIT_NONE;
+    cq_attr.format =
+        remote_cq_data_ ? FI_CQ_FORMAT_DATA : FI_CQ_FORMAT_CONTEXT;
+    cq_attr.wait_obj = (epoll_fd_ >= 0) ? FI_WAIT_FD : FI_WAIT_NONE;
     cq_attr.signaling_vector = Provider::vector++; // ??
     cq_attr.wait_cond = FI_CQ_COND_NONE;
     cq_attr.wait_set = nullptr;
@@ -255,6 +305,12 @@ protected:
       L_(fatal) << "fi_cq_open failed: " << -res << "=" << fi_strerror(-res);
       throw LibfabricException("fi_cq_open failed");
     }
+    if (epoll_fd_ >= 0) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+      add_wait_fd((fid_t)cq_);
+#pragma GCC diagnostic pop
+    }
 
     if (Provider::getInst()->has_av()) {
       struct fi_av_attr av_attr;
@@ -316,7 +372,41 @@ protected:
 
   bool connection_oriented_ = false;
 
+  /// Flag, true if timeslice component arrivals are signaled by remote CQ
+  /// data (must be set before init_context()).
+  bool remote_cq_data_ = false;
+
 private:
+  /// Add the file descriptor of the wait object of an EQ or CQ to the set
+  /// of file descriptors watched by idle_wait().
+  void add_wait_fd(struct fid* fid) {
+    int fd;
+    int res = fi_control(fid, FI_GETWAIT, &fd);
+    if (res) {
+      L_(fatal) << "fi_control(FI_GETWAIT) failed: " << res << "="
+                << fi_strerror(-res);
+      throw LibfabricException("fi_control(FI_GETWAIT) failed");
+    }
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event)) {
+      throw LibfabricException("epoll_ctl failed");
+    }
+  }
+
+  /// Upper limit of a single blocking wait in idle_wait().
+  const std::chrono::milliseconds max_idle_wait{1};
+
+  /// Idle time before idle_wait() blocks.
+  const std::chrono::microseconds spin_time_;
+
+  /// Time of the last progress reported to idle_wait().
+  std::chrono::steady_clock::time_point last_progress_;
+
+  /// File descriptor set of the EQ and CQ wait objects (-1 if busy polling)
+  int epoll_fd_ = -1;
+
   /// Connection manager event dispatcher. Called by the CM event loop.
   void on_cm_event(uint32_t event_kind,
                    struct fi_eq_cm_entry* event,
@@ -340,6 +430,71 @@ private:
   /// Completion notification event dispatcher. Called by the event loop.
   virtual void on_completion(uint64_t wc) = 0;
 
+  /// Remote CQ data notification handler. Called by the event loop.
+  /**
+   \param wc   Context of the consumed receive request (0 if none)
+   \param data Remote CQ data
+   */
+  virtual void on_remote_cq_data(uint64_t /* wc */, uint64_t /* data */) {
+    throw LibfabricException("unexpected remote CQ data");
+  }
+
+  /// Read and dispatch completion queue entries of the given format.
+  template <typename ENTRY> int poll_completion_entries() {
+    const int ne_max = 10;
+
+    ENTRY wc[ne_max];
+    int ne;
+    int ne_total = 0;
+
+    while (ne_total < conn_.size() && (ne = fi_cq_read(cq_, &wc, ne_max))) {
+      if (ne == -FI_EAVAIL) { // error available
+        struct fi_cq_err_entry err;
+        memset(&err, 0, sizeof(err));
+        ne = fi_cq_readerr(cq_, &err, 0);
+        if (ne > 0) {
+          ne_total += ne;
+          on_completion_error(err);
+        }
+        continue;
+      }
+      if ((ne < 0) && (ne != -FI_EAGAIN)) {
+        L_(fatal) << "fi_cq_read failed: " << ne << "=" << fi_strerror(-ne);
+        throw LibfabricException("fi_cq_read failed");
+      }
+
+      if (ne == -FI_EAGAIN)
+        break;
+
+      ne_total += ne;
+      for (int i = 0; i < ne; ++i) {
+        // L_(trace) << "on_completion(wr_id=" <<
+        // (uintptr_t)wc[i].op_context << ")";
+        dispatch_completion(wc[i]);
+      }
+    }
+
+    return ne_total;
+  }
+
+  void dispatch_completion(const struct fi_cq_entry& wc) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+    on_completion((uintptr_t)wc.op_context);
+#pragma GCC diagnostic pop
+  }
+
+  void dispatch_completion(const struct fi_cq_data_entry& wc) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+    if (wc.flags & FI_REMOTE_CQ_DATA) {
+      on_remote_cq_data((uintptr_t)wc.op_context, wc.data);
+    } else {
+      on_completion((uintptr_t)wc.op_context);
+    }
+#pragma GCC diagnostic pop
+  }
+
   /// Total number of bytes transmitted.
   uint64_t aggregate_bytes_sent_ = 0;
 
@@ -6,8 +6,10 @@
 #include "LibfabricException.hpp"
 #include "MicrosliceDescriptor.hpp"
 #include "Provider.hpp"
+#include "RemoteCompletionData.hpp"
 #include "RequestIdentifier.hpp"
 #include "TimesliceComponentDescriptor.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <log.hpp>
@@ -21,19 +23,33 @@ InputChannelConnection::InputChannelConnection(
     uint_fast16_t connection_index,
     uint_fast16_t remote_connection_index,
     unsigned int max_send_wr,
-    unsigned int max_pending_write_requests)
+    unsigned int max_pending_write_requests,
+    bool rma_sync,
+    bool remote_cq_data)
     : Connection(eq, connection_index, remote_connection_index),
+      rma_sync_(rma_sync), remote_cq_data_(remote_cq_data),
       max_pending_write_requests_(max_pending_write_requests) {
   assert(max_pending_write_requests_ > 0);
 
+  const struct fi_info* info = Provider::getInst()->get_info();
+  const size_t max_iov = max_component_iov;
+  iov_limit_ = std::max(std::min(info->tx_attr->iov_limit, max_iov), size_t(1));
+  rma_iov_limit_ = info->tx_attr->rma_iov_limit;
+
   max_send_wr_ = max_send_wr; // typical hca maximum: 16k
-  max_send_sge_ = 4;          // max. two chunks each for descriptors and data
+  // max. two chunks each for descriptors and data, plus the descriptor
+  max_send_sge_ = static_cast<uint32_t>(iov_limit_);
 
   max_recv_wr_ = 1; // receive only single ComputeNodeStatusMessage struct
   max_recv_sge_ = 1;
 
   max_inline_data_ = sizeof(fles::TimesliceComponentDescriptor);
 
+  tscdesc_ring_.resize(max_pending_write_requests_);
+  for (uint32_t i = max_pending_write_requests_; i > 0; --i) {
+    free_tscdesc_slots_.push_back(i - 1);
+  }
+
   send_status_message_.info.index = remote_index_;
 
   if (Provider::getInst()->is_connection_oriented()) {
@@ -45,6 +61,10 @@ InputChannelConnection::InputChannelConnection(
 
 bool InputChannelConnection::check_for_buffer_space(uint64_t data_size,
                                                     uint64_t desc_size) {
+  if (rma_sync_) {
+    read_ack_slot();
+  }
+
   if (false) {
     L_(trace) << "[" << index_ << "] "
               << "SENDER data space (bytes) required=" << data_size
@@ -79,136 +99,90 @@ void InputChannelConnection::send_data(struct iovec* sge,
                                        uint64_t desc_length,
                                        uint64_t data_length,
                                        uint64_t skip) {
-  int num_sge2 = 0;
-  struct iovec sge2[4];
-  void* desc2[4];
+  assert(num_sge > 0 && num_sge < static_cast<int>(max_component_iov));
 
   uint64_t cn_wp_data = cn_wp_.data;
   cn_wp_data += skip;
 
-  uint64_t cn_data_buffer_mask =
-      (UINT64_C(1) << remote_info_.data_buffer_size_exp) - 1;
+  uint64_t cn_data_buffer_size = UINT64_C(1)
+                                 << remote_info_.data_buffer_size_exp;
+  uint64_t cn_data_buffer_mask = cn_data_buffer_size - 1;
   uint64_t cn_desc_buffer_mask =
       (UINT64_C(1) << remote_info_.desc_buffer_size_exp) - 1;
-  uint64_t target_bytes_left =
-      (UINT64_C(1) << remote_info_.data_buffer_size_exp) -
-      (cn_wp_data & cn_data_buffer_mask);
-
-  // split sge list if necessary
-  int num_sge_cut = 0;
-  if (data_length + desc_length * sizeof(fles::MicrosliceDescriptor) >
-      target_bytes_left) {
-    for (int i = 0; i < num_sge; ++i) {
-      if (sge[i].iov_len <= target_bytes_left) {
-        target_bytes_left -= sge[i].iov_len;
-      } else {
-        if (target_bytes_left) {
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-          sge2[num_sge2].iov_base =
-              (uint8_t*)sge[i].iov_base + target_bytes_left;
-#pragma GCC diagnostic pop
-          sge2[num_sge2].iov_len = sge[i].iov_len - target_bytes_left;
-          desc2[num_sge2++] = desc[i];
-          sge[i].iov_len = target_bytes_left;
-          target_bytes_left = 0;
-        } else {
-          sge2[num_sge2] = sge[i];
-          desc2[num_sge2++] = desc[i];
-          ++num_sge_cut;
-        }
-      }
-    }
+  uint64_t total_length =
+      data_length + desc_length * sizeof(fles::MicrosliceDescriptor);
+
+  // target regions: data up to the end of the buffer, wrapped data (if
+  // any), and the timeslice component descriptor
+  struct fi_rma_iov rma_iov[3];
+  size_t num_data_rma_iov = 0;
+  uint64_t target_offset = cn_wp_data & cn_data_buffer_mask;
+  uint64_t first_length =
+      std::min(total_length, cn_data_buffer_size - target_offset);
+  rma_iov[num_data_rma_iov++] = {remote_info_.data.addr + target_offset,
+                                 first_length, remote_info_.data.rkey};
+  if (first_length < total_length) {
+    rma_iov[num_data_rma_iov++] = {remote_info_.data.addr,
+                                   total_length - first_length,
+                                   remote_info_.data.rkey};
   }
-  num_sge -= num_sge_cut;
-
-  struct fi_msg_rma send_wr_ts;
-  struct fi_msg_rma send_wr_tswrap;
-  struct fi_msg_rma send_wr_tscdesc;
-  struct fi_rma_iov rma_iov[1];
-
-  uint64_t remote_addr =
-      remote_info_.data.addr + (cn_wp_data & cn_data_buffer_mask);
-  for (int i = 0; i < num_sge; i++) {
-
-    memset(rma_iov, 0, sizeof(rma_iov));
-    rma_iov[0].addr = remote_addr;
-    rma_iov[0].len = sge[i].iov_len;
-    rma_iov[0].key = remote_info_.data.rkey;
-
-    remote_addr += sge[i].iov_len;
-
-    memset(&send_wr_ts, 0, sizeof(send_wr_ts));
-    send_wr_ts.msg_iov = &sge[i];
-    send_wr_ts.desc = &desc[i];
-    send_wr_ts.iov_count = 1;
-    // addr
-    send_wr_ts.rma_iov = rma_iov;
-    send_wr_ts.rma_iov_count = 1;
-    send_wr_ts.addr = partner_addr_;
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-    send_wr_ts.context = (void*)ID_WRITE_DATA;
-#pragma GCC diagnostic pop
-    post_send_rdma(&send_wr_ts, FI_MORE);
-  }
-
-  if (num_sge2) {
-    uint64_t remote_addr = remote_info_.data.addr;
-    for (int i = 0; i < num_sge2; i++) {
-
-      rma_iov[0].addr = remote_addr;
-      rma_iov[0].len = sge2[i].iov_len;
-      rma_iov[0].key = remote_info_.data.rkey;
-
-      remote_addr += +sge2[i].iov_len;
-
-      memset(&send_wr_tswrap, 0, sizeof(send_wr_tswrap));
-      send_wr_tswrap.msg_iov = &sge2[i];
-      send_wr_tswrap.desc = &desc2[i];
-      send_wr_tswrap.iov_count = 1;
-      // addr
-      send_wr_tswrap.rma_iov = rma_iov;
-      send_wr_tswrap.rma_iov_count = 1;
-      send_wr_tswrap.addr = partner_addr_;
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-      send_wr_tswrap.context = (void*)ID_WRITE_DATA_WRAP;
-#pragma GCC diagnostic pop
-      post_send_rdma(&send_wr_tswrap, FI_MORE);
-    }
-  }
-
-  // timeslice component descriptor
-  fles::TimesliceComponentDescriptor tscdesc;
+  rma_iov[num_data_rma_iov] = {
+      remote_info_.desc.addr + (cn_wp_.desc & cn_desc_buffer_mask) *
+                                   sizeof(fles::TimesliceComponentDescriptor),
+      sizeof(fles::TimesliceComponentDescriptor), remote_info_.desc.rkey};
+
+  // timeslice component descriptor, kept until the write has completed
+  assert(!free_tscdesc_slots_.empty());
+  uint32_t slot = free_tscdesc_slots_.back();
+  free_tscdesc_slots_.pop_back();
+  fles::TimesliceComponentDescriptor& tscdesc = tscdesc_ring_[slot];
   tscdesc.ts_num = timeslice;
   tscdesc.offset = cn_wp_data;
-  tscdesc.size = data_length + desc_length * sizeof(fles::MicrosliceDescriptor);
+  tscdesc.size = total_length;
   tscdesc.num_microslices = desc_length;
-  struct iovec sge3;
-  sge3.iov_base = &tscdesc;
-  sge3.iov_len = sizeof(tscdesc);
-  // sge3.lkey = 0;
 
-  rma_iov[0].addr =
-      remote_info_.desc.addr + (cn_wp_.desc & cn_desc_buffer_mask) *
-                                   sizeof(fles::TimesliceComponentDescriptor);
-  rma_iov[0].len = sizeof(tscdesc);
-  rma_iov[0].key = remote_info_.desc.rkey;
+  struct iovec iov[max_component_iov];
+  void* iov_desc[max_component_iov];
 
+  struct fi_msg_rma send_wr_tscdesc;
   memset(&send_wr_tscdesc, 0, sizeof(send_wr_tscdesc));
-  send_wr_tscdesc.msg_iov = &sge3;
-  send_wr_tscdesc.desc = NULL;
-  send_wr_tscdesc.iov_count = 1;
-  // addr
-  send_wr_tscdesc.rma_iov = rma_iov;
-  send_wr_tscdesc.rma_iov_count = 1;
   send_wr_tscdesc.addr = partner_addr_;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
   send_wr_tscdesc.context =
-      (void*)(ID_WRITE_DESC | (timeslice << 24) | (index_ << 8));
+      (void*)request_context(ID_WRITE_DESC, index_, slot);
 #pragma GCC diagnostic pop
+  uint64_t flags = FI_COMPLETION;
+  if (remote_cq_data_) {
+    send_wr_tscdesc.data = make_remote_cq_data(remote_index_, timeslice);
+    flags |= FI_REMOTE_CQ_DATA;
+  }
+
+  size_t num_iov = static_cast<size_t>(num_sge);
+  if (num_iov + 1 <= iov_limit_ && num_data_rma_iov + 1 <= rma_iov_limit_) {
+    // data and descriptor in a single operation
+    std::copy(sge, sge + num_sge, iov);
+    std::copy(desc, desc + num_sge, iov_desc);
+    iov[num_iov].iov_base = &tscdesc;
+    iov[num_iov].iov_len = sizeof(tscdesc);
+    iov_desc[num_iov] = fi_mr_desc(mr_tscdesc_);
+    send_wr_tscdesc.msg_iov = iov;
+    send_wr_tscdesc.desc = iov_desc;
+    send_wr_tscdesc.iov_count = num_iov + 1;
+    send_wr_tscdesc.rma_iov = rma_iov;
+    send_wr_tscdesc.rma_iov_count = num_data_rma_iov + 1;
+  } else {
+    post_data_writes(sge, desc, num_sge, rma_iov, num_data_rma_iov);
+    // fence: the descriptor must not become visible before the data
+    flags |= FI_FENCE | FI_INJECT;
+    iov[0].iov_base = &tscdesc;
+    iov[0].iov_len = sizeof(tscdesc);
+    send_wr_tscdesc.msg_iov = iov;
+    send_wr_tscdesc.desc = nullptr;
+    send_wr_tscdesc.iov_count = 1;
+    send_wr_tscdesc.rma_iov = &rma_iov[num_data_rma_iov];
+    send_wr_tscdesc.rma_iov_count = 1;
+  }
 
   if (false) {
     L_(info) << "[i" << remote_index_ << "] "
@@ -219,7 +193,74 @@ void InputChannelConnection::send_data(struct iovec* sge,
   // send everything
   assert(pending_write_requests_ < max_pending_write_requests_);
   ++pending_write_requests_;
-  post_send_rdma(&send_wr_tscdesc, FI_FENCE | FI_COMPLETION | FI_INJECT);
+  post_send_rdma(&send_wr_tscdesc, flags);
+}
+
+void InputChannelConnection::post_data_writes(const struct iovec* sge,
+                                              void** desc,
+                                              int num_sge,
+                                              const struct fi_rma_iov* rma_iov,
+                                              size_t num_rma_iov) {
+  struct iovec iov[max_component_iov];
+  void* iov_desc[max_component_iov];
+
+  // split the source elements at target region boundaries and gather up
+  // to iov_limit_ of them into each write
+  int i = 0;
+  uint64_t sge_done = 0;
+  for (size_t r = 0; r < num_rma_iov; ++r) {
+    uint64_t remote_addr = rma_iov[r].addr;
+    uint64_t region_left = rma_iov[r].len;
+    while (region_left > 0) {
+      size_t count = 0;
+      uint64_t length = 0;
+      while (count < iov_limit_ && region_left > 0) {
+        assert(i < num_sge);
+        uint64_t len = std::min(sge[i].iov_len - sge_done, region_left);
+        iov[count].iov_base = static_cast<uint8_t*>(sge[i].iov_base) + sge_done;
+        iov[count].iov_len = len;
+        iov_desc[count++] = desc[i];
+        length += len;
+        region_left -= len;
+        sge_done += len;
+        if (sge_done == sge[i].iov_len) {
+          ++i;
+          sge_done = 0;
+        }
+      }
+
+      struct fi_rma_iov target = {remote_addr, length, rma_iov[r].key};
+      remote_addr += length;
+
+      struct fi_msg_rma send_wr_ts;
+      memset(&send_wr_ts, 0, sizeof(send_wr_ts));
+      send_wr_ts.msg_iov = iov;
+      send_wr_ts.desc = iov_desc;
+      send_wr_ts.iov_count = count;
+      send_wr_ts.rma_iov = &target;
+      send_wr_ts.rma_iov_count = 1;
+      send_wr_ts.addr = partner_addr_;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+      // failed writes are reported even without FI_COMPLETION, so the
+      // connection must be identifiable
+      send_wr_ts.context = (void*)request_context(
+          r == 0 ? ID_WRITE_DATA : ID_WRITE_DATA_WRAP, index_);
+#pragma GCC diagnostic pop
+      post_send_rdma(&send_wr_ts, FI_MORE);
+    }
+  }
+}
+
+unsigned int InputChannelConnection::max_writes_per_component() {
+  const size_t max_iov = max_component_iov;
+  size_t iov_limit = std::max(
+      std::min(Provider::getInst()->get_info()->tx_attr->iov_limit, max_iov),
+      size_t(1));
+  // up to max_iov - 1 source elements, one of which may be split at the
+  // buffer wrap, gathered into writes to at most two target regions
+  size_t data_writes = std::min(max_iov, (max_iov - 1) / iov_limit + 2);
+  return static_cast<unsigned int>(data_writes + 1);
 }
 
 bool InputChannelConnection::write_request_available() {
@@ -234,13 +275,77 @@ void InputChannelConnection::inc_write_pointers(uint64_t data_size,
 
 bool InputChannelConnection::try_sync_buffer_positions() {
   if (our_turn_) {
+    // with RMA sync, this initial message announces the ack target and is
+    // never answered
     our_turn_ = false;
     send_status_message_.wp = cn_wp_;
     post_send_status_message();
     return true;
-  } else {
+  }
+  if (!rma_sync_) {
     return false;
   }
+
+  read_ack_slot();
+  if (finalize_) {
+    try_send_final_status_message();
+  }
+  if (remote_cq_data_ || wp_write_pending_ || cn_wp_ == posted_wp_) {
+    return false;
+  }
+  post_write_buffer_positions();
+  return true;
+}
+
+void InputChannelConnection::on_complete_position_write() {
+  wp_write_pending_ = false;
+  try_sync_buffer_positions();
+}
+
+void InputChannelConnection::post_write_buffer_positions() {
+  posted_wp_ = cn_wp_;
+
+  struct iovec sge;
+  sge.iov_base = &posted_wp_;
+  sge.iov_len = sizeof(posted_wp_);
+
+  struct fi_rma_iov rma_iov;
+  rma_iov.addr = remote_info_.wp.addr;
+  rma_iov.len = sizeof(posted_wp_);
+  rma_iov.key = remote_info_.wp.rkey;
+
+  struct fi_msg_rma send_wr_wp;
+  memset(&send_wr_wp, 0, sizeof(send_wr_wp));
+  send_wr_wp.msg_iov = &sge;
+  send_wr_wp.desc = nullptr;
+  send_wr_wp.iov_count = 1;
+  send_wr_wp.rma_iov = &rma_iov;
+  send_wr_wp.rma_iov_count = 1;
+  send_wr_wp.addr = partner_addr_;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wold-style-cast"
+  send_wr_wp.context = (void*)request_context(ID_WRITE_POSITIONS, index_);
+#pragma GCC diagnostic pop
+
+  wp_write_pending_ = true;
+  // fence: the pointers must not become visible before the data
+  post_send_rdma(&send_wr_wp, FI_FENCE | FI_COMPLETION | FI_INJECT);
+}
+
+void InputChannelConnection::read_ack_slot() {
+  // the compute node may update the slot at any time, but each field only
+  // increases, so a mix of old and new values is still a valid lower bound
+  cn_ack_.data = cn_ack_slot_[0];
+  cn_ack_.desc = cn_ack_slot_[1];
+}
+
+void InputChannelConnection::try_send_final_status_message() {
+  if (send_status_message_.final || (cn_wp_ != cn_ack_ && !abort_)) {
+    return;
+  }
+  send_status_message_.final = true;
+  send_status_message_.abort = abort_;
+  post_send_status_message();
 }
 
 uint64_t InputChannelConnection::skip_required(uint64_t data_size) {
@@ -255,6 +360,11 @@ uint64_t InputChannelConnection::skip_required(uint64_t data_size) {
 void InputChannelConnection::finalize(bool abort) {
   finalize_ = true;
   abort_ = abort;
+  if (rma_sync_) {
+    read_ack_slot();
+    try_send_final_status_message();
+    return;
+  }
   if (our_turn_) {
     our_turn_ = false;
     if (cn_wp_ == cn_ack_ || abort_) {
@@ -267,7 +377,11 @@ void InputChannelConnection::finalize(bool abort) {
   }
 }
 
-void InputChannelConnection::on_complete_write() { pending_write_requests_--; }
+uint64_t InputChannelConnection::on_complete_write(uint64_t tscdesc_slot) {
+  pending_write_requests_--;
+  free_tscdesc_slots_.push_back(static_cast<uint32_t>(tscdesc_slot));
+  return tscdesc_ring_.at(tscdesc_slot).ts_num;
+}
 
 void InputChannelConnection::on_complete_recv() {
   if (recv_status_message_.final) {
@@ -281,7 +395,16 @@ void InputChannelConnection::on_complete_recv() {
               << "receive completion, new cn_ack_.data="
               << recv_status_message_.ack.data;
   }
+  if (rma_sync_) {
+    // only abort requests are sent in this mode, positions are polled
+    post_recv_status_message();
+    return;
+  }
+
   cn_ack_ = recv_status_message_.ack;
+  for (uint32_t i = 0; i < recv_status_message_.num_assigned; ++i) {
+    assignments_.push_back(recv_status_message_.assigned[i]);
+  }
   post_recv_status_message();
 
   if (get_partner_addr() || connection_oriented_) {
@@ -331,6 +454,31 @@ void InputChannelConnection::setup_mr(struct fid_domain* pd) {
   if (!mr_send_)
     throw LibfabricException(
         "registration of memory region failed in InputChannelConnection2");
+
+  err = fi_mr_reg(pd, tscdesc_ring_.data(),
+                  tscdesc_ring_.size() *
+                      sizeof(fles::TimesliceComponentDescriptor),
+                  FI_WRITE, 0, Provider::requested_key++, 0, &mr_tscdesc_,
+                  nullptr);
+  if (err) {
+    L_(fatal) << "fi_mr_reg failed for component descriptors: " << err << "="
+              << fi_strerror(-err);
+    throw LibfabricException("fi_mr_reg failed for component descriptors");
+  }
+
+  if (rma_sync_) {
+    err = fi_mr_reg(pd, const_cast<uint64_t*>(cn_ack_slot_),
+                    sizeof(cn_ack_slot_), FI_REMOTE_WRITE, 0,
+                    Provider::requested_key++, 0, &mr_ack_slot_, nullptr);
+    if (err) {
+      L_(fatal) << "fi_mr_reg failed for ack slot: " << err << "="
+                << fi_strerror(-err);
+      throw LibfabricException("fi_mr_reg failed for ack slot");
+    }
+    send_status_message_.ack_target.addr =
+        reinterpret_cast<uintptr_t>(cn_ack_slot_);
+    send_status_message_.ack_target.rkey = fi_mr_key(mr_ack_slot_);
+  }
 }
 
 void InputChannelConnection::setup() {
@@ -349,7 +497,7 @@ void InputChannelConnection::setup() {
   recv_wr.iov_count = 1;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
-  recv_wr.context = (void*)(ID_RECEIVE_STATUS | (index_ << 8));
+  recv_wr.context = (void*)request_context(ID_RECEIVE_STATUS, index_);
 #pragma GCC diagnostic pop
 
   memset(&send_wr_iovec, 0, sizeof(struct iovec));
@@ -362,7 +510,7 @@ void InputChannelConnection::setup() {
   send_wr.iov_count = 1;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wold-style-cast"
-  send_wr.context = (void*)(ID_SEND_STATUS | (index_ << 8));
+  send_wr.context = (void*)request_context(ID_SEND_STATUS, index_);
 #pragma GCC diagnostic pop
 
   // post initial receive request
@@ -392,6 +540,16 @@ void InputChannelConnection::dereg_mr() {
     fi_close((struct fid*)mr_send_);
     mr_send_ = nullptr;
   }
+
+  if (mr_ack_slot_) {
+    fi_close((struct fid*)mr_ack_slot_);
+    mr_ack_slot_ = nullptr;
+  }
+
+  if (mr_tscdesc_) {
+    fi_close((struct fid*)mr_tscdesc_);
+    mr_tscdesc_ = nullptr;
+  }
 #pragma GCC diagnostic pop
 }
 
@@ -435,6 +593,7 @@ void InputChannelConnection::post_send_status_message() {
               << send_status_message_.wp.data
               << " wp.desc=" << send_status_message_.wp.desc << ")";
   }
+  status_sent_time_ = std::chrono::steady_clock::now();
   post_send_msg(&send_wr);
 }
 
@@ -491,5 +650,7 @@ void InputChannelConnection::set_remote_info() {
       this->recv_status_message_.info.desc_buffer_size_exp;
 
   this->remote_info_.index = this->recv_status_message_.info.index;
+
+  this->remote_info_.wp = this->recv_status_message_.info.wp;
 }
 } // namespace tl_libfabric
@@ -7,8 +7,11 @@
 #include "ComputeNodeStatusMessage.hpp"
 #include "Connection.hpp"
 #include "InputChannelStatusMessage.hpp"
+#include "TimesliceComponentDescriptor.hpp"
 
+#include <chrono>
 #include <sys/uio.h>
+#include <vector>
 
 namespace tl_libfabric {
 /// Input node connection class.
@@ -23,7 +26,9 @@ public:
                          uint_fast16_t connection_index,
                          uint_fast16_t remote_connection_index,
                          unsigned int max_send_wr,
-                         unsigned int max_pending_write_requests);
+                         unsigned int max_pending_write_requests,
+                         bool rma_sync,
+                         bool remote_cq_data);
 
   InputChannelConnection(const InputChannelConnection&) = delete;
   void operator=(const InputChannelConnection&) = delete;
@@ -31,6 +36,10 @@ public:
   /// Wait until enough space is available at target compute node.
   bool check_for_buffer_space(uint64_t data_size, uint64_t desc_size);
 
+  /// Retrieve the maximum number of RDMA writes posted per timeslice
+  /// component (depends on the iov_limit of the provider).
+  static unsigned int max_writes_per_component();
+
   /// Send data and descriptors to compute node.
   void send_data(struct iovec* sge,
                  void** desc,
@@ -50,11 +59,38 @@ public:
 
   bool try_sync_buffer_positions();
 
+  /// Handle completion of a write pointer update (RMA sync).
+  void on_complete_position_write();
+
   void finalize(bool abort);
 
   bool request_abort_flag() { return recv_status_message_.request_abort; }
 
-  void on_complete_write();
+  /// Check if the compute node has not answered the last status message
+  /// within the given time (not applicable with RMA sync).
+  bool status_reply_overdue(std::chrono::steady_clock::time_point now,
+                            std::chrono::milliseconds timeout) const {
+    return !rma_sync_ && !our_turn_ && !done_ &&
+           now - status_sent_time_ > timeout;
+  }
+
+  /// Retrieve the free data buffer space (in bytes) at the compute node.
+  uint64_t free_data_space() const {
+    return cn_ack_.data + (UINT64_C(1) << remote_info_.data_buffer_size_exp) -
+           cn_wp_.data;
+  }
+
+  /// Retrieve and clear the timeslice assignments forwarded by the compute
+  /// node since the last call (dynamic assignment).
+  std::vector<uint64_t> take_assignments() {
+    std::vector<uint64_t> assignments;
+    assignments.swap(assignments_);
+    return assignments;
+  }
+
+  /// Handle the completion of a timeslice component write, releasing its
+  /// descriptor slot. Returns the timeslice index.
+  uint64_t on_complete_write(uint64_t tscdesc_slot);
 
   /// Handle Libfabric receive completion notification.
   void on_complete_recv();
@@ -92,24 +128,73 @@ public:
   void set_remote_info();
 
 private:
+  /// Maximum number of source elements of a timeslice component write
+  /// (two chunks each for descriptors and data, plus the descriptor).
+  static constexpr size_t max_component_iov = 5;
+
+  /// Post RDMA writes of the source elements to the given target regions,
+  /// each write gathering up to iov_limit_ elements.
+  void post_data_writes(const struct iovec* sge,
+                        void** desc,
+                        int num_sge,
+                        const struct fi_rma_iov* rma_iov,
+                        size_t num_rma_iov);
+
   /// Post a receive work request (WR) to the receive queue
   void post_recv_status_message();
 
   /// Post a send work request (WR) to the send queue
   void post_send_status_message();
 
+  /// Post an RDMA write of the CN write pointers to the compute node.
+  void post_write_buffer_positions();
+
+  /// Read the acknowledged-by-CN pointers written by the compute node.
+  void read_ack_slot();
+
+  /// Send the final status message once everything has been acknowledged
+  /// (RMA sync).
+  void try_send_final_status_message();
+
   /// Flag, true if it is the input nodes's turn to send a pointer update.
   bool our_turn_ = true;
 
+  /// Time of the last status message sent to the compute node.
+  std::chrono::steady_clock::time_point status_sent_time_;
+
   bool finalize_ = false;
   bool abort_ = false;
 
+  /// Flag, true if buffer positions are exchanged by RDMA writes instead of
+  /// status messages. Only the initial, abort and final status messages are
+  /// sent in this mode.
+  const bool rma_sync_;
+
+  /// Acknowledged-by-CN pointers (data, desc) written by the CN (RMA sync)
+  volatile uint64_t cn_ack_slot_[2] = {0, 0};
+
+  /// Libfabric memory region descriptor for the acknowledged-by-CN pointers
+  struct fid_mr* mr_ack_slot_ = nullptr;
+
+  /// CN write pointers of the last update written to the CN (RMA sync)
+  ComputeNodeBufferPosition posted_wp_ = ComputeNodeBufferPosition();
+
+  /// Flag, true if a write pointer update is in flight (RMA sync)
+  bool wp_write_pending_ = false;
+
+  /// Flag, true if descriptor writes signal the compute node by remote CQ
+  /// data, which makes write pointer updates unnecessary.
+  const bool remote_cq_data_;
+
   /// Access information for memory regions on remote end.
   ComputeNodeInfo remote_info_ = ComputeNodeInfo();
 
   /// Local copy of acknowledged-by-CN pointers
   ComputeNodeBufferPosition cn_ack_ = ComputeNodeBufferPosition();
 
+  /// Timeslice assignments received from the CN, not yet taken
+  std::vector<uint64_t> assignments_;
+
   /// Receive buffer for CN status (including acknowledged-by-CN pointers)
   ComputeNodeStatusMessage recv_status_message_ = ComputeNodeStatusMessage();
 
@@ -141,6 +226,23 @@ private:
 
   unsigned int max_pending_write_requests_{0};
 
+  /// Maximum number of source elements per RDMA write
+  size_t iov_limit_ = 1;
+
+  /// Maximum number of target regions per RDMA write
+  size_t rma_iov_limit_ = 1;
+
+  /// Source buffers of the timeslice component descriptor writes (one per
+  /// pending write request)
+  std::vector<fles::TimesliceComponentDescriptor> tscdesc_ring_;
+
+  /// Indexes of the tscdesc_ring_ entries not used by a pending write
+  /// (completions may arrive out of order, so slots are freed by index)
+  std::vector<uint32_t> free_tscdesc_slots_;
+
+  /// Libfabric memory region descriptor for the component descriptors
+  struct fid_mr* mr_tscdesc_ = nullptr;
+
   uint_fast16_t remote_connection_index_;
 
   fi_addr_t partner_addr_ = 0;
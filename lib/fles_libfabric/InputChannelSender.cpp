@@ -2,7 +2,9 @@
 // Copyright 2016 Thorsten Schuett <schuett@zib.de>, Farouk Salem <salem@zib.de>
 
 #include "InputChannelSender.hpp"
+#include "LatencyTracer.hpp"
 #include "MicrosliceDescriptor.hpp"
+#include "RemoteCompletionData.hpp"
 #include "RequestIdentifier.hpp"
 #include "Utility.hpp"
 #include <cassert>
@@ -11,6 +13,14 @@
 #include <rdma/fi_domain.h>
 
 namespace tl_libfabric {
+namespace {
+/// Delay before the first retry of a failed connection attempt.
+constexpr std::chrono::milliseconds connect_retry_initial_delay(100);
+
+/// Upper limit of the delay between connection attempts.
+constexpr std::chrono::milliseconds connect_retry_max_delay(5000);
+} // namespace
+
 InputChannelSender::InputChannelSender(
     uint64_t input_index,
     InputBufferReadInterface& data_source,
@@ -19,11 +29,24 @@ InputChannelSender::InputChannelSender(
     uint32_t timeslice_size,
     uint32_t overlap_size,
     uint32_t max_timeslice_number,
+    bool dynamic_assignment,
+    bool rma_sync,
+    bool remote_cq_data,
+    bool idle_wait,
+    uint32_t spin_time_us,
+    uint32_t failure_timeout_ms,
     std::string input_node_name)
-    : ConnectionGroup(input_node_name), input_index_(input_index),
-      data_source_(data_source), compute_hostnames_(compute_hostnames),
+    : ConnectionGroup(input_node_name, idle_wait, spin_time_us),
+      input_index_(input_index), data_source_(data_source),
+      compute_hostnames_(compute_hostnames),
       compute_services_(compute_services), timeslice_size_(timeslice_size),
       overlap_size_(overlap_size), max_timeslice_number_(max_timeslice_number),
+      dynamic_assignment_(dynamic_assignment),
+      assignment_(compute_hostnames.size(),
+                  std::chrono::milliseconds(failure_timeout_ms)),
+      rma_sync_(rma_sync), failure_timeout_(failure_timeout_ms),
+      cn_failed_(compute_hostnames.size(), false),
+      cn_done_(compute_hostnames.size(), false),
       min_acked_desc_(data_source.desc_buffer().size() / 4),
       min_acked_data_(data_source.data_buffer().size() / 4) {
 
@@ -35,12 +58,21 @@ InputChannelSender::InputChannelSender(
   size_t min_ack_buffer_size =
       data_source_.desc_buffer().size() / timeslice_size_ + 1;
   ack_.alloc_with_size(min_ack_buffer_size);
+  sent_to_.alloc_with_size(min_ack_buffer_size);
+
+  fles::LatencyTracer::instance().set_timeslice_geometry(timeslice_size_,
+                                                         overlap_size_);
 
   if (Provider::getInst()->is_connection_oriented()) {
     connection_oriented_ = true;
   } else {
     connection_oriented_ = false;
   }
+  remote_cq_data_ = remote_cq_data;
+  if (remote_cq_data_ &&
+      Provider::getInst()->get_info()->domain_attr->cq_data_size < 4) {
+    throw LibfabricException("provider does not support remote CQ data");
+  }
 }
 
 InputChannelSender::~InputChannelSender() {
@@ -123,13 +155,14 @@ void InputChannelSender::report_status() {
 }
 
 void InputChannelSender::sync_buffer_positions() {
-  for (auto& c : conn_) {
-    c->try_sync_buffer_positions();
+  // later updates are posted on demand: with RMA sync when data has been
+  // written (see try_send_timeslice()), otherwise as soon as the compute
+  // node has answered the previous status message (see on_completion())
+  for (size_t cn = 0; cn < conn_.size(); ++cn) {
+    if (!cn_failed_[cn]) {
+      conn_[cn]->try_sync_buffer_positions();
+    }
   }
-
-  auto now = std::chrono::system_clock::now();
-  scheduler_.add(std::bind(&InputChannelSender::sync_buffer_positions, this),
-                 now + std::chrono::milliseconds(0));
 }
 
 void InputChannelSender::sync_data_source(bool schedule) {
@@ -147,10 +180,16 @@ void InputChannelSender::sync_data_source(bool schedule) {
 }
 
 void InputChannelSender::bootstrap_with_connections() {
+  begin_bootstrap();
+  // initiate all connection requests at once, rejected ones are retried
   connect();
   while (connected_ != compute_hostnames_.size()) {
     poll_cm_events();
+    retry_connections();
+    report_bootstrap_progress(false);
+    idle_wait(false);
   }
+  report_bootstrap_progress(true);
 }
 
 void InputChannelSender::bootstrap_wo_connections() {
@@ -158,7 +197,9 @@ void InputChannelSender::bootstrap_wo_connections() {
   init_context(Provider::getInst()->get_info(), compute_hostnames_,
                compute_services_);
 
+  begin_bootstrap();
   // setup connections objects
+  auto now = ExponentialBackoff::clock::now();
   for (unsigned int i = 0; i < compute_hostnames_.size(); ++i) {
     std::unique_ptr<InputChannelConnection> connection =
         create_input_node_connection(i);
@@ -166,81 +207,197 @@ void InputChannelSender::bootstrap_wo_connections() {
     connection->connect(compute_hostnames_[i], compute_services_[i], pd_, cq_,
                         av_, fi_addrs[i]);
     conn_.push_back(std::move(connection));
+    // retried unless the compute node replies in time
+    connect_backoff_.at(i).failed(now);
   }
-  int i = 0;
   while (connected_ != compute_hostnames_.size()) {
-    poll_completion();
-    i++;
-    if (i == 1000000) {
-      i = 0;
-      // reconnecting
-      for (unsigned int i = 0; i < compute_hostnames_.size(); ++i) {
-        if (connected_indexes_.find(i) == connected_indexes_.end()) {
-          L_(info) << "retrying to connect to " << compute_hostnames_[i] << ":"
-                   << compute_services_[i];
-          conn_.at(i)->reconnect();
-        }
+    bool progress = poll_completion() > 0;
+    retry_connections();
+    report_bootstrap_progress(false);
+    idle_wait(progress);
+  }
+  report_bootstrap_progress(true);
+}
+
+void InputChannelSender::begin_bootstrap() {
+  connect_backoff_.assign(compute_hostnames_.size(),
+                          ExponentialBackoff(connect_retry_initial_delay,
+                                             connect_retry_max_delay));
+  bootstrap_begin_ = std::chrono::steady_clock::now();
+  next_progress_report_ = bootstrap_begin_ + std::chrono::seconds(1);
+}
+
+void InputChannelSender::retry_connections() {
+  auto now = ExponentialBackoff::clock::now();
+  for (unsigned int i = 0; i < compute_hostnames_.size(); ++i) {
+    ExponentialBackoff& backoff = connect_backoff_.at(i);
+    if (connected_indexes_.count(i) || !backoff.due(now)) {
+      continue;
+    }
+    if (connection_oriented_) {
+      // a rejected connection has been removed, others are still pending
+      if (conn_.at(i)) {
+        continue;
       }
+      L_(debug) << "[i" << input_index_ << "] "
+                << "retrying to connect to " << peer_name(i) << " (attempt "
+                << backoff.failures() + 1 << ")";
+      std::unique_ptr<InputChannelConnection> connection =
+          create_input_node_connection(i);
+      connection->connect(compute_hostnames_[i], compute_services_[i], pd_,
+                          cq_, av_, FI_ADDR_UNSPEC);
+      conn_.at(i) = std::move(connection);
+    } else {
+      L_(debug) << "[i" << input_index_ << "] "
+                << "retrying to connect to " << peer_name(i) << " (attempt "
+                << backoff.failures() + 1 << ")";
+      conn_.at(i)->reconnect();
+      backoff.failed(now);
     }
   }
 }
 
-/// The thread main function.
-void InputChannelSender::operator()() {
-  try {
+void InputChannelSender::on_peer_connected(uint_fast16_t cn) {
+  connected_indexes_.insert(cn);
+  L_(debug) << "[i" << input_index_ << "] "
+            << "connected to " << peer_name(cn) << " after "
+            << connect_backoff_.at(cn).failures() + 1 << " attempt(s)";
+}
 
-    if (Provider::getInst()->is_connection_oriented()) {
-      bootstrap_with_connections();
-    } else {
-      bootstrap_wo_connections();
+void InputChannelSender::report_bootstrap_progress(bool complete) {
+  auto now = std::chrono::steady_clock::now();
+  if (complete) {
+    L_(info) << "[i" << input_index_ << "] "
+             << "bootstrap complete: " << connected_ << " connections in "
+             << std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - bootstrap_begin_)
+                    .count()
+             << " ms";
+    return;
+  }
+  if (now < next_progress_report_) {
+    return;
+  }
+  next_progress_report_ = now + std::chrono::seconds(1);
+  L_(info) << "[i" << input_index_ << "] "
+           << "bootstrap: " << connected_ << " of "
+           << compute_hostnames_.size() << " compute nodes connected";
+  for (unsigned int i = 0; i < compute_hostnames_.size(); ++i) {
+    if (!connected_indexes_.count(i)) {
+      L_(debug) << "[i" << input_index_ << "] "
+                << "waiting for " << peer_name(i) << " ("
+                << connect_backoff_.at(i).failures() << " failed attempts)";
     }
+  }
+}
+
+std::string InputChannelSender::peer_name(uint_fast16_t cn) const {
+  return compute_hostnames_.at(cn) + ":" + compute_services_.at(cn);
+}
+
+void InputChannelSender::bootstrap() {
+  if (Provider::getInst()->is_connection_oriented()) {
+    bootstrap_with_connections();
+  } else {
+    bootstrap_wo_connections();
+  }
+}
 
-    data_source_.proceed();
-    time_begin_ = std::chrono::high_resolution_clock::now();
+void InputChannelSender::start_sending() {
+  data_source_.proceed();
+  time_begin_ = std::chrono::high_resolution_clock::now();
 
-    uint64_t timeslice = 0;
+  timeslice_ = 0;
+  sync_buffer_positions();
+  sync_data_source(true);
+  report_status();
+  if (failure_timeout_.count() > 0) {
+    check_compute_nodes();
+  }
+}
+
+bool InputChannelSender::send_step() {
+  bool progress = false;
+  if (try_send_timeslice(timeslice_)) {
+    ++timeslice_;
+    progress = true;
+  }
+  data_source_.proceed();
+  return progress;
+}
+
+void InputChannelSender::finalize_connections() {
+  sync_data_source(false);
+
+  L_(debug) << "[i " << input_index_ << "] "
+            << "Finalize Connections";
+  for (size_t cn = 0; cn < conn_.size(); ++cn) {
+    if (!cn_failed_[cn]) {
+      conn_[cn]->finalize(abort_);
+    }
+  }
+
+  L_(debug) << "[i" << input_index_ << "] "
+            << "SENDER loop done";
+}
+
+void InputChannelSender::poll_finalization() {
+  if (rma_sync_) {
     sync_buffer_positions();
-    sync_data_source(true);
-    report_status();
-    while (timeslice < max_timeslice_number_ && !abort_) {
-      if (try_send_timeslice(timeslice)) {
-        timeslice++;
+  }
+}
+
+void InputChannelSender::shut_down() {
+  time_end_ = std::chrono::high_resolution_clock::now();
+
+  disconnecting_ = true;
+  if (connection_oriented_) {
+    // connections to failed compute nodes are already closed
+    for (size_t cn = 0; cn < conn_.size(); ++cn) {
+      if (!cn_failed_[cn]) {
+        conn_[cn]->disconnect();
       }
-      poll_completion();
-      data_source_.proceed();
-      scheduler_.timer();
     }
+  }
 
-    // wait for pending send completions
-    while (acked_desc_ < timeslice_size_ * timeslice + start_index_desc_) {
-      poll_completion();
-      scheduler_.timer();
-    }
-    sync_data_source(false);
+  while (connected_ != 0) {
+    poll_cm_events();
+  }
 
-    L_(debug) << "[i " << input_index_ << "] "
-              << "Finalize Connections";
-    for (auto& c : conn_) {
-      c->finalize(abort_);
-    }
+  if (failed_cns_ > 0) {
+    L_(warning) << "[i" << input_index_ << "] " << failed_cns_ << " of "
+                << conn_.size() << " compute nodes failed, "
+                << lost_timeslices_ << " timeslices lost";
+  }
+  summary();
+}
 
-    L_(debug) << "[i" << input_index_ << "] "
-              << "SENDER loop done";
-    while (!all_done_) {
-      poll_completion();
+/// The thread main function.
+void InputChannelSender::operator()() {
+  try {
+    bootstrap();
+    start_sending();
+    while (sending()) {
+      bool progress = send_step();
+      progress |= poll_completion() > 0;
       scheduler_.timer();
+      idle_wait(progress);
     }
-    time_end_ = std::chrono::high_resolution_clock::now();
 
-    if (connection_oriented_) {
-      disconnect();
+    // wait for pending send completions
+    while (draining()) {
+      idle_wait(poll_completion() > 0);
+      scheduler_.timer();
     }
 
-    while (connected_ != 0) {
-      poll_cm_events();
+    finalize_connections();
+    while (!all_done_) {
+      poll_finalization();
+      idle_wait(poll_completion() > 0);
+      scheduler_.timer();
     }
 
-    summary();
+    shut_down();
   } catch (std::exception& e) {
     L_(fatal) << "exception in InputChannelSender: " << e.what();
   }
@@ -275,7 +432,14 @@ bool InputChannelSender::try_send_timeslice(uint64_t timeslice) {
       L_(trace) << get_state_string();
     }
 
-    int cn = target_cn_index(timeslice);
+    int cn = target_cn_index(timeslice, total_length);
+    if (cn == TimesliceAssignment::lost || (cn >= 0 && cn_failed_[cn])) {
+      // the compute node has failed, drop its share of the timeslices
+      drop_timeslice(timeslice, desc_offset + desc_length, data_end);
+      return true;
+    }
+    if (cn < 0)
+      return false;
 
     if (!conn_[cn]->write_request_available())
       return false;
@@ -286,13 +450,21 @@ bool InputChannelSender::try_send_timeslice(uint64_t timeslice) {
 
     if (conn_[cn]->check_for_buffer_space(total_length, 1)) {
 
+      fles::trace(fles::TraceStage::SenderStart, timeslice);
+      sent_to_.at(timeslice) = cn;
       post_send_data(timeslice, cn, desc_offset, desc_length, data_offset,
                      data_length, skip);
 
       conn_[cn]->inc_write_pointers(total_length, 1);
+      if (rma_sync_) {
+        conn_[cn]->try_sync_buffer_positions();
+      }
 
       sent_desc_ = desc_offset + desc_length;
       sent_data_ = data_end;
+      if (dynamic_assignment_) {
+        assignment_.erase(timeslice);
+      }
 
       return true;
     }
@@ -303,19 +475,27 @@ bool InputChannelSender::try_send_timeslice(uint64_t timeslice) {
 
 std::unique_ptr<InputChannelConnection>
 InputChannelSender::create_input_node_connection(uint_fast16_t index) {
-  // @todo
-  // unsigned int max_send_wr = 8000; ???  IB hca
-  // unsigned int max_send_wr = 495; // ??? libfabric for verbs
-  unsigned int max_send_wr = 256; // ??? libfabric for sockets
+  // send queue size as offered by the provider
+  unsigned int max_send_wr = static_cast<unsigned int>(std::min(
+      Provider::getInst()->get_info()->tx_attr->size, size_t(UINT32_MAX)));
 
   // limit pending write requests so that send queue and completion queue
-  // do not overflow
+  // do not overflow (one request reserved for status messages and one for
+  // write pointer updates)
+  unsigned int reserved_wr = rma_sync_ ? 2 : 1;
   unsigned int max_pending_write_requests = std::min(
-      static_cast<unsigned int>((max_send_wr - 1) / 3),
+      (max_send_wr - reserved_wr) /
+          InputChannelConnection::max_writes_per_component(),
       static_cast<unsigned int>((num_cqe_ - 1) / compute_hostnames_.size()));
+  // each descriptor write consumes a receive posted by the compute node
+  if (remote_cq_data_) {
+    max_pending_write_requests =
+        std::min(max_pending_write_requests, remote_cq_data_recv_depth - 1);
+  }
 
   std::unique_ptr<InputChannelConnection> connection(new InputChannelConnection(
-      eq_, index, input_index_, max_send_wr, max_pending_write_requests));
+      eq_, index, input_index_, max_send_wr, max_pending_write_requests,
+      rma_sync_, remote_cq_data_));
   return connection;
 }
 
@@ -333,8 +513,31 @@ void InputChannelSender::connect() {
   }
 }
 
-int InputChannelSender::target_cn_index(uint64_t timeslice) {
-  return timeslice % conn_.size();
+int InputChannelSender::target_cn_index(uint64_t timeslice,
+                                        uint64_t total_length) {
+  if (!dynamic_assignment_) {
+    return timeslice % conn_.size();
+  }
+  if (input_index_ == 0) {
+    return assignment_.select_by_credit(
+        timeslice,
+        [&](int cn) {
+          auto& c = conn_[cn];
+          return !cn_failed_[cn] && c->write_request_available() &&
+                 c->check_for_buffer_space(
+                     total_length + c->skip_required(total_length), 1);
+        },
+        [&](int cn) { return conn_[cn]->free_data_space(); });
+  }
+  bool was_fallback = assignment_.fallback();
+  int cn = assignment_.follow(timeslice, failed_cns_ > 0,
+                              std::chrono::steady_clock::now());
+  if (assignment_.fallback() && !was_fallback) {
+    L_(warning) << "[i" << input_index_ << "] "
+                << "no assignment received for timeslice " << timeslice
+                << ", falling back to round-robin assignment";
+  }
+  return cn;
 }
 
 void InputChannelSender::on_connected(struct fid_domain* pd) {
@@ -373,6 +576,14 @@ void InputChannelSender::on_connected(struct fid_domain* pd) {
   }
 }
 
+void InputChannelSender::on_established(struct fi_eq_cm_entry* event) {
+  ConnectionGroup::on_established(event);
+
+  InputChannelConnection* conn =
+      static_cast<InputChannelConnection*>(event->fid->context);
+  on_peer_connected(conn->index());
+}
+
 void InputChannelSender::on_rejected(struct fi_eq_err_entry* event) {
   L_(debug) << "InputChannelSender:on_rejected";
 
@@ -383,13 +594,16 @@ void InputChannelSender::on_rejected(struct fi_eq_err_entry* event) {
   uint_fast16_t i = conn->index();
   conn_.at(i) = nullptr;
 
-  L_(debug) << "retrying: " << i;
-  // immediately initiate retry
-  std::unique_ptr<InputChannelConnection> connection =
-      create_input_node_connection(i);
-  connection->connect(compute_hostnames_[i], compute_services_[i], pd_, cq_,
-                      av_, FI_ADDR_UNSPEC);
-  conn_.at(i) = std::move(connection);
+  // retried by retry_connections() after a growing delay
+  ExponentialBackoff& backoff = connect_backoff_.at(i);
+  backoff.failed(ExponentialBackoff::clock::now());
+  L_(debug) << "[i" << input_index_ << "] "
+            << "connection to " << peer_name(i) << " failed (attempt "
+            << backoff.failures() << "), retrying in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   backoff.next_attempt() - ExponentialBackoff::clock::now())
+                   .count()
+            << " ms";
 }
 
 std::string InputChannelSender::get_state_string() {
@@ -477,58 +691,188 @@ void InputChannelSender::post_send_data(uint64_t timeslice,
                        skip);
 }
 
-void InputChannelSender::on_completion(uint64_t wr_id) {
-  switch (wr_id & 0xFF) {
-  case ID_WRITE_DESC: {
-    uint64_t ts = wr_id >> 24;
+void InputChannelSender::complete_timeslice_write(uint64_t ts) {
+  uint64_t acked_ts = (acked_desc_ - start_index_desc_) / timeslice_size_;
+  if (ts != acked_ts) {
+    // transmission has been reordered, store completion information
+    ack_.at(ts) = ts;
+  } else {
+    // completion is for earliest pending timeslice, update indices
+    do {
+      ++acked_ts;
+    } while (ack_.at(acked_ts) > ts);
+
+    acked_desc_ = acked_ts * timeslice_size_ + start_index_desc_;
+    acked_data_ = data_source_.desc_buffer().at(acked_desc_ - 1).offset +
+                  data_source_.desc_buffer().at(acked_desc_ - 1).size;
+    if (acked_data_ >= cached_acked_data_ + min_acked_data_ ||
+        acked_desc_ >= cached_acked_desc_ + min_acked_desc_) {
+      cached_acked_data_ = acked_data_;
+      cached_acked_desc_ = acked_desc_;
+      data_source_.set_read_index({cached_acked_desc_, cached_acked_data_});
+    }
+  }
+  if (false) {
+    L_(trace) << "[i" << input_index_ << "] "
+              << "write timeslice " << ts
+              << " complete, now: acked_data_=" << acked_data_
+              << " acked_desc_=" << acked_desc_;
+  }
+}
 
-    int cn = (wr_id >> 8) & 0xFFFF;
-    conn_[cn]->on_complete_write();
+void InputChannelSender::drop_timeslice(uint64_t timeslice,
+                                        uint64_t desc_end,
+                                        uint64_t data_end) {
+  sent_to_.at(timeslice) = -1;
+  sent_desc_ = desc_end;
+  sent_data_ = data_end;
+  if (dynamic_assignment_) {
+    assignment_.erase(timeslice);
+  }
+  ++lost_timeslices_;
+  complete_timeslice_write(timeslice);
+}
 
-    uint64_t acked_ts = (acked_desc_ - start_index_desc_) / timeslice_size_;
-    if (ts != acked_ts) {
-      // transmission has been reordered, store completion information
-      ack_.at(ts) = ts;
-    } else {
-      // completion is for earliest pending timeslice, update indices
-      do {
-        ++acked_ts;
-      } while (ack_.at(acked_ts) > ts);
-
-      acked_desc_ = acked_ts * timeslice_size_ + start_index_desc_;
-      acked_data_ = data_source_.desc_buffer().at(acked_desc_ - 1).offset +
-                    data_source_.desc_buffer().at(acked_desc_ - 1).size;
-      if (acked_data_ >= cached_acked_data_ + min_acked_data_ ||
-          acked_desc_ >= cached_acked_desc_ + min_acked_desc_) {
-        cached_acked_data_ = acked_data_;
-        cached_acked_desc_ = acked_desc_;
-        data_source_.set_read_index({cached_acked_desc_, cached_acked_data_});
-      }
+void InputChannelSender::check_compute_nodes() {
+  auto now = std::chrono::steady_clock::now();
+  for (size_t cn = 0; cn < conn_.size(); ++cn) {
+    if (!cn_failed_[cn] &&
+        conn_[cn]->status_reply_overdue(now, failure_timeout_)) {
+      on_compute_node_failed(static_cast<int>(cn), "status timeout", false);
     }
-    if (false) {
-      L_(trace) << "[i" << input_index_ << "] "
-                << "write timeslice " << ts
-                << " complete, now: acked_data_=" << acked_data_
-                << " acked_desc_=" << acked_desc_;
+  }
+  // keep checking while finalizing, a dead compute node would otherwise
+  // never be counted as done
+  if (all_done_ || disconnecting_) {
+    return;
+  }
+  scheduler_.add(std::bind(&InputChannelSender::check_compute_nodes, this),
+                 std::chrono::system_clock::now() + failure_timeout_ / 4);
+}
+
+void InputChannelSender::on_compute_node_failed(int cn,
+                                                const char* reason,
+                                                bool disconnected) {
+  if (cn_done_[cn]) {
+    // finished regularly, nothing is in flight anymore
+    L_(debug) << "[i" << input_index_ << "] "
+              << "ignoring failure of finished compute node " << peer_name(cn)
+              << " (" << reason << ")";
+    return;
+  }
+  cn_failed_[cn] = true;
+  ++failed_cns_;
+  L_(error) << "[i" << input_index_ << "] "
+            << "compute node " << peer_name(cn) << " failed (" << reason
+            << "), " << conn_.size() - failed_cns_ << " of " << conn_.size()
+            << " remaining";
+
+  if (!disconnected) {
+    ConnectionGroup::on_disconnected(nullptr, cn);
+  }
+
+  // timeslices in flight are lost, release their input data
+  for (uint64_t ts = (acked_desc_ - start_index_desc_) / timeslice_size_;
+       ts < timeslice_; ++ts) {
+    uint64_t acked_ts = (acked_desc_ - start_index_desc_) / timeslice_size_;
+    bool written = ts < acked_ts || (ts > acked_ts && ack_.at(ts) == ts);
+    if (!written && sent_to_.at(ts) == cn) {
+      ++lost_timeslices_;
+      complete_timeslice_write(ts);
     }
+  }
+
+  // a failed connection does not need to be finalized
+  on_connection_done(cn);
+
+  if (failed_cns_ == conn_.size()) {
+    L_(fatal) << "[i" << input_index_ << "] "
+              << "all compute nodes failed";
+    abort_ = true;
+  }
+}
+
+void InputChannelSender::on_connection_done(int cn) {
+  if (cn_done_[cn]) {
+    return;
+  }
+  cn_done_[cn] = true;
+  ++connections_done_;
+  all_done_ = (connections_done_ == conn_.size());
+}
+
+void InputChannelSender::on_disconnected(struct fi_eq_cm_entry* event,
+                                         int conn_indx) {
+  if (event == nullptr || disconnecting_ || failure_timeout_.count() == 0) {
+    ConnectionGroup::on_disconnected(event, conn_indx);
+    return;
+  }
+  InputChannelConnection* conn =
+      static_cast<InputChannelConnection*>(event->fid->context);
+  int cn = static_cast<int>(conn->index());
+  if (cn_failed_[cn]) {
+    // already closed on failure
+    return;
+  }
+  bool expected = conn->done();
+  ConnectionGroup::on_disconnected(event, conn_indx);
+  if (!expected) {
+    on_compute_node_failed(cn, "disconnected", true);
+  }
+}
+
+void InputChannelSender::on_completion_error(
+    const struct fi_cq_err_entry& err) {
+  uint64_t wr_id = reinterpret_cast<uintptr_t>(err.op_context);
+  int cn = static_cast<int>(request_conn_index(wr_id));
+  if (failure_timeout_.count() == 0 || !connected_indexes_.count(cn)) {
+    ConnectionGroup::on_completion_error(err);
+    return;
+  }
+  if (!cn_failed_[cn]) {
+    L_(error) << "[i" << input_index_ << "] "
+              << "completion error on connection to " << peer_name(cn)
+              << ": " << fi_strerror(err.err);
+    on_compute_node_failed(cn, "completion error", false);
+  }
+}
+
+void InputChannelSender::on_completion(uint64_t wr_id) {
+  int cn = static_cast<int>(request_conn_index(wr_id));
+  if (cn_failed_[cn]) {
+    // everything in flight has been accounted for on failure
+    return;
+  }
+
+  switch (request_id(wr_id)) {
+  case ID_WRITE_DESC: {
+    uint64_t ts = conn_[cn]->on_complete_write(request_tag(wr_id));
+    fles::trace(fles::TraceStage::TransferComplete, ts);
+
+    complete_timeslice_write(ts);
   } break;
 
   case ID_RECEIVE_STATUS: {
-    int cn = wr_id >> 8;
     conn_[cn]->on_complete_recv();
+    for (uint64_t ts : conn_[cn]->take_assignments()) {
+      assignment_.assign(ts, cn);
+    }
     if (!connection_oriented_ && !conn_[cn]->get_partner_addr()) {
       conn_[cn]->set_partner_addr(av_);
       conn_[cn]->set_remote_info();
       on_connected(pd_);
       ++connected_;
-      connected_indexes_.insert(cn);
+      on_peer_connected(cn);
+    }
+    if (!rma_sync_ && !cn_failed_[cn]) {
+      // it is our turn again unless the connection is being finalized
+      conn_[cn]->try_sync_buffer_positions();
     }
     if (conn_[cn]->request_abort_flag()) {
       abort_ = true;
     }
     if (conn_[cn]->done()) {
-      ++connections_done_;
-      all_done_ = (connections_done_ == conn_.size());
+      on_connection_done(cn);
       if (!connection_oriented_) {
         on_disconnected(nullptr, cn);
       }
@@ -541,6 +885,10 @@ void InputChannelSender::on_completion(uint64_t wr_id) {
   case ID_SEND_STATUS: {
   } break;
 
+  case ID_WRITE_POSITIONS: {
+    conn_[cn]->on_complete_position_write();
+  } break;
+
   default:
     L_(fatal) << "[i" << input_index_ << "] "
               << "wc for unknown wr_id=" << (wr_id & 0xFF);
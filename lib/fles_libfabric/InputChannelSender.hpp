@@ -5,8 +5,10 @@
 
 #include "ConnectionGroup.hpp"
 #include "DualRingBuffer.hpp"
+#include "ExponentialBackoff.hpp"
 #include "InputChannelConnection.hpp"
 #include "RingBuffer.hpp"
+#include "TimesliceAssignment.hpp"
 #include <boost/format.hpp>
 #include <cassert>
 
@@ -31,6 +33,12 @@ public:
                      uint32_t timeslice_size,
                      uint32_t overlap_size,
                      uint32_t max_timeslice_number,
+                     bool dynamic_assignment,
+                     bool rma_sync,
+                     bool remote_cq_data,
+                     bool idle_wait,
+                     uint32_t spin_time_us,
+                     uint32_t failure_timeout_ms,
                      std::string input_node_name);
 
   InputChannelSender(const InputChannelSender&) = delete;
@@ -58,12 +66,59 @@ public:
   virtual void on_connected(struct fid_domain* pd) override;
 
 private:
-  /// Return target computation node for given timeslice.
-  int target_cn_index(uint64_t timeslice);
+  /// Establish the connections to the compute nodes.
+  void bootstrap();
+
+  /// Start distributing timeslice data.
+  void start_sending();
+
+  /// Try to send the next timeslice, return true on progress.
+  bool send_step();
+
+  /// Check if there are timeslices left to send.
+  bool sending() const {
+    return timeslice_ < max_timeslice_number_ && !abort_;
+  }
+
+  /// Check if sent timeslices are still waiting for completion.
+  bool draining() const {
+    return acked_desc_ < timeslice_size_ * timeslice_ + start_index_desc_;
+  }
+
+  /// Announce the end of the data stream to the compute nodes.
+  void finalize_connections();
+
+  /// Keep buffer positions up to date until the compute nodes are done.
+  void poll_finalization();
+
+  /// Disconnect from the compute nodes and print the summary.
+  void shut_down();
+
+  /// Return target computation node for given timeslice, -1 if the
+  /// timeslice cannot be assigned yet, or -2 if it is to be dropped.
+  int target_cn_index(uint64_t timeslice, uint64_t total_length);
 
   /// Handle RDMA_CM_REJECTED event.
   virtual void on_rejected(struct fi_eq_err_entry* event) override;
 
+  /// Handle RDMA_CM_EVENT_ESTABLISHED event.
+  virtual void on_established(struct fi_eq_cm_entry* event) override;
+
+  /// Reset the connection retry schedules before bootstrapping.
+  void begin_bootstrap();
+
+  /// Retry the connections to compute nodes that are due.
+  void retry_connections();
+
+  /// Record a connection to a compute node as established.
+  void on_peer_connected(uint_fast16_t cn);
+
+  /// Log the bootstrap progress (periodically or on completion).
+  void report_bootstrap_progress(bool complete);
+
+  /// Return "host:service" of a compute node, for log output.
+  std::string peer_name(uint_fast16_t cn) const;
+
   /// Return string describing buffer contents, suitable for debug output.
   std::string get_state_string();
 
@@ -79,6 +134,34 @@ private:
   /// Completion notification event dispatcher. Called by the event loop.
   virtual void on_completion(uint64_t wc_id) override;
 
+  /// Completion error handler. Called by the event loop.
+  virtual void
+  on_completion_error(const struct fi_cq_err_entry& err) override;
+
+  /// Handle RDMA_CM_EVENT_DISCONNECTED event.
+  virtual void on_disconnected(struct fi_eq_cm_entry* event,
+                               int conn_indx = -1) override;
+
+  /// Update the acknowledged positions after a timeslice has been written.
+  void complete_timeslice_write(uint64_t ts);
+
+  /// Skip a timeslice whose compute node has failed.
+  void drop_timeslice(uint64_t timeslice, uint64_t desc_end, uint64_t data_end);
+
+  /// Detect compute nodes that no longer answer status messages.
+  void check_compute_nodes();
+
+  /// Remove a failed compute node from the set of targets.
+  /**
+   \param cn           Index of the compute node
+   \param reason       Description of the failure, for log output
+   \param disconnected Flag, true if the connection is already closed
+   */
+  void on_compute_node_failed(int cn, const char* reason, bool disconnected);
+
+  /// Count a connection that needs no further finalization (once only).
+  void on_connection_done(int cn);
+
   /// setup connections between nodes
   void bootstrap_with_connections();
 
@@ -118,6 +201,42 @@ private:
   const uint32_t overlap_size_;
   const uint32_t max_timeslice_number_;
 
+  /// Whether timeslices are assigned dynamically. The first input channel
+  /// assigns each timeslice to the compute node with the most free buffer
+  /// space (credits). The compute nodes forward these assignments to the
+  /// other input channels, which follow them and fall back to round-robin
+  /// assignment if a forwarded assignment is overdue.
+  const bool dynamic_assignment_;
+
+  /// Timeslice assignments received from compute nodes, not yet sent.
+  TimesliceAssignment assignment_;
+
+  /// Whether buffer positions are exchanged by RDMA writes instead of
+  /// status messages.
+  const bool rma_sync_;
+
+  /// Time without a status reply after which a compute node is considered
+  /// failed (zero disables failure handling).
+  const std::chrono::milliseconds failure_timeout_;
+
+  /// Flags, true for compute nodes that have failed.
+  std::vector<bool> cn_failed_;
+
+  /// Flags, true for connections counted in connections_done_.
+  std::vector<bool> cn_done_;
+
+  /// Number of failed compute nodes.
+  size_t failed_cns_ = 0;
+
+  /// Number of timeslices dropped or lost in flight due to failures.
+  uint64_t lost_timeslices_ = 0;
+
+  /// Target compute node of each timeslice in flight (-1 if dropped).
+  RingBuffer<int> sent_to_;
+
+  /// Flag, true once the regular disconnection has begun.
+  bool disconnecting_ = false;
+
   const uint64_t min_acked_desc_;
   const uint64_t min_acked_data_;
 
@@ -131,8 +250,20 @@ private:
 
   std::set<uint_fast16_t> connected_buffers_;
 
+  /// Retry schedules of the connections to the compute nodes.
+  std::vector<ExponentialBackoff> connect_backoff_;
+
+  /// Start time of the connection bootstrap.
+  std::chrono::steady_clock::time_point bootstrap_begin_;
+
+  /// Time of the next periodic bootstrap progress report.
+  std::chrono::steady_clock::time_point next_progress_report_;
+
   bool abort_ = false;
 
+  /// Index of the next timeslice to send.
+  uint64_t timeslice_ = 0;
+
   struct SendBufferStatus {
     std::chrono::system_clock::time_point time;
     uint64_t size;
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "ComputeNodeBufferPosition.hpp"
+#include "ComputeNodeInfo.hpp"
 #include "InputNodeInfo.hpp"
 
 #pragma pack(1)
@@ -18,6 +19,8 @@ struct InputChannelStatusMessage {
   // "private data" on connect
   bool connect;
   InputNodeInfo info;
+  // target of the acknowledged position updates (RMA sync)
+  BufferInfo ack_target;
   unsigned char my_address[64]; // gni: 50?};
 };
 } // namespace tl_libfabric
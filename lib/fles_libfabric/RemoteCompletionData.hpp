@@ -0,0 +1,32 @@
+// Copyright 2016 Thorsten Schuett <schuett@zib.de>, Farouk Salem <salem@zib.de>
+
+#pragma once
+
+#include <cstdint>
+
+namespace tl_libfabric {
+/// Number of receive requests a compute node keeps posted per connection if
+/// timeslice component arrivals are signaled by remote CQ data. Some
+/// providers (e.g., verbs) consume a posted receive for each such write.
+constexpr uint32_t remote_cq_data_recv_depth = 128;
+
+/// Encode the remote CQ data of a timeslice component descriptor write.
+/** Providers guarantee only 4 bytes of remote CQ data, so it carries the
+ index of the input channel and the lower 16 bits of the timeslice number.
+ */
+inline uint64_t make_remote_cq_data(uint_fast16_t input_index,
+                                    uint64_t timeslice) {
+  return (static_cast<uint64_t>(input_index & 0xFFFF) << 16) |
+         (timeslice & 0xFFFF);
+}
+
+/// Retrieve the input channel index from remote CQ data.
+inline uint_fast16_t remote_cq_data_input(uint64_t data) {
+  return static_cast<uint_fast16_t>((data >> 16) & 0xFFFF);
+}
+
+/// Retrieve the lower 16 bits of the timeslice number from remote CQ data.
+inline uint64_t remote_cq_data_timeslice(uint64_t data) {
+  return data & 0xFFFF;
+}
+} // namespace tl_libfabric
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 
 #pragma pack(1)
@@ -15,7 +16,8 @@ enum RequestIdentifier {
   ID_WRITE_DESC,
   ID_SEND_STATUS,
   ID_RECEIVE_STATUS,
-  ID_SEND_FINALIZE
+  ID_SEND_FINALIZE,
+  ID_WRITE_POSITIONS
 };
 } // namespace tl_libfabric
 #pragma pack()
@@ -36,8 +38,31 @@ inline std::ostream& operator<<(std::ostream& s, RequestIdentifier v) {
     return s << "ID_RECEIVE_STATUS";
   case ID_SEND_FINALIZE:
     return s << "ID_SEND_FINALIZE";
+  case ID_WRITE_POSITIONS:
+    return s << "ID_WRITE_POSITIONS";
   default:
     return s << static_cast<int>(v);
   }
 }
+
+/// Build the context of a work request from its type, the index of its
+/// connection and a request specific tag (e.g., the source buffer slot of
+/// a descriptor write).
+inline uint64_t request_context(RequestIdentifier id, uint64_t conn_index,
+                                uint64_t tag = 0) {
+  return static_cast<uint64_t>(id) | (conn_index << 8) | (tag << 24);
+}
+
+/// Retrieve the request type from a work request context.
+inline RequestIdentifier request_id(uint64_t wr_id) {
+  return static_cast<RequestIdentifier>(wr_id & 0xFF);
+}
+
+/// Retrieve the connection index from a work request context.
+inline uint_fast16_t request_conn_index(uint64_t wr_id) {
+  return static_cast<uint_fast16_t>((wr_id >> 8) & 0xFFFF);
+}
+
+/// Retrieve the request specific tag from a work request context.
+inline uint64_t request_tag(uint64_t wr_id) { return wr_id >> 24; }
 } // namespace tl_libfabric
@@ -3,7 +3,9 @@
 
 #include "TimesliceBuilder.hpp"
 #include "ChildProcessManager.hpp"
+#include "LatencyTracer.hpp"
 //#include "InputNodeInfo.hpp"
+#include "RemoteCompletionData.hpp"
 #include "RequestIdentifier.hpp"
 #include "TimesliceCompletion.hpp"
 #include "TimesliceWorkItem.hpp"
@@ -22,11 +24,20 @@ TimesliceBuilder::TimesliceBuilder(uint64_t compute_index,
                                    uint32_t num_input_nodes,
                                    uint32_t timeslice_size,
                                    volatile sig_atomic_t* signal_status,
+                                   bool dynamic_assignment,
+                                   bool rma_sync,
+                                   bool remote_cq_data,
+                                   bool idle_wait,
+                                   uint32_t spin_time_us,
+                                   uint32_t completeness_timeout_ms,
                                    bool drop,
                                    std::string local_node_name)
-    : ConnectionGroup(local_node_name), compute_index_(compute_index),
-      timeslice_buffer_(timeslice_buffer), service_(service),
-      num_input_nodes_(num_input_nodes), timeslice_size_(timeslice_size),
+    : ConnectionGroup(local_node_name, idle_wait, spin_time_us),
+      compute_index_(compute_index), timeslice_buffer_(timeslice_buffer),
+      service_(service), num_input_nodes_(num_input_nodes),
+      timeslice_size_(timeslice_size), dynamic_assignment_(dynamic_assignment),
+      rma_sync_(rma_sync), written_desc_(num_input_nodes),
+      completeness_timeout_(completeness_timeout_ms),
       ack_(timeslice_buffer_.get_desc_size_exp()),
       signal_status_(signal_status), local_node_name_(local_node_name),
       drop_(drop) {
@@ -37,6 +48,16 @@ TimesliceBuilder::TimesliceBuilder(uint64_t compute_index,
   } else {
     connection_oriented_ = false;
   }
+  remote_cq_data_ = remote_cq_data;
+  if (remote_cq_data_ &&
+      Provider::getInst()->get_info()->domain_attr->cq_data_size < 4) {
+    throw LibfabricException("provider does not support remote CQ data");
+  }
+  if (completeness_timeout_.count() > 0 &&
+      num_input_nodes_ > fles::max_flagged_components) {
+    throw LibfabricException(
+        "too many input channels for partial timeslices");
+  }
 }
 
 TimesliceBuilder::~TimesliceBuilder() {}
@@ -64,6 +85,14 @@ void TimesliceBuilder::report_status() {
              << bar_graph(status_desc.vector(), "#._", 10) << "| ";
   }
 
+  if (partial_timeslices_ > reported_partial_timeslices_) {
+    L_(warning) << "[c" << compute_index_ << "] "
+                << partial_timeslices_ - reported_partial_timeslices_
+                << " partial timeslices published (" << partial_timeslices_
+                << " in total)";
+    reported_partial_timeslices_ = partial_timeslices_;
+  }
+
   scheduler_.add(std::bind(&TimesliceBuilder::report_status, this),
                  now + interval);
 }
@@ -216,7 +245,7 @@ void TimesliceBuilder::bootstrap_wo_connections() {
     std::unique_ptr<ComputeNodeConnection> conn(new ComputeNodeConnection(
         eq_, pd_, cq_, av_, index, compute_index_, data_ptr,
         timeslice_buffer_.get_data_size_exp(), desc_ptr,
-        timeslice_buffer_.get_desc_size_exp()));
+        timeslice_buffer_.get_desc_size_exp(), rma_sync_, remote_cq_data_));
     conn->setup_mr(pd_);
     conn->setup();
     conn_.at(index) = std::move(conn);
@@ -320,10 +349,17 @@ void TimesliceBuilder::operator()() {
     time_begin_ = std::chrono::high_resolution_clock::now();
 
     report_status();
+    if (completeness_timeout_.count() > 0) {
+      check_completeness();
+    }
     while (!all_done_ || connected_ != 0) {
+      bool progress = false;
       if (!all_done_) {
-        poll_completion();
-        poll_ts_completion();
+        progress |= poll_completion() > 0;
+        if (rma_sync_ && !remote_cq_data_) {
+          progress |= poll_write_pointers();
+        }
+        progress |= poll_ts_completion();
       }
       if (connected_ != 0) {
         poll_cm_events();
@@ -333,6 +369,7 @@ void TimesliceBuilder::operator()() {
         *signal_status_ = 0;
         request_abort();
       }
+      idle_wait(progress);
     }
 
     time_end_ = std::chrono::high_resolution_clock::now();
@@ -365,7 +402,8 @@ void TimesliceBuilder::on_connect_request(struct fi_eq_cm_entry* event,
                                 timeslice_buffer_.get_data_ptr(index),
                                 timeslice_buffer_.get_data_size_exp(),
                                 timeslice_buffer_.get_desc_ptr(index),
-                                timeslice_buffer_.get_desc_size_exp()));
+                                timeslice_buffer_.get_desc_size_exp(),
+                                rma_sync_, remote_cq_data_));
   conn_.at(index) = std::move(conn);
 
   conn_.at(index)->on_connect_request(event, pd_, cq_);
@@ -404,36 +442,11 @@ void TimesliceBuilder::on_completion(uint64_t wr_id) {
 
   case ID_RECEIVE_STATUS:
     conn_[in]->on_complete_recv();
-    if (connected_ == conn_.size() && in == red_lantern_) {
-      auto new_red_lantern = std::min_element(
-          std::begin(conn_), std::end(conn_),
-          [](const std::unique_ptr<ComputeNodeConnection>& v1,
-             const std::unique_ptr<ComputeNodeConnection>& v2) {
-            return v1->cn_wp().desc < v2->cn_wp().desc;
-          });
-
-      uint64_t new_completely_written = (*new_red_lantern)->cn_wp().desc;
-      red_lantern_ = std::distance(std::begin(conn_), new_red_lantern);
-
-      for (uint64_t tpos = completely_written_; tpos < new_completely_written;
-           ++tpos) {
-        if (!drop_) {
-          uint64_t ts_index = UINT64_MAX;
-          if (conn_.size() > 0) {
-            ts_index = timeslice_buffer_.get_desc(0, tpos).ts_num;
-          }
-          timeslice_buffer_.send_work_item(
-              {{ts_index, tpos, timeslice_size_,
-                static_cast<uint32_t>(conn_.size())},
-               timeslice_buffer_.get_data_size_exp(),
-               timeslice_buffer_.get_desc_size_exp()});
-        } else {
-          timeslice_buffer_.send_completion({tpos});
-        }
-      }
+    on_write_pointers_updated(in);
+    break;
 
-      completely_written_ = new_completely_written;
-    }
+  case ID_WRITE_POSITIONS:
+    conn_[in]->on_complete_position_write();
     break;
 
   default:
@@ -441,10 +454,131 @@ void TimesliceBuilder::on_completion(uint64_t wr_id) {
   }
 }
 
-void TimesliceBuilder::poll_ts_completion() {
+void TimesliceBuilder::on_remote_cq_data(uint64_t wc_id, uint64_t data) {
+  size_t in = remote_cq_data_input(data);
+  assert(in < conn_.size());
+  conn_[in]->on_remote_write(data, wc_id != 0);
+  on_write_pointers_updated(in);
+}
+
+bool TimesliceBuilder::poll_write_pointers() {
+  if (connected_ != conn_.size()) {
+    return false;
+  }
+  bool updated = false;
+  for (size_t in = 0; in < conn_.size(); ++in) {
+    if (conn_[in]->poll_write_pointers()) {
+      on_write_pointers_updated(in);
+      updated = true;
+    }
+  }
+  return updated;
+}
+
+void TimesliceBuilder::on_write_pointers_updated(size_t in) {
+  if (dynamic_assignment_ && in == 0 && connected_ == conn_.size()) {
+    forward_assignments();
+  }
+  uint64_t written = conn_[in]->cn_wp().desc;
+  written_desc_.update(in, written);
+  if (completeness_timeout_.count() > 0) {
+    if (written > max_written_) {
+      auto now = std::chrono::steady_clock::now();
+      for (; max_written_ < written; ++max_written_) {
+        first_arrival_.push_back(now);
+      }
+    }
+    // release late components of timeslices published without them
+    if (conn_[in]->cn_ack().desc < acked_) {
+      conn_[in]->inc_ack_pointers(acked_);
+    }
+  }
+  // publish all timeslices completed by an advance of the red lantern
+  uint64_t new_completely_written = written_desc_.min();
+  if (connected_ == conn_.size() &&
+      new_completely_written > completely_written_) {
+    for (uint64_t tpos = completely_written_; tpos < new_completely_written;
+         ++tpos) {
+      publish_timeslice(tpos, true);
+    }
+
+    completely_written_ = new_completely_written;
+  }
+}
+
+void TimesliceBuilder::publish_timeslice(uint64_t tpos, bool complete) {
+  if (!first_arrival_.empty()) {
+    first_arrival_.pop_front();
+  }
+  if (drop_) {
+    timeslice_buffer_.send_completion({tpos});
+    return;
+  }
+
+  fles::TimesliceWorkItem wi = {
+      {UINT64_MAX, tpos, timeslice_size_, static_cast<uint32_t>(conn_.size())},
+      timeslice_buffer_.get_data_size_exp(),
+      timeslice_buffer_.get_desc_size_exp(),
+      0,
+      {}};
+  if (complete) {
+    if (conn_.size() > 0) {
+      wi.ts_desc.index = timeslice_buffer_.get_desc(0, tpos).ts_num;
+    }
+  } else {
+    std::string missing;
+    for (size_t in = 0; in < conn_.size(); ++in) {
+      if (conn_[in]->cn_wp().desc <= tpos) {
+        wi.set_component_missing(in);
+        missing += (missing.empty() ? "" : ",") + std::to_string(in);
+      } else if (wi.ts_desc.index == UINT64_MAX) {
+        wi.ts_desc.index = timeslice_buffer_.get_desc(in, tpos).ts_num;
+      }
+    }
+    ++partial_timeslices_;
+    if (partial_timeslices_ == 1) {
+      L_(warning) << "[c" << compute_index_ << "] "
+                  << "completeness timeout, publishing timeslice "
+                  << wi.ts_desc.index << " without components " << missing;
+    } else {
+      L_(debug) << "[c" << compute_index_ << "] "
+                << "publishing timeslice " << wi.ts_desc.index
+                << " without components " << missing;
+    }
+  }
+  fles::trace(fles::TraceStage::WorkItemSent, wi.ts_desc.index);
+  timeslice_buffer_.send_work_item(wi);
+}
+
+void TimesliceBuilder::check_completeness() {
+  if (connected_ == conn_.size()) {
+    auto now = std::chrono::steady_clock::now();
+    // the front entry belongs to the oldest unpublished timeslice
+    while (!first_arrival_.empty() &&
+           now - first_arrival_.front() >= completeness_timeout_) {
+      publish_timeslice(completely_written_, false);
+      ++completely_written_;
+    }
+  }
+  scheduler_.add(std::bind(&TimesliceBuilder::check_completeness, this),
+                 std::chrono::system_clock::now() + completeness_timeout_ / 4);
+}
+
+void TimesliceBuilder::forward_assignments() {
+  // the first input channel decides, the others follow in the same order
+  uint64_t written = conn_[0]->cn_wp().desc;
+  for (; forwarded_ < written; ++forwarded_) {
+    uint64_t ts_index = timeslice_buffer_.get_desc(0, forwarded_).ts_num;
+    for (size_t i = 1; i < conn_.size(); ++i) {
+      conn_[i]->forward_assignment(ts_index);
+    }
+  }
+}
+
+bool TimesliceBuilder::poll_ts_completion() {
   fles::TimesliceCompletion c;
   if (!timeslice_buffer_.try_receive_completion(c))
-    return;
+    return false;
   if (c.ts_pos == acked_) {
     do
       ++acked_;
@@ -453,5 +587,6 @@ void TimesliceBuilder::poll_ts_completion() {
       connection->inc_ack_pointers(acked_);
   } else
     ack_.at(c.ts_pos) = c.ts_pos;
+  return true;
 }
 } // namespace tl_libfabric
@@ -11,14 +11,17 @@
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
 
+#include <chrono>
 #include <csignal>
 #include <cstdint>
+#include <deque>
 #include <set>
 #include <string>
 
 #include "ComputeNodeConnection.hpp"
 #include "ConnectionGroup.hpp"
 #include "TimesliceBuffer.hpp"
+#include "TournamentTree.hpp"
 
 namespace tl_libfabric {
 
@@ -36,6 +39,12 @@ public:
                    uint32_t num_input_nodes,
                    uint32_t timeslice_size,
                    volatile sig_atomic_t* signal_status,
+                   bool dynamic_assignment,
+                   bool rma_sync,
+                   bool remote_cq_data,
+                   bool idle_wait,
+                   uint32_t spin_time_us,
+                   uint32_t completeness_timeout_ms,
                    bool drop,
                    std::string local_node_name);
 
@@ -58,9 +67,33 @@ public:
   /// Completion notification event dispatcher. Called by the event loop.
   virtual void on_completion(uint64_t wc_id) override;
 
-  void poll_ts_completion();
+  /// Handle the arrival of a timeslice component signaled by remote CQ data.
+  virtual void on_remote_cq_data(uint64_t wc_id, uint64_t data) override;
+
+  /// Handle a timeslice completion from the consumers, if available.
+  bool poll_ts_completion();
 
 private:
+  /// Read the write pointers written by the input channels (RMA sync).
+  /// Returns true if any of them has changed.
+  bool poll_write_pointers();
+
+  /// Handle updated write pointers of the given input channel.
+  void on_write_pointers_updated(size_t in);
+
+  /// Send the work item of the timeslice at the given buffer position.
+  /** A timeslice that is not complete is published without the components
+      of the input channels that have not written it yet. */
+  void publish_timeslice(uint64_t tpos, bool complete);
+
+  /// Publish the incomplete timeslices whose completeness timeout has
+  /// expired. Reschedules itself.
+  void check_completeness();
+
+  /// Forward the timeslices newly assigned by the first input channel to
+  /// all other input channels (dynamic assignment).
+  void forward_assignments();
+
   /// setup connections between nodes
   void bootstrap_with_connections();
 
@@ -90,10 +123,41 @@ private:
 
   uint32_t timeslice_size_;
 
-  size_t red_lantern_ = 0;
+  /// Whether timeslices are assigned dynamically by the first input channel.
+  bool dynamic_assignment_;
+
+  /// Number of timeslice components of the first input channel whose
+  /// assignment has been forwarded (dynamic assignment).
+  uint64_t forwarded_ = 0;
+
+  /// Whether buffer positions are exchanged by RDMA writes instead of status
+  /// messages.
+  bool rma_sync_;
+
+  /// Descriptor write positions of the input channels (minimum: red
+  /// lantern).
+  TournamentTree<uint64_t> written_desc_;
+
   uint64_t completely_written_ = 0;
   uint64_t acked_ = 0;
 
+  /// Time after which an incomplete timeslice is published without its
+  /// missing components (zero: wait forever).
+  std::chrono::milliseconds completeness_timeout_;
+
+  /// Arrival times of the first component of the timeslices from
+  /// completely_written_ to max_written_.
+  std::deque<std::chrono::steady_clock::time_point> first_arrival_;
+
+  /// Highest descriptor write position of any input channel.
+  uint64_t max_written_ = 0;
+
+  /// Number of timeslices published with missing components.
+  uint64_t partial_timeslices_ = 0;
+
+  /// Number of partial timeslices already reported in report_status().
+  uint64_t reported_partial_timeslices_ = 0;
+
   /// Buffer to store acknowledged status of timeslices.
   RingBuffer<uint64_t, true> ack_;
 
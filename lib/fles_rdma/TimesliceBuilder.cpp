@@ -16,7 +16,7 @@ TimesliceBuilder::TimesliceBuilder(uint64_t compute_index,
                                    bool drop)
     : compute_index_(compute_index), timeslice_buffer_(timeslice_buffer),
       service_(service), num_input_nodes_(num_input_nodes),
-      timeslice_size_(timeslice_size),
+      timeslice_size_(timeslice_size), written_desc_(num_input_nodes),
       ack_(timeslice_buffer_.get_desc_size_exp()),
       signal_status_(signal_status), drop_(drop) {
   assert(timeslice_buffer_.get_num_input_nodes() == num_input_nodes);
@@ -154,17 +154,11 @@ void TimesliceBuilder::on_completion(const struct ibv_wc& wc) {
 
   case ID_RECEIVE_STATUS: {
     conn_[in]->on_complete_recv();
-    if (connected_ == conn_.size() && in == red_lantern_) {
-      auto new_red_lantern = std::min_element(
-          std::begin(conn_), std::end(conn_),
-          [](const std::unique_ptr<ComputeNodeConnection>& v1,
-             const std::unique_ptr<ComputeNodeConnection>& v2) {
-            return v1->cn_wp().desc < v2->cn_wp().desc;
-          });
-
-      uint64_t new_completely_written = (*new_red_lantern)->cn_wp().desc;
-      red_lantern_ = std::distance(std::begin(conn_), new_red_lantern);
-
+    written_desc_.update(in, conn_[in]->cn_wp().desc);
+    // publish all timeslices completed by an advance of the red lantern
+    uint64_t new_completely_written = written_desc_.min();
+    if (connected_ == conn_.size() &&
+        new_completely_written > completely_written_) {
       for (uint64_t tpos = completely_written_; tpos < new_completely_written;
            ++tpos) {
         if (!drop_) {
@@ -176,7 +170,7 @@ void TimesliceBuilder::on_completion(const struct ibv_wc& wc) {
               {{ts_index, tpos, timeslice_size_,
                 static_cast<uint32_t>(conn_.size())},
                timeslice_buffer_.get_data_size_exp(),
-               timeslice_buffer_.get_desc_size_exp()});
+               timeslice_buffer_.get_desc_size_exp(), 0, {}});
         } else {
           timeslice_buffer_.send_completion({tpos});
         }
@@ -5,6 +5,7 @@
 #include "IBConnectionGroup.hpp"
 #include "RingBuffer.hpp"
 #include "TimesliceBuffer.hpp"
+#include "TournamentTree.hpp"
 #include <csignal>
 
 /// Timeslice receiver and input node connection container class.
@@ -51,7 +52,10 @@ private:
 
   uint32_t timeslice_size_;
 
-  size_t red_lantern_ = 0;
+  /// Descriptor write positions of the input channels (minimum: red
+  /// lantern).
+  TournamentTree<uint64_t> written_desc_;
+
   uint64_t completely_written_ = 0;
   uint64_t acked_ = 0;
 
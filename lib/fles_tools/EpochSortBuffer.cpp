@@ -0,0 +1,30 @@
+#include "EpochSortBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace fles {
+
+std::unique_ptr<StorableMicroslice>
+EpochSortBuffer::extract_microslice(MicrosliceDescriptor desc, bool sort) {
+  constexpr std::size_t kuBytesPerMessage = sizeof(uint64_t);
+
+  // Messages mostly arrive in order, so avoid the merge sort if possible
+  if (sort && !std::is_sorted(entries_.begin(), entries_.end())) {
+    std::stable_sort(entries_.begin(), entries_.end());
+  }
+
+  std::vector<uint8_t> content(entries_.size() * kuBytesPerMessage);
+  uint8_t* dst = content.data();
+  for (const auto& entry : entries_) {
+    std::memcpy(dst, &entry.data, kuBytesPerMessage);
+    dst += kuBytesPerMessage;
+  }
+  entries_.clear();
+
+  desc.size = static_cast<uint32_t>(content.size());
+  return std::unique_ptr<StorableMicroslice>(
+      new StorableMicroslice(desc, std::move(content)));
+}
+
+} // namespace fles
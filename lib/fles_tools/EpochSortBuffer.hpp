@@ -0,0 +1,73 @@
+/// \file
+/// \brief Defines the fles::EpochSortBuffer class.
+#pragma once
+
+#include "MicrosliceDescriptor.hpp"
+#include "StorableMicroslice.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace fles {
+
+/**
+ * \brief Flat buffer collecting nDPB/gDPB messages of one or more epochs.
+ *
+ * Messages are stored together with their sort key (extended epoch, time
+ * within epoch, optional fine time) in a single contiguous array. On
+ * extraction, the messages are stably merge-sorted by this key, compared
+ * field by field, and written into the content of a new microslice in one
+ * allocation. Messages with equal key keep their input order.
+ *
+ * The key is not packed into a single integer: the extended epoch uses
+ * all 64 bits and the time alone takes up to 47 bits.
+ */
+class EpochSortBuffer {
+public:
+  /// Append a message with its sort key.
+  void add(uint64_t epoch, uint64_t time, uint64_t data, uint32_t fine = 0) {
+    entries_.push_back({epoch, time, fine, data});
+  }
+
+  /// Retrieve the number of buffered messages.
+  std::size_t size() const { return entries_.size(); }
+
+  /// Check if the buffer is empty.
+  bool empty() const { return entries_.empty(); }
+
+  /// Discard all buffered messages (the capacity is retained).
+  void clear() { entries_.clear(); }
+
+  /**
+   * \brief Create a microslice from the buffered messages.
+   *
+   * The messages are sorted by their key if `sort` is set, and copied in
+   * buffer order otherwise. The descriptor size is updated to match the
+   * content. The buffer is cleared afterwards.
+   */
+  std::unique_ptr<StorableMicroslice> extract_microslice(MicrosliceDescriptor desc,
+                                                         bool sort);
+
+private:
+  struct Entry {
+    uint64_t epoch;
+    uint64_t time;
+    uint32_t fine;
+    uint64_t data;
+
+    bool operator<(const Entry& other) const {
+      if (epoch != other.epoch) {
+        return epoch < other.epoch;
+      }
+      if (time != other.time) {
+        return time < other.time;
+      }
+      return fine < other.fine;
+    }
+  };
+
+  std::vector<Entry> entries_;
+};
+
+} // namespace fles
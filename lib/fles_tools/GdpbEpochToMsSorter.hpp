@@ -5,14 +5,13 @@
 ///        messages.
 #pragma once
 
+#include "EpochSortBuffer.hpp"
 #include "Filter.hpp"
 #include "Microslice.hpp"
 #include "StorableMicroslice.hpp"
 
 #include "rocMess_wGet4v1.h"
 
-#include <set>
-
 #pragma clang diagnostic ignored "-Wunused-private-field"
 
 namespace fles {
@@ -21,7 +20,7 @@ class GdpbEpochToMsSorter
     : public BufferingFilter<Microslice, StorableMicroslice> {
 public:
   GdpbEpochToMsSorter(uint32_t uEpPerMs = 1, uint64_t ulMaskGet4 = 0x0)
-      : BufferingFilter(), fuNbEpPerMs(uEpPerMs), fmsFullMsgBuffer(),
+      : BufferingFilter(), fuNbEpPerMs(uEpPerMs), fMsgBuffer(),
         fuNbEpInBuff(0), fbFirstEpFound(false), fuCurrentEpoch(0),
         fuCurrentEpochCycle(0), fulCurrentLongEpoch(0), fbFirstEp2Found(),
         fuCurrentEpoch2(), // All values initialized at 0!
@@ -30,13 +29,26 @@ public:
         fbAllFirstEp2Found(false), fbAllCurrentEp2Found(false),
         fulMaskGet4(ulMaskGet4){};
 
+  ~GdpbEpochToMsSorter() override;
+
+  /// Number of input microslices not containing only complete messages
+  uint64_t incomplete_microslices() const { return fulNbIncompleteMs; }
+  /// Number of ignored nDPB related messages
+  uint64_t ignored_messages() const { return fulNbIgnoredMsgs; }
+  /// Number of ignored messages with out of bound or masked chip ID
+  uint64_t rejected_chip_messages() const { return fulNbRejectedChipMsgs; }
+
 private:
   void process() override;
 
+  /// Compute the time sort key (time within epoch, fine time) of a message
+  static void sort_key(const ngdpb::Message& mess, uint64_t& ulTime,
+                       uint32_t& uFine);
+
   static const uint16_t kusMaxNbGet4 = 48; // 6 * 8 GET4s max per gDPB
 
   uint32_t fuNbEpPerMs;
-  std::multiset<ngdpb::FullMessage> fmsFullMsgBuffer;
+  EpochSortBuffer fMsgBuffer;
   uint32_t fuNbEpInBuff;
 
   bool fbFirstEpFound;
@@ -52,5 +64,9 @@ private:
   bool fbAllCurrentEp2Found;
 
   uint64_t fulMaskGet4;
+
+  uint64_t fulNbIncompleteMs = 0;
+  uint64_t fulNbIgnoredMsgs = 0;
+  uint64_t fulNbRejectedChipMsgs = 0;
 };
 } // namespace fles
@@ -1,6 +1,17 @@
 #include "NdpbEpochToMsSorter.hpp"
-
-#include <iomanip>
+#include "log.hpp"
+
+fles::NdpbEpochToMsSorter::~NdpbEpochToMsSorter() {
+  // Report the anomalies here instead of on the data path
+  if (0 < fulNbIncompleteMs)
+    L_(warning) << "fles::NdpbEpochToMsSorter: " << fulNbIncompleteMs
+                << " input microslice buffer(s) did NOT contain only complete "
+                   "nDPB messages!";
+  if (0 < fulNbIgnoredMsgs)
+    L_(warning) << "fles::NdpbEpochToMsSorter: ignored " << fulNbIgnoredMsgs
+                << " GET4 related message(s). "
+                << "Please check your data input to make sure this is OK !!!!";
+}
 
 void fles::NdpbEpochToMsSorter::process() {
   constexpr uint32_t kuBytesPerMessage = 8;
@@ -10,12 +21,10 @@ void fles::NdpbEpochToMsSorter::process() {
     auto msInput = input.front();
     this->input.pop_front();
 
-    // If not integer number of message in input buffer, print warning/error
+    // If not integer number of message in input buffer, count it for the
+    // final warning
     if (0 != (msInput->desc().size % kuBytesPerMessage))
-      std::cerr << "fles::NdpbEpochToMsSorter::process => Warning, "
-                << "the input microslice buffer does NOT contain only complete "
-                   "nDPB messages!"
-                << std::endl;
+      fulNbIncompleteMs++;
 
     // Compute the number of complete messages in the input microslice buffer
     uint32_t uNbMessages =
@@ -30,17 +39,10 @@ void fles::NdpbEpochToMsSorter::process() {
       uint64_t ulData = static_cast<uint64_t>(pInBuff[uIdx]);
       ngdpb::Message mess(ulData);
 
-      //         std::cout << " IN " << std::hex << std::setw(8) << ulData << "
-      //         "
-      //                   << std::dec << std::endl;
-
       if (true == mess.isEpoch2Msg() || true == mess.isGet4Msg() ||
           true == mess.isGet4SlCtrMsg() || true == mess.isGet4Hit32Msg() ||
           true == mess.isGet4SysMsg()) {
-        std::cout << "+++> Found a GET4 related message in "
-                     "NdpbEpochToMsSorter, ignoring it! "
-                  << "Please check your data input to make sure this is OK !!!!"
-                  << std::endl;
+        fulNbIgnoredMsgs++;
         continue;
       } // if gDPB related message
 
@@ -71,8 +73,6 @@ void fles::NdpbEpochToMsSorter::process() {
             // Update Ms index/start time from epoch value (later need the epoch
             // duration)
             desc.idx = fulCurrentLongEpoch - fuNbEpPerMs; // * kiEpochLengthNs
-            // Update Ms size
-            desc.size = fmsFullMsgBuffer.size();
             // Update the Format and version version
             // 0xE. for Experimental
             // 0x.0 for Raw data
@@ -83,102 +83,11 @@ void fles::NdpbEpochToMsSorter::process() {
             else
               desc.sys_ver = 0xE1;
 
-            // Convert the multiset of messages to a vector of bytes
-            std::vector<uint8_t> content;
-            if (true == fbMsgSorting)
-              for (auto itMess = fmsFullMsgBuffer.begin();
-                   itMess != fmsFullMsgBuffer.end(); itMess++) {
-                /* Wrong Endianness?!?
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0xFF00000000000000UL) >> 56) );
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0x00FF000000000000UL) >> 48) );
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0x0000FF0000000000UL) >> 40) );
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0x000000FF00000000UL) >> 32) );
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0x00000000FF000000UL) >> 24) );
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0x0000000000FF0000UL) >> 16) );
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0x000000000000FF00UL) >>  8) );
-                                     content.push_back( static_cast<uint8_t>(
-                   ((*itMess).getData() & 0x00000000000000FFUL)      ) );
-                */
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x00000000000000FFUL)));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x000000000000FF00UL) >> 8));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x0000000000FF0000UL) >> 16));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x00000000FF000000UL) >> 24));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x000000FF00000000UL) >> 32));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x0000FF0000000000UL) >> 40));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x00FF000000000000UL) >> 48));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0xFF00000000000000UL) >> 56));
-
-                /*
-                                     std::cout << std::hex <<
-                   (*itMess).getData() << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -8 ] ) << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -7 ] ) << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -6 ] ) << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -5 ] ) << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -4 ] ) << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -3 ] ) << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -2 ] ) << " "
-                                               << std::hex << static_cast<
-                   uint16_t>( content[ content.size() -1 ] ) << " "
-                                               << std::dec << std::endl;
-                */
-                //                     std::cout << std::hex << std::setw(8) <<
-                //                     (*itMess).getData() << " "
-                //                               << std::dec << std::endl;
-              } // for( auto itMess = fmsFullMsgBuffer.begin(); itMess <
-                // fmsFullMsgBuffer.end(); itMess++)
-            else
-              for (auto itMess = fvMsgBuffer.begin();
-                   itMess != fvMsgBuffer.end(); itMess++) {
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x00000000000000FFUL)));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x000000000000FF00UL) >> 8));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x0000000000FF0000UL) >> 16));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x00000000FF000000UL) >> 24));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x000000FF00000000UL) >> 32));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x0000FF0000000000UL) >> 40));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0x00FF000000000000UL) >> 48));
-                content.push_back(static_cast<uint8_t>(
-                    ((*itMess).getData() & 0xFF00000000000000UL) >> 56));
-              } // else for( auto itMess = fvMsgBuffer.begin(); itMess !=
-                // fvMsgBuffer.end(); itMess++)
-            std::unique_ptr<StorableMicroslice> sortedMs(
-                new StorableMicroslice(desc, content));
-            output.push(std::move(sortedMs));
-
-            // Re-initialize the sorting buffer
-            if (true == fbMsgSorting)
-              fmsFullMsgBuffer.clear();
-            else
-              fvMsgBuffer.clear();
+            // Sort the buffered messages (if enabled) and copy them into the
+            // output MS in one go, the MS size is updated accordingly
+            output.push(fMsgBuffer.extract_microslice(desc, fbMsgSorting));
+
+            // Re-initialize the epoch counter, buffer is empty after extraction
             fuNbEpInBuff = 0;
           } // if( fuNbEpPerMs == fuNbEpInBuff )
         }   // if( true == fbFirstEpFound )
@@ -189,17 +98,14 @@ void fles::NdpbEpochToMsSorter::process() {
       // If the first epoch was found, start saving messages in the sorting
       // buffer
       if (true == fbFirstEpFound) {
-        // If messages sorting enabled, do it with multiset and FullMessage "<"
-        // OP
-        if (true == fbMsgSorting) {
-          ngdpb::FullMessage fullmess(mess, fulCurrentLongEpoch);
-          fmsFullMsgBuffer.insert(fullmess);
-        } // if( true == fbMsgSorting )
-          // Otherwise the simpler "sorting by epoch" is done just by epoch
-          // definition!
-          // => vector is enough
+        // Sorting key is the same as for the FullMessage "<" OP: extended
+        // epoch, then message time with 1 epoch offset for the Last flag.
+        // Without sorting, the simpler "sorting by epoch" is done just by
+        // epoch definition and the key is not used.
+        if (true == fbMsgSorting)
+          fMsgBuffer.add(fulCurrentLongEpoch, mess.getMsgFullTime(1), ulData);
         else
-          fvMsgBuffer.push_back(mess);
+          fMsgBuffer.add(fulCurrentLongEpoch, 0, ulData);
       } // if( true == fbFirstEpFound )
     }   // for (uint32_t uIdx = 0; uIdx < uNbMessages; uIdx ++)
   }     // while (0 < this->input.size() )
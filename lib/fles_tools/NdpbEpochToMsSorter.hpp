@@ -4,15 +4,13 @@
 ///        use the epoch message as output MS delimiter and time sort messages.
 #pragma once
 
+#include "EpochSortBuffer.hpp"
 #include "Filter.hpp"
 #include "Microslice.hpp"
 #include "StorableMicroslice.hpp"
 
 #include "rocMess_wGet4v1.h"
 
-#include <set>
-#include <vector>
-
 namespace fles {
 
 class NdpbEpochToMsSorter
@@ -20,20 +18,29 @@ class NdpbEpochToMsSorter
 public:
   NdpbEpochToMsSorter(uint32_t uEpPerMs = 1, bool bSortMsgs = false)
       : BufferingFilter(), fuNbEpPerMs(uEpPerMs), fbMsgSorting(bSortMsgs),
-        fmsFullMsgBuffer(), fuNbEpInBuff(0), fbFirstEpFound(false),
+        fMsgBuffer(), fuNbEpInBuff(0), fbFirstEpFound(false),
         fuCurrentEpoch(0), fuCurrentEpochCycle(0), fulCurrentLongEpoch(0){};
 
+  ~NdpbEpochToMsSorter() override;
+
+  /// Number of input microslices not containing only complete messages
+  uint64_t incomplete_microslices() const { return fulNbIncompleteMs; }
+  /// Number of ignored GET4 (gDPB) related messages
+  uint64_t ignored_messages() const { return fulNbIgnoredMsgs; }
+
 private:
   void process() override;
 
   uint32_t fuNbEpPerMs;
   bool fbMsgSorting;
-  std::multiset<ngdpb::FullMessage> fmsFullMsgBuffer;
-  std::vector<ngdpb::Message> fvMsgBuffer;
+  EpochSortBuffer fMsgBuffer;
   uint32_t fuNbEpInBuff;
   bool fbFirstEpFound;
   uint32_t fuCurrentEpoch;
   uint32_t fuCurrentEpochCycle;
   uint64_t fulCurrentLongEpoch;
+
+  uint64_t fulNbIncompleteMs = 0;
+  uint64_t fulNbIgnoredMsgs = 0;
 };
 } // namespace fles
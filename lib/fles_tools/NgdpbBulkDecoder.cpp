@@ -0,0 +1,176 @@
+#include "NgdpbBulkDecoder.hpp"
+#include "rocMess_wGet4v1.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define NGDPB_HAVE_AVX2 1
+#include <immintrin.h>
+#else
+#define NGDPB_HAVE_AVX2 0
+#endif
+
+namespace ngdpb {
+
+namespace {
+
+void decode_scalar(const uint64_t* messages,
+                   std::size_t begin,
+                   std::size_t end,
+                   MessageBlock& block) {
+  for (std::size_t i = begin; i < end; ++i) {
+    Message mess(messages[i]);
+    uint32_t type = mess.getMessageType();
+    uint32_t epoch = 0;
+    uint32_t chip = 0;
+    uint32_t channel = 0;
+
+    switch (type) {
+    case MSG_HIT:
+      chip = mess.getNxNumber();
+      channel = mess.getNxChNum();
+      break;
+    case MSG_EPOCH:
+      epoch = mess.getEpochNumber();
+      break;
+    case MSG_SYNC:
+      channel = mess.getSyncChNum();
+      break;
+    case MSG_AUX:
+      channel = mess.getAuxChNum();
+      break;
+    case MSG_EPOCH2:
+      epoch = mess.getGdpbEpEpochNb();
+      chip = mess.getGdpbGenChipId();
+      break;
+    case MSG_GET4:
+    case MSG_GET4_32B:
+      chip = mess.getGdpbGenChipId();
+      channel = mess.getGdpbHitChanId();
+      break;
+    case MSG_GET4_SLC:
+    case MSG_GET4_SYS:
+      chip = mess.getGdpbGenChipId();
+      break;
+    default:
+      break;
+    }
+
+    block.type[i] = type;
+    block.epoch[i] = epoch;
+    block.chip[i] = chip;
+    block.channel[i] = channel;
+  }
+}
+
+#if NGDPB_HAVE_AVX2
+
+// Select `value` in all lanes where `type` equals `t`, keep `current`
+// otherwise.
+__attribute__((target("avx2"))) inline __m256i
+select_type(__m256i current, __m256i type, uint32_t t, __m256i value) {
+  __m256i match =
+      _mm256_cmpeq_epi32(type, _mm256_set1_epi32(static_cast<int>(t)));
+  return _mm256_blendv_epi8(current, value, match);
+}
+
+__attribute__((target("avx2"))) std::size_t
+decode_avx2(const uint64_t* messages, std::size_t count, MessageBlock& block) {
+  const __m256i mask2 = _mm256_set1_epi32(0x3);
+  const __m256i mask4 = _mm256_set1_epi32(0xF);
+  const __m256i mask6 = _mm256_set1_epi32(0x3F);
+  const __m256i mask7 = _mm256_set1_epi32(0x7F);
+  const __m256i mask31 = _mm256_set1_epi32(0x7FFFFFFF);
+  const __m256i zero = _mm256_setzero_si256();
+
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    // Load eight messages and split them into low and high 32 bit halves
+    __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(messages + i)));
+    __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(messages + i + 4)));
+    // [a0 a1 b0 b1 | a2 a3 b2 b3] -> [a0 a1 a2 a3 b0 b1 b2 b3]
+    __m256i lo = _mm256_permute4x64_epi64(
+        _mm256_castps_si256(_mm256_shuffle_ps(a, b, 0x88)), 0xD8);
+    __m256i hi = _mm256_permute4x64_epi64(
+        _mm256_castps_si256(_mm256_shuffle_ps(a, b, 0xDD)), 0xD8);
+
+    __m256i type = _mm256_and_si256(lo, mask4);
+
+    // Candidate fields for all message types
+    __m256i lo_6 = _mm256_srli_epi32(lo, 6);
+    __m256i nx_chip = _mm256_and_si256(lo_6, mask2);  // bits 6..7
+    __m256i aux_chan = _mm256_and_si256(lo_6, mask7); // bits 6..12
+    __m256i nx_chan = _mm256_srli_epi32(lo, 25);      // bits 25..31
+    __m256i gdpb_chip =                               // bits 42..47
+        _mm256_and_si256(_mm256_srli_epi32(hi, 10), mask6);
+    __m256i gdpb_chan = // bits 40..41
+        _mm256_and_si256(_mm256_srli_epi32(hi, 8), mask2);
+    __m256i epoch1 = _mm256_or_si256(_mm256_srli_epi32(lo, 8), // bits 8..39
+                                     _mm256_slli_epi32(hi, 24));
+    __m256i epoch2 = _mm256_and_si256( // bits 10..40
+        _mm256_or_si256(_mm256_srli_epi32(lo, 10), _mm256_slli_epi32(hi, 22)),
+        mask31);
+
+    __m256i epoch = select_type(zero, type, MSG_EPOCH, epoch1);
+    epoch = select_type(epoch, type, MSG_EPOCH2, epoch2);
+
+    // All gDPB message types (5, 6, 8, 9, 10) carry the GET4 chip ID
+    __m256i below = _mm256_cmpgt_epi32(_mm256_set1_epi32(MSG_EPOCH2), type);
+    __m256i above = _mm256_cmpgt_epi32(type, _mm256_set1_epi32(MSG_GET4_SYS));
+    __m256i is_gdpb = _mm256_andnot_si256(_mm256_or_si256(below, above),
+                                          _mm256_cmpeq_epi32(type, type));
+    is_gdpb = _mm256_andnot_si256(
+        _mm256_cmpeq_epi32(type, _mm256_set1_epi32(MSG_SYS)), is_gdpb);
+    __m256i chip = _mm256_and_si256(gdpb_chip, is_gdpb);
+    chip = select_type(chip, type, MSG_HIT, nx_chip);
+
+    __m256i channel = select_type(zero, type, MSG_HIT, nx_chan);
+    channel = select_type(channel, type, MSG_SYNC, nx_chip);
+    channel = select_type(channel, type, MSG_AUX, aux_chan);
+    channel = select_type(channel, type, MSG_GET4, gdpb_chan);
+    channel = select_type(channel, type, MSG_GET4_32B, gdpb_chan);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(block.type + i), type);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(block.epoch + i), epoch);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(block.chip + i), chip);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(block.channel + i), channel);
+  }
+  return i;
+}
+
+#endif
+
+} // namespace
+
+BulkDecoder::BulkDecoder() : use_avx2_(is_avx2_available()) {}
+
+BulkDecoder::BulkDecoder(bool use_avx2)
+    : use_avx2_(use_avx2 && is_avx2_available()) {}
+
+bool BulkDecoder::is_avx2_available() {
+#if NGDPB_HAVE_AVX2
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+std::size_t BulkDecoder::decode(const uint64_t* messages,
+                                std::size_t count,
+                                MessageBlock& block) const {
+  count = std::min(count, MessageBlock::capacity);
+
+  std::size_t done = 0;
+#if NGDPB_HAVE_AVX2
+  if (use_avx2_) {
+    done = decode_avx2(messages, count, block);
+  }
+#endif
+  decode_scalar(messages, done, count, block);
+
+  block.size = count;
+  return count;
+}
+
+} // namespace ngdpb
@@ -0,0 +1,66 @@
+/// \file
+/// \brief Defines the ngdpb::BulkDecoder class for block-wise message
+/// decoding.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ngdpb {
+
+/**
+ * \brief Decoded fields of a block of nDPB/gDPB messages.
+ *
+ * The fields are stored as a structure of arrays. Fields not defined for a
+ * message type are set to zero:
+ *  - epoch: epoch number of MSG_EPOCH (32 bit) and MSG_EPOCH2 (31 bit),
+ *  - chip: nXYTER number of MSG_HIT, GET4 chip ID of all gDPB messages,
+ *  - channel: channel of MSG_HIT, MSG_SYNC, MSG_AUX, MSG_GET4, MSG_GET4_32B.
+ */
+struct MessageBlock {
+  static constexpr std::size_t capacity = 256;
+
+  std::size_t size = 0;
+  uint32_t type[capacity];
+  uint32_t epoch[capacity];
+  uint32_t chip[capacity];
+  uint32_t channel[capacity];
+};
+
+/**
+ * \brief Block-wise message classifier and field extractor.
+ *
+ * Uses an AVX2 implementation if supported by the CPU (checked at runtime)
+ * and a scalar implementation based on ngdpb::Message otherwise. Both
+ * produce identical results.
+ */
+class BulkDecoder {
+public:
+  /// Construct decoder, choosing the fastest available implementation.
+  BulkDecoder();
+
+  /// Construct decoder, optionally forcing the scalar implementation.
+  explicit BulkDecoder(bool use_avx2);
+
+  /**
+   * \brief Decode a block of messages.
+   *
+   * Decodes at most MessageBlock::capacity messages of the `count` messages
+   * at `messages`. Returns the number of decoded messages, which is also
+   * stored in `block.size`.
+   */
+  std::size_t decode(const uint64_t* messages,
+                     std::size_t count,
+                     MessageBlock& block) const;
+
+  /// Check if the AVX2 implementation is used.
+  bool uses_avx2() const { return use_avx2_; }
+
+  /// Check if the CPU supports the AVX2 implementation.
+  static bool is_avx2_available();
+
+private:
+  bool use_avx2_;
+};
+
+} // namespace ngdpb
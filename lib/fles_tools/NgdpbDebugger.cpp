@@ -1,8 +1,10 @@
 // Copyright 2013-2015 Jan de Cuveland <cmail@cuveland.de>
 
 #include "NgdpbDebugger.hpp"
+#include "Utility.hpp"
 #include <algorithm>
 #include <boost/format.hpp>
+#include <sstream>
 
 #include "rocMess_wGet4v1.h"
 
@@ -133,3 +135,184 @@ std::ostream& NgdpbDump::write_to_stream(std::ostream& s) const {
 
   return s;
 }
+
+// ----------
+
+namespace {
+
+const char* message_type_name(std::size_t type) {
+  static const char* names[] = {"nop",      "hit",      "epoch",  "sync",
+                                "aux",      "epoch2",   "get4",   "sys",
+                                "get4_slc", "get4_32b", "get4_sys"};
+  if (type < sizeof(names) / sizeof(names[0])) {
+    return names[type];
+  }
+  return "unknown";
+}
+
+} // namespace
+
+NgdpbMicrosliceDumper::~NgdpbMicrosliceDumper() {
+  if (verbosity > 0) {
+    out << "Message statistics:\n"
+        << "  nop:      " << fuNbNop << "\n"
+        << "  hit:      " << fuNbHit << "\n"
+        << "  epoch:    " << fuNbEpoch << "\n"
+        << "  sync:     " << fuNbSync << "\n"
+        << "  aux:      " << fuNbAux << "\n"
+        << "  epoch2:   " << fuNbEpochG << "\n"
+        << "  get4:     " << fuNbGet4 << "\n"
+        << "  sys:      " << fuNbSys << "\n"
+        << "  get4_slc: " << fuNbGet4Slc << "\n"
+        << "  get4_32b: " << fuNbGet4_32 << "\n"
+        << "  get4_sys: " << fuNbGet4Sys << std::endl;
+  }
+}
+
+void NgdpbMicrosliceDumper::count_messages(const fles::Microslice& m) {
+  const uint64_t* messages = reinterpret_cast<const uint64_t*>(m.content());
+  std::size_t count = m.desc().size / sizeof(uint64_t);
+
+  while (count > 0) {
+    std::size_t n = decoder.decode(messages, count, block);
+    for (std::size_t i = 0; i < n; ++i) {
+      switch (block.type[i]) {
+      case ngdpb::MSG_NOP:
+        ++fuNbNop;
+        break;
+      case ngdpb::MSG_HIT:
+        ++fuNbHit;
+        break;
+      case ngdpb::MSG_EPOCH:
+        ++fuNbEpoch;
+        break;
+      case ngdpb::MSG_SYNC:
+        ++fuNbSync;
+        break;
+      case ngdpb::MSG_AUX:
+        ++fuNbAux;
+        break;
+      case ngdpb::MSG_EPOCH2:
+        ++fuNbEpochG;
+        break;
+      case ngdpb::MSG_GET4:
+        ++fuNbGet4;
+        break;
+      case ngdpb::MSG_SYS:
+        ++fuNbSys;
+        break;
+      case ngdpb::MSG_GET4_SLC:
+        ++fuNbGet4Slc;
+        break;
+      case ngdpb::MSG_GET4_32B:
+        ++fuNbGet4_32;
+        break;
+      case ngdpb::MSG_GET4_SYS:
+        ++fuNbGet4Sys;
+        break;
+      default:
+        break;
+      }
+    }
+    messages += n;
+    count -= n;
+  }
+}
+
+// ----------
+
+NgdpbMicrosliceMonitor::NgdpbMicrosliceMonitor(uint64_t arg_output_interval,
+                                               std::ostream& arg_out,
+                                               std::string arg_output_prefix)
+    : output_interval_(arg_output_interval), out_(arg_out),
+      output_prefix_(std::move(arg_output_prefix)) {}
+
+NgdpbMicrosliceMonitor::~NgdpbMicrosliceMonitor() {
+  out_ << output_prefix_ << statistics() << std::endl;
+  write_histograms();
+}
+
+void NgdpbMicrosliceMonitor::put(std::shared_ptr<const fles::Microslice> m) {
+  const uint64_t* messages = reinterpret_cast<const uint64_t*>(m->content());
+  std::size_t count = m->desc().size / sizeof(uint64_t);
+
+  while (count > 0) {
+    std::size_t n = decoder_.decode(messages, count, block_);
+    fill(block_);
+    messages += n;
+    count -= n;
+  }
+
+  ++microslice_count_;
+  if ((microslice_count_ % output_interval_) == 0) {
+    out_ << output_prefix_ << statistics() << std::endl;
+  }
+}
+
+void NgdpbMicrosliceMonitor::fill(const ngdpb::MessageBlock& b) {
+  for (std::size_t i = 0; i < b.size; ++i) {
+    uint32_t type = b.type[i];
+    ++type_count_[type];
+    switch (type) {
+    case ngdpb::MSG_HIT:
+      ++nx_hits_[b.chip[i] * num_nx_channels + b.channel[i]];
+      break;
+    case ngdpb::MSG_GET4:
+    case ngdpb::MSG_GET4_32B:
+      ++get4_hits_[b.chip[i] * num_get4_channels + b.channel[i]];
+      break;
+    case ngdpb::MSG_EPOCH:
+      if (epoch_seen_ && b.epoch[i] != last_epoch_ + 1) {
+        ++epoch_gaps_;
+      }
+      epoch_seen_ = true;
+      last_epoch_ = b.epoch[i];
+      break;
+    default:
+      break;
+    }
+  }
+  message_count_ += b.size;
+}
+
+std::string NgdpbMicrosliceMonitor::statistics() const {
+  std::stringstream s;
+  s << "microslices: " << microslice_count_ << ", messages: "
+    << human_readable_count(message_count_, true, "") << " (";
+  bool first = true;
+  for (std::size_t type = 0; type < num_types; ++type) {
+    if (type_count_[type] > 0) {
+      s << (first ? "" : ", ") << message_type_name(type) << ": "
+        << type_count_[type];
+      first = false;
+    }
+  }
+  s << ")";
+  if (epoch_gaps_ > 0) {
+    s << " [" << epoch_gaps_ << " epoch gaps]";
+  }
+  return s.str();
+}
+
+void NgdpbMicrosliceMonitor::write_histograms() const {
+  for (std::size_t chip = 0; chip < num_nx_chips; ++chip) {
+    uint64_t hits = 0;
+    std::size_t active = 0;
+    for (std::size_t ch = 0; ch < num_nx_channels; ++ch) {
+      uint64_t n = nx_hits_[chip * num_nx_channels + ch];
+      hits += n;
+      active += (n > 0) ? 1 : 0;
+    }
+    if (hits > 0) {
+      out_ << output_prefix_ << "nXYTER " << chip << ": " << hits
+           << " hits in " << active << " channels" << std::endl;
+    }
+  }
+  for (std::size_t chip = 0; chip < num_get4_chips; ++chip) {
+    const uint64_t* h = &get4_hits_[chip * num_get4_channels];
+    if (h[0] + h[1] + h[2] + h[3] > 0) {
+      out_ << output_prefix_ << "GET4 " << chip << ": " << h[0] << " " << h[1]
+           << " " << h[2] << " " << h[3] << " hits per channel" << std::endl;
+    }
+  }
+}
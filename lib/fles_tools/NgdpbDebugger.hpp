@@ -1,10 +1,13 @@
 // Copyright 2016 P.-A. Loizeau <p.-a.loizeau@gsi.de>
 #pragma once
 
+#include "NgdpbBulkDecoder.hpp"
 #include "Sink.hpp"
 #include "Timeslice.hpp"
 #include "TimesliceDebugger.hpp"
+#include <array>
 #include <ostream>
+#include <string>
 
 #pragma clang diagnostic ignored "-Wunused-private-field"
 
@@ -31,8 +34,13 @@ public:
   NgdpbMicrosliceDumper(std::ostream& arg_out, std::size_t arg_verbosity)
       : out(arg_out), verbosity(arg_verbosity){};
 
+  ~NgdpbMicrosliceDumper() override;
+
   void put(std::shared_ptr<const fles::Microslice> m) override {
     // Update run statistics
+    if (verbosity > 0) {
+      count_messages(*m);
+    }
     if (verbosity > 1) {
       // Dump content
       if (verbosity > 2) {
@@ -51,9 +59,14 @@ public:
   }
 
 private:
+  void count_messages(const fles::Microslice& m);
+
   std::ostream& out;
   std::size_t verbosity;
 
+  ngdpb::BulkDecoder decoder;
+  ngdpb::MessageBlock block;
+
   uint32_t fuNbNop = 0;
   uint32_t fuNbHit = 0;
   uint32_t fuNbEpoch = 0;
@@ -62,6 +75,79 @@ private:
   uint32_t fuNbEpochG = 0;
   uint32_t fuNbGet4 = 0;
   uint32_t fuNbSys = 0;
+  uint32_t fuNbGet4Slc = 0;
   uint32_t fuNbGet4_32 = 0;
   uint32_t fuNbGet4Sys = 0;
 };
+
+// ----------
+
+/**
+ * \brief Quick-look monitoring sink for nDPB/gDPB microslice streams.
+ *
+ * Accumulates message type, hit channel and epoch histograms using the
+ * block-wise ngdpb::BulkDecoder. A summary is written every
+ * `arg_output_interval` microslices and on destruction.
+ */
+class NgdpbMicrosliceMonitor : public fles::MicrosliceSink {
+public:
+  static constexpr std::size_t num_types = 16;
+  static constexpr std::size_t num_nx_chips = 4;
+  static constexpr std::size_t num_nx_channels = 128;
+  static constexpr std::size_t num_get4_chips = 64;
+  static constexpr std::size_t num_get4_channels = 4;
+
+  NgdpbMicrosliceMonitor(uint64_t arg_output_interval,
+                         std::ostream& arg_out,
+                         std::string arg_output_prefix = "");
+
+  ~NgdpbMicrosliceMonitor() override;
+
+  void put(std::shared_ptr<const fles::Microslice> m) override;
+
+  /// Retrieve a short summary of the accumulated statistics.
+  std::string statistics() const;
+
+  /// Retrieve the histogram of message types.
+  const std::array<uint64_t, num_types>& type_histogram() const {
+    return type_count_;
+  }
+
+  /// Retrieve the nDPB hit histogram, indexed by nXYTER * 128 + channel.
+  const std::array<uint64_t, num_nx_chips * num_nx_channels>&
+  nx_hit_histogram() const {
+    return nx_hits_;
+  }
+
+  /// Retrieve the GET4 hit histogram, indexed by chip * 4 + channel.
+  const std::array<uint64_t, num_get4_chips * num_get4_channels>&
+  get4_hit_histogram() const {
+    return get4_hits_;
+  }
+
+  /// Retrieve the number of epoch gaps (non-consecutive MSG_EPOCH numbers).
+  uint64_t epoch_gaps() const { return epoch_gaps_; }
+
+private:
+  void fill(const ngdpb::MessageBlock& b);
+
+  void write_histograms() const;
+
+  ngdpb::BulkDecoder decoder_;
+  ngdpb::MessageBlock block_;
+
+  uint64_t output_interval_ = UINT64_MAX;
+  std::ostream& out_;
+  std::string output_prefix_;
+
+  uint64_t microslice_count_ = 0;
+  uint64_t message_count_ = 0;
+
+  std::array<uint64_t, num_types> type_count_{};
+  std::array<uint64_t, num_nx_chips * num_nx_channels> nx_hits_{};
+  std::array<uint64_t, num_get4_chips * num_get4_channels> get4_hits_{};
+
+  bool epoch_seen_ = false;
+  uint32_t last_epoch_ = 0;
+  uint64_t epoch_gaps_ = 0;
+};
@@ -79,7 +79,7 @@ bool ngdpb::Message::operator<(const ngdpb::Message& other) const
    // Then find the timestamp of the current message
    if( MSG_GET4_32B == uOtherType  || MSG_GET4 == uOtherType )
    {
-      uOtherTs = ( this->getGdpbHitFullTs() ) / 20 + 512;
+      uOtherTs = ( other.getGdpbHitFullTs() ) / 20 + 512;
    } // if Hit GET4 message (24 or 32b)
    else if( MSG_GET4_SLC == uOtherType || MSG_GET4_SYS == uOtherType )
    {
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+/// Structure representing the first part of the reply to a timeslice
+/// component request. It is followed by `desc_parts` message parts with the
+/// microslice descriptors and `data_parts` message parts with the microslice
+/// data. A range is split into two parts where it wraps around the input
+/// ring buffer.
+struct ComponentReplyHeader {
+  uint64_t ts_index;
+  uint32_t desc_parts;
+  uint32_t data_parts;
+};
+
+/// Timeslice index of a request claiming the next unassigned timeslice
+/// (dynamic assignment). A reply with this index and no further parts
+/// signals that all timeslices have been assigned.
+constexpr uint64_t any_timeslice = UINT64_MAX;
@@ -1,10 +1,17 @@
 // Copyright 2012-2013, 2016 Jan de Cuveland <cmail@cuveland.de>
 
 #include "ComponentSenderZeromq.hpp"
+#include "ComponentReplyHeader.hpp"
+#include "LatencyTracer.hpp"
 #include "MicrosliceDescriptor.hpp"
 #include "Utility.hpp"
 #include "log.hpp"
 #include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 ComponentSenderZeromq::ComponentSenderZeromq(
     uint64_t input_index,
@@ -13,21 +20,25 @@ ComponentSenderZeromq::ComponentSenderZeromq(
     uint32_t timeslice_size,
     uint32_t overlap_size,
     uint32_t max_timeslice_number,
+    uint32_t num_compute_nodes,
     volatile sig_atomic_t* signal_status,
     void* zmq_context)
     : input_index_(input_index), data_source_(data_source),
       timeslice_size_(timeslice_size), overlap_size_(overlap_size),
       max_timeslice_number_(max_timeslice_number),
+      num_compute_nodes_(num_compute_nodes),
       signal_status_(signal_status),
       min_acked_({data_source.desc_buffer().size() / 4,
                   data_source.data_buffer().size() / 4}) {
   start_index_ = sent_ = acked_ = cached_acked_ = data_source.get_read_index();
+  fles::LatencyTracer::instance().set_timeslice_geometry(timeslice_size_,
+                                                         overlap_size_);
 
   size_t min_ack_buffer_size =
       (data_source_.desc_buffer().size() / timeslice_size_ + 1) * 2;
   ack_.alloc_with_size(min_ack_buffer_size);
 
-  socket_ = zmq_socket(zmq_context, ZMQ_REP);
+  socket_ = zmq_socket(zmq_context, ZMQ_ROUTER);
   assert(socket_);
   int timeout_ms = 500;
   int rc =
@@ -35,9 +46,17 @@ ComponentSenderZeromq::ComponentSenderZeromq(
   assert(rc == 0);
   rc = zmq_setsockopt(socket_, ZMQ_SNDTIMEO, &timeout_ms, sizeof timeout_ms);
   assert(rc == 0);
+  // report unroutable replies instead of silently dropping zero-copy data
+  int mandatory = 1;
+  rc = zmq_setsockopt(socket_, ZMQ_ROUTER_MANDATORY, &mandatory,
+                      sizeof mandatory);
+  assert(rc == 0);
 
   rc = zmq_bind(socket_, listen_address.c_str());
   assert(rc == 0);
+
+  ack_event_fd_ = eventfd(0, EFD_NONBLOCK);
+  assert(ack_event_fd_ != -1);
 }
 
 ComponentSenderZeromq::~ComponentSenderZeromq() {
@@ -45,11 +64,15 @@ ComponentSenderZeromq::~ComponentSenderZeromq() {
     int rc = zmq_close(socket_);
     assert(rc == 0);
   }
+  if (ack_event_fd_ != -1) {
+    close(ack_event_fd_);
+  }
 }
 
 void ComponentSenderZeromq::operator()() {
   run_begin();
-  while (acked_ts2_ / 2 < max_timeslice_number_ && *signal_status_ == 0) {
+  while ((acked_ts2_ / 2 < max_timeslice_number_ || !claims_finished()) &&
+         *signal_status_ == 0) {
     run_cycle();
     scheduler_.timer();
   }
@@ -63,77 +86,233 @@ void ComponentSenderZeromq::run_begin() {
 }
 
 bool ComponentSenderZeromq::run_cycle() {
-  zmq_msg_t request;
-  int rc = zmq_msg_init(&request);
-  assert(rc == 0);
-
-  int len = zmq_msg_recv(&request, socket_, 0);
-  if (len == -1 && errno == EAGAIN) {
-    // timeout reached
-    return true;
+  // the input buffer cannot signal new data, so poll it briefly while
+  // requests are waiting
+  long timeout_ms = (pending_.empty() && claims_.empty()) ? 500 : 1;
+  zmq_pollitem_t items[] = {{socket_, 0, ZMQ_POLLIN, 0},
+                            {nullptr, ack_event_fd_, ZMQ_POLLIN, 0}};
+  int rc = zmq_poll(items, 2, timeout_ms);
+  assert(rc != -1 || errno == EINTR);
+  if (rc > 0 && (items[1].revents & ZMQ_POLLIN) != 0) {
+    handle_released_acks();
+  }
+  if (rc > 0 && (items[0].revents & ZMQ_POLLIN) != 0) {
+    receive_requests();
   }
-  assert(len != -1);
-
-  assert(len == sizeof(uint64_t));
-  uint64_t timeslice = *static_cast<uint64_t*>(zmq_msg_data(&request));
-  zmq_msg_close(&request);
 
-  try_send_timeslice(timeslice);
   data_source_.proceed();
+  serve_pending_requests();
+  serve_claims();
 
   return true;
 }
 
+void ComponentSenderZeromq::receive_requests() {
+  for (;;) {
+    zmq_msg_t identity;
+    int rc = zmq_msg_init(&identity);
+    assert(rc == 0);
+    int len = zmq_msg_recv(&identity, socket_, ZMQ_DONTWAIT);
+    if (len == -1) {
+      zmq_msg_close(&identity);
+      return;
+    }
+    bool more = zmq_msg_more(&identity) != 0;
+    std::string peer(static_cast<char*>(zmq_msg_data(&identity)),
+                     zmq_msg_size(&identity));
+    zmq_msg_close(&identity);
+
+    zmq_msg_t request;
+    rc = zmq_msg_init(&request);
+    assert(rc == 0);
+    len = more ? zmq_msg_recv(&request, socket_, 0) : -1;
+    if (len != sizeof(uint64_t)) {
+      zmq_msg_close(&request);
+      L_(error) << "[i" << input_index_ << "] invalid request received";
+      throw std::runtime_error("zeromq receive failed");
+    }
+    uint64_t timeslice = *static_cast<uint64_t*>(zmq_msg_data(&request));
+    zmq_msg_close(&request);
+
+    if (timeslice == any_timeslice) {
+      claims_received_ = true;
+      claims_.push_back(peer);
+    } else {
+      assert(pending_.count(timeslice) == 0);
+      pending_[timeslice] = peer;
+    }
+  }
+}
+
+void ComponentSenderZeromq::serve_pending_requests() {
+  // components become available in order of their timeslice index
+  while (!pending_.empty() && timeslice_available(pending_.begin()->first)) {
+    uint64_t ts = pending_.begin()->first;
+    if (!send_timeslice(pending_.begin()->second, ts)) {
+      // the component may already be acknowledged, it cannot be resent
+      on_send_failed("timeslice " + std::to_string(ts));
+      return;
+    }
+    pending_.erase(pending_.begin());
+  }
+}
+
+void ComponentSenderZeromq::serve_claims() {
+  while (!claims_.empty() && next_unassigned_ < max_timeslice_number_ &&
+         timeslice_available(next_unassigned_)) {
+    if (!send_timeslice(claims_.front(), next_unassigned_)) {
+      on_send_failed("timeslice " + std::to_string(next_unassigned_));
+      return;
+    }
+    claims_.pop_front();
+    ++next_unassigned_;
+  }
+  if (next_unassigned_ >= max_timeslice_number_) {
+    for (const auto& peer : claims_) {
+      if (!send_end_of_assignment(peer)) {
+        on_send_failed("end of assignment");
+        return;
+      }
+    }
+    claims_.clear();
+  }
+}
+
 void ComponentSenderZeromq::run_end() {
+  handle_released_acks();
   sync_data_source();
   time_end_ = std::chrono::high_resolution_clock::now();
 }
 
-struct Acknowledgment {
+struct ComponentSenderZeromq::Acknowledgment {
+  Acknowledgment(ComponentSenderZeromq* s, uint64_t ts, bool d, int n)
+      : server(s), timeslice(ts), is_data(d), parts(n) {}
   ComponentSenderZeromq* server;
   uint64_t timeslice;
   bool is_data;
+  /// Number of message parts referencing the data not yet released
+  std::atomic<int> parts;
+  /// Next entry in the list of released acknowledgments
+  Acknowledgment* next = nullptr;
 };
 
 void free_ts(void* /* data */, void* hint) {
   assert(hint);
-  auto* ack = static_cast<Acknowledgment*>(hint);
-  ack->server->ack_timeslice(ack->timeslice, ack->is_data);
-  delete ack;
+  auto* ack = static_cast<ComponentSenderZeromq::Acknowledgment*>(hint);
+  if (ack->parts.fetch_sub(1) == 1) {
+    ack->server->push_released_ack(ack);
+  }
+}
+
+void ComponentSenderZeromq::push_released_ack(Acknowledgment* ack) {
+  Acknowledgment* head = released_acks_.load(std::memory_order_relaxed);
+  do {
+    ack->next = head;
+  } while (!released_acks_.compare_exchange_weak(
+      head, ack, std::memory_order_release, std::memory_order_relaxed));
+  if (head == nullptr) {
+    // list was empty, the sender thread may be waiting
+    uint64_t one = 1;
+    ssize_t rc = write(ack_event_fd_, &one, sizeof(one));
+    (void)rc;
+  }
 }
 
-bool ComponentSenderZeromq::try_send_timeslice(uint64_t ts) {
+void ComponentSenderZeromq::handle_released_acks() {
+  uint64_t count;
+  ssize_t rc = read(ack_event_fd_, &count, sizeof(count));
+  (void)rc;
+  Acknowledgment* ack =
+      released_acks_.exchange(nullptr, std::memory_order_acquire);
+  while (ack != nullptr) {
+    Acknowledgment* next = ack->next;
+    ack_timeslice(ack->timeslice, ack->is_data);
+    delete ack;
+    ack = next;
+  }
+}
+
+bool ComponentSenderZeromq::send_part(zmq_msg_t& msg, int flags) {
+  int rc;
+  do {
+    rc = zmq_msg_send(&msg, socket_, flags);
+  } while (rc == -1 && errno == EAGAIN && *signal_status_ == 0);
+  if (rc == -1) {
+    send_errno_ = errno;
+    // message is not consumed on failure, release (and acknowledge) it
+    zmq_msg_close(&msg);
+    return false;
+  }
+  return true;
+}
+
+void ComponentSenderZeromq::on_send_failed(const std::string& what) {
+  if (*signal_status_ != 0) {
+    // interrupted, the run is ending anyway
+    return;
+  }
+  // with ZMQ_ROUTER_MANDATORY, e.g., the compute node is not connected
+  L_(error) << "[i" << input_index_ << "] sending " << what
+            << " failed: " << zmq_strerror(send_errno_);
+  throw std::runtime_error("zeromq send failed");
+}
+
+bool ComponentSenderZeromq::send_end_of_assignment(const std::string& peer) {
+  finished_peers_.insert(peer);
+
+  zmq_msg_t identity;
+  zmq_msg_init_size(&identity, peer.size());
+  std::copy(peer.begin(), peer.end(),
+            static_cast<char*>(zmq_msg_data(&identity)));
+  if (!send_part(identity, ZMQ_SNDMORE)) {
+    return false;
+  }
+
+  zmq_msg_t msg;
+  zmq_msg_init_size(&msg, sizeof(ComponentReplyHeader));
+  *static_cast<ComponentReplyHeader*>(zmq_msg_data(&msg)) = {any_timeslice, 0,
+                                                              0};
+  return send_part(msg, 0);
+}
+
+bool ComponentSenderZeromq::timeslice_available(uint64_t ts) {
+  uint64_t desc_end = (ts + 1) * timeslice_size_ + overlap_size_ +
+                      start_index_.desc;
+  if (write_index_desc_ < desc_end) {
+    write_index_desc_ = data_source_.get_write_index().desc;
+  }
+  return write_index_desc_ >= desc_end;
+}
+
+bool ComponentSenderZeromq::send_timeslice(const std::string& peer,
+                                           uint64_t ts) {
   assert(ts >= acked_ts2_ / 2);
 
   uint64_t desc_offset = ts * timeslice_size_ + start_index_.desc;
   uint64_t desc_length = timeslice_size_ + overlap_size_;
 
-  // check if complete timeslice is available in the input buffer
-  if (write_index_desc_ < desc_offset + desc_length) {
-    data_source_.proceed();
-    write_index_desc_ = data_source_.get_write_index().desc;
-    if (write_index_desc_ < desc_offset + desc_length) {
-      // send empty message
-      zmq_msg_t msg;
-      zmq_msg_init_size(&msg, 0);
-      int rc;
-      do {
-        rc = zmq_msg_send(&msg, socket_, 0);
-      } while (rc == -1 && errno == EAGAIN && *signal_status_ == 0);
-      return false;
-    }
-  }
+  // routing identity, header, up to two parts each for descriptors and data
+  zmq_msg_t parts[6];
+  uint32_t n = 0;
+  zmq_msg_init_size(&parts[n], peer.size());
+  std::copy(peer.begin(), peer.end(),
+            static_cast<char*>(zmq_msg_data(&parts[n])));
+  ++n;
+
+  // part 0: header
+  zmq_msg_init_size(&parts[n], sizeof(ComponentReplyHeader));
+  auto* header = static_cast<ComponentReplyHeader*>(zmq_msg_data(&parts[n]));
+  header->ts_index = ts;
+  ++n;
 
   // part 1: descriptors
   if (desc_offset + desc_length > sent_.desc) {
     sent_.desc = desc_offset + desc_length;
   }
-  auto desc_msg = create_message(data_source_.desc_buffer(), desc_offset,
-                                 desc_length, ts, false);
-  int rc;
-  do {
-    rc = zmq_msg_send(&desc_msg, socket_, ZMQ_SNDMORE);
-  } while (rc == -1 && errno == EAGAIN && *signal_status_ == 0);
+  fles::trace(fles::TraceStage::SenderStart, ts);
+  header->desc_parts = create_message(data_source_.desc_buffer(), desc_offset,
+                                      desc_length, ts, false, &parts[n]);
+  n += header->desc_parts;
 
   // part 2: data
   uint64_t data_offset = data_source_.desc_buffer().at(desc_offset).offset;
@@ -146,51 +325,62 @@ bool ComponentSenderZeromq::try_send_timeslice(uint64_t ts) {
   if (data_offset + data_length > sent_.data) {
     sent_.data = data_offset + data_length;
   }
-  auto data_msg = create_message(data_source_.data_buffer(), data_offset,
-                                 data_length, ts, true);
-  do {
-    rc = zmq_msg_send(&data_msg, socket_, 0);
-  } while (rc == -1 && errno == EAGAIN && *signal_status_ == 0);
+  header->data_parts = create_message(data_source_.data_buffer(), data_offset,
+                                      data_length, ts, true, &parts[n]);
+  n += header->data_parts;
+
+  // a failed part releases all remaining parts
+  bool ok = true;
+  for (uint32_t i = 0; i < n; ++i) {
+    if (ok) {
+      ok = send_part(parts[i], (i + 1 < n) ? ZMQ_SNDMORE : 0);
+    } else {
+      zmq_msg_close(&parts[i]);
+    }
+  }
 
-  return true;
+  return ok;
 }
 
 template <typename T_>
-zmq_msg_t ComponentSenderZeromq::create_message(RingBufferView<T_>& buf,
-                                                uint64_t offset,
-                                                uint64_t length,
-                                                uint64_t ts,
-                                                bool is_data) {
-  zmq_msg_t msg;
-
+uint32_t ComponentSenderZeromq::create_message(RingBufferView<T_>& buf,
+                                               uint64_t offset,
+                                               uint64_t length,
+                                               uint64_t ts,
+                                               bool is_data,
+                                               zmq_msg_t* msg) {
   if (length == 0) {
     // zero chunks
-    zmq_msg_init_size(&msg, 0);
+    zmq_msg_init_size(&msg[0], 0);
     ack_timeslice(ts, is_data);
-  } else if ((offset & buf.size_mask()) <=
-             ((offset + length - 1) & buf.size_mask())) {
+    return 1;
+  }
+
+  if ((offset & buf.size_mask()) <=
+      ((offset + length - 1) & buf.size_mask())) {
     // one chunk
     auto* data = &buf.at(offset);
     size_t bytes = sizeof(T_) * length;
-    auto* hint = new Acknowledgment{this, ts, is_data};
-    zmq_msg_init_data(&msg, data, bytes, free_ts, hint);
-  } else {
-    // two chunks
-    auto* data1 = &buf.at(offset);
-    size_t size1 = buf.size() - (offset & buf.size_mask());
-    auto* data2 = buf.ptr();
-    size_t size2 = length - buf.size() + (offset & buf.size_mask());
-    zmq_msg_init_size(&msg, (size1 + size2) * sizeof(T_));
-    auto msg_buf = static_cast<T_*>(zmq_msg_data(&msg));
-    std::copy_n(data1, size1, msg_buf);
-    std::copy_n(data2, size2, msg_buf + size1);
-    ack_timeslice(ts, is_data);
+    auto* hint = new Acknowledgment(this, ts, is_data, 1);
+    zmq_msg_init_data(&msg[0], data, bytes, free_ts, hint);
+    return 1;
   }
 
-  return msg;
+  // two chunks, acknowledged when both have been released
+  auto* data1 = &buf.at(offset);
+  size_t size1 = buf.size() - (offset & buf.size_mask());
+  auto* data2 = buf.ptr();
+  size_t size2 = length - size1;
+  auto* hint = new Acknowledgment(this, ts, is_data, 2);
+  zmq_msg_init_data(&msg[0], data1, size1 * sizeof(T_), free_ts, hint);
+  zmq_msg_init_data(&msg[1], data2, size2 * sizeof(T_), free_ts, hint);
+  return 2;
 }
 
 void ComponentSenderZeromq::ack_timeslice(uint64_t ts, bool is_data) {
+  if (is_data) {
+    fles::trace(fles::TraceStage::TransferComplete, ts);
+  }
   // use ts2 and acked_ts2_ to handle desc and data sequentially
   uint64_t ts2 = ts * 2 + (is_data ? 1 : 0);
   assert(ts2 >= acked_ts2_);
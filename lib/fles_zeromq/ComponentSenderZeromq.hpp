@@ -4,15 +4,36 @@
 #include "DualRingBuffer.hpp"
 #include "RingBuffer.hpp"
 #include "Scheduler.hpp"
+#include <atomic>
 #include <boost/format.hpp>
 #include <cassert>
 #include <csignal>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
 #include <zmq.h>
 
 /// Input buffer and compute node connection container class.
 /** An ComponentSenderZeromq object represents an input buffer (filled by a
     FLIB) and a group of timeslice building connections to compute
-    nodes. */
+    nodes.
+
+    Requests of several compute nodes may be outstanding at the same time.
+    Each request is answered with a ComponentReplyHeader followed by the
+    descriptor and data parts as soon as the component is available in the
+    input buffer. The parts reference the input buffer without copying.
+
+    For dynamic timeslice assignment, compute nodes claim timeslices at
+    one input node (the first) instead of requesting fixed indexes. Each
+    claim is answered with the next unassigned timeslice as it becomes
+    available, so every timeslice is assigned to exactly one compute node
+    and compute nodes with free buffer space receive more timeslices.
+
+    ZeroMQ releases these parts on one of its I/O threads (or, for inproc
+    transport, on the receiving thread). The release callback only pushes
+    the acknowledgment to a lock-free queue and wakes the sender thread,
+    which alone updates the acknowledgment state and the read indexes. */
 
 class ComponentSenderZeromq {
 public:
@@ -23,6 +44,7 @@ public:
                         uint32_t timeslice_size,
                         uint32_t overlap_size,
                         uint32_t max_timeslice_number,
+                        uint32_t num_compute_nodes,
                         volatile sig_atomic_t* signal_status,
                         void* zmq_context);
 
@@ -37,6 +59,8 @@ public:
 
   friend void free_ts(void* data, void* hint);
 
+  struct Acknowledgment;
+
 private:
   /// This component's index in the list of input components.
   uint64_t input_index_;
@@ -53,15 +77,43 @@ private:
   /// Number of timeslices after which this run shall end.
   const uint32_t max_timeslice_number_;
 
+  /// Number of compute nodes.
+  const uint32_t num_compute_nodes_;
+
   /// Pointer to global signal status variable.
   volatile sig_atomic_t* signal_status_;
 
   /// ZeroMQ socket.
   void* socket_;
 
+  /// Requests waiting for their component to become available (timeslice
+  /// index to identity of the requesting compute node).
+  std::map<uint64_t, std::string> pending_;
+
+  /// Identities of compute nodes waiting for a timeslice assignment, in
+  /// order of their claims.
+  std::deque<std::string> claims_;
+
+  /// Index of the next unassigned timeslice.
+  uint64_t next_unassigned_ = 0;
+
+  /// Whether any compute node has claimed a timeslice (dynamic assignment).
+  bool claims_received_ = false;
+
+  /// Identities of compute nodes notified that all timeslices are assigned.
+  std::set<std::string> finished_peers_;
+
   /// Buffer to store acknowledged status of timeslices.
   RingBuffer<uint64_t, true> ack_;
 
+  /// Acknowledgments released by other threads (lock-free LIFO list,
+  /// multiple producers, consumed as a whole by the sender thread).
+  std::atomic<Acknowledgment*> released_acks_{nullptr};
+
+  /// Event file descriptor to wake the sender thread on released
+  /// acknowledgments.
+  int ack_event_fd_ = -1;
+
   /// Number of acknowledged timeslices (times two - desc and data).
   uint64_t acked_ts2_ = 0;
 
@@ -89,6 +141,9 @@ private:
   /// Amount of data sent (for performance statistics).
   DualIndex sent_;
 
+  /// Error number of the last failed send.
+  int send_errno_ = 0;
+
   struct SendBufferStatus {
     std::chrono::system_clock::time_point time;
     uint64_t size;
@@ -156,16 +211,51 @@ private:
   /// Cleanup at end of run.
   void run_end();
 
+  /// Receive all queued requests from compute nodes.
+  void receive_requests();
+
+  /// Answer all pending requests whose components are available.
+  void serve_pending_requests();
+
+  /// Assign available timeslices to claiming compute nodes.
+  void serve_claims();
+
+  /// Check if all compute nodes have been notified that all timeslices are
+  /// assigned (dynamic assignment only).
+  bool claims_finished() const {
+    return !claims_received_ || finished_peers_.size() >= num_compute_nodes_;
+  }
+
+  /// Check if a complete timeslice component is available.
+  bool timeslice_available(uint64_t timeslice);
+
   /// The central function for distributing timeslice data.
-  bool try_send_timeslice(uint64_t timeslice);
+  bool send_timeslice(const std::string& peer, uint64_t timeslice);
+
+  /// Notify a claiming compute node that all timeslices are assigned.
+  bool send_end_of_assignment(const std::string& peer);
+
+  /// Send a message part, retrying until sent or interrupted.
+  bool send_part(zmq_msg_t& msg, int flags);
+
+  /// Handle a failed reply, throws unless interrupted by a signal.
+  void on_send_failed(const std::string& what);
 
-  /// Create zeromq message part with requested data.
+  /// Create zeromq message parts with requested data, return the number of
+  /// parts (two if the range wraps around the buffer, otherwise one).
   template <typename T_>
-  zmq_msg_t create_message(RingBufferView<T_>& buf,
-                           uint64_t offset,
-                           uint64_t length,
-                           uint64_t ts,
-                           bool is_data);
+  uint32_t create_message(RingBufferView<T_>& buf,
+                          uint64_t offset,
+                          uint64_t length,
+                          uint64_t ts,
+                          bool is_data,
+                          zmq_msg_t* msg);
+
+  /// Queue an acknowledgment released by any thread (thread-safe).
+  void push_released_ack(Acknowledgment* ack);
+
+  /// Process all queued acknowledgments (sender thread only).
+  void handle_released_acks();
 
   /// Update read indexes after timeslice has been sent.
   void ack_timeslice(uint64_t ts, bool is_data);
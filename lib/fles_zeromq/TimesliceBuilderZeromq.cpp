@@ -1,13 +1,17 @@
 // Copyright 2013, 2016 Jan de Cuveland <cmail@cuveland.de>
 
 #include "TimesliceBuilderZeromq.hpp"
+#include "ComponentReplyHeader.hpp"
+#include "LatencyTracer.hpp"
 #include "MicrosliceDescriptor.hpp"
 #include "TimesliceCompletion.hpp"
 #include "TimesliceWorkItem.hpp"
 #include "Utility.hpp"
 #include "log.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
-#include <thread>
+#include <stdexcept>
 
 TimesliceBuilderZeromq::TimesliceBuilderZeromq(
     uint64_t compute_index,
@@ -16,20 +20,24 @@ TimesliceBuilderZeromq::TimesliceBuilderZeromq(
     uint32_t num_compute_nodes,
     uint32_t timeslice_size,
     uint32_t max_timeslice_number,
+    uint32_t max_requests,
+    bool dynamic_assignment,
     volatile sig_atomic_t* signal_status,
     void* zmq_context)
     : compute_index_(compute_index), timeslice_buffer_(timeslice_buffer),
       input_server_addresses_(input_server_addresses),
       num_compute_nodes_(num_compute_nodes), timeslice_size_(timeslice_size),
       max_timeslice_number_(max_timeslice_number),
-      signal_status_(signal_status), ts_index_(compute_index_),
+      max_requests_(std::max(max_requests, 1u)),
+      dynamic_assignment_(dynamic_assignment), signal_status_(signal_status),
       ack_(timeslice_buffer_.get_desc_size_exp()) {
   for (size_t i = 0; i < input_server_addresses_.size(); ++i) {
     auto input_server_address = input_server_addresses_.at(i);
 
     std::unique_ptr<Connection> c(new Connection{timeslice_buffer_, i});
+    c->claims = dynamic_assignment_ && i == 0;
 
-    c->socket = zmq_socket(zmq_context, ZMQ_REQ);
+    c->socket = zmq_socket(zmq_context, ZMQ_DEALER);
     assert(c->socket);
     int timeout_ms = 500;
     int rc =
@@ -38,10 +46,14 @@ TimesliceBuilderZeromq::TimesliceBuilderZeromq(
     rc =
         zmq_setsockopt(c->socket, ZMQ_SNDTIMEO, &timeout_ms, sizeof timeout_ms);
     assert(rc == 0);
+    int linger_ms = 0;
+    rc = zmq_setsockopt(c->socket, ZMQ_LINGER, &linger_ms, sizeof linger_ms);
+    assert(rc == 0);
 
     rc = zmq_connect(c->socket, input_server_address.c_str());
     assert(rc == 0);
 
+    poll_items_.push_back({c->socket, 0, ZMQ_POLLIN, 0});
     connections_.push_back(std::move(c));
   }
 }
@@ -57,7 +69,7 @@ TimesliceBuilderZeromq::~TimesliceBuilderZeromq() {
 
 void TimesliceBuilderZeromq::operator()() {
   run_begin();
-  while (ts_index_ < max_timeslice_number_ && *signal_status_ == 0) {
+  while (!finished() && *signal_status_ == 0) {
     run_cycle();
     scheduler_.timer();
   }
@@ -71,94 +83,201 @@ void TimesliceBuilderZeromq::run_begin() {
 }
 
 bool TimesliceBuilderZeromq::run_cycle() {
-  auto& c = connections_.at(conn_);
-
-  std::size_t msg_size;
+  // keep requests outstanding at all input servers
+  for (auto& c : connections_) {
+    if (!send_requests(*c)) {
+      return true;
+    }
+  }
 
-  // send request for timeslice data
-  int rc;
-  do {
-    rc = zmq_send(c->socket, &ts_index_, sizeof(ts_index_), 0);
-  } while (rc == -1 && errno == EAGAIN && *signal_status_ == 0);
-  if (*signal_status_ != 0) {
+  // without any outstanding request, wait for buffer space to be freed
+  bool outstanding = false;
+  bool space_blocked = false;
+  for (auto& c : connections_) {
+    outstanding = outstanding || !c->requested.empty();
+    space_blocked = space_blocked ||
+                    (has_next_request(*c) &&
+                     c->request_tpos >= acked_ + c->desc.size());
+  }
+  if (!outstanding) {
+    handle_timeslice_completions(std::chrono::milliseconds(100));
     return true;
   }
 
-  // receive desc answer (part 1), do not release
-  rc = zmq_msg_init(&c->desc_msg);
-  assert(rc == 0);
-  do {
-    rc = zmq_msg_recv(&c->desc_msg, c->socket, 0);
-  } while (rc == -1 && errno == EAGAIN && *signal_status_ == 0);
-  if (*signal_status_ != 0) {
+  // completions cannot be polled together with the sockets, so look for
+  // them frequently while requests are held back for lack of space
+  long timeout_ms = space_blocked ? 1 : 100;
+  int rc = zmq_poll(poll_items_.data(), static_cast<int>(poll_items_.size()),
+                    timeout_ms);
+  if (rc == -1) {
+    assert(errno == EINTR);
     return true;
   }
-  assert(rc != -1);
-  msg_size = zmq_msg_size(&c->desc_msg);
-  if (msg_size == 0) {
-    zmq_msg_close(&c->desc_msg);
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  for (size_t i = 0; i < connections_.size(); ++i) {
+    if ((poll_items_[i].revents & ZMQ_POLLIN) != 0) {
+      while (receive_reply(*connections_[i]) && *signal_status_ == 0) {
+      }
+    }
   }
 
-  if (msg_size == 0 || *signal_status_ != 0) {
-    return true;
+  handle_timeslice_completions();
+  send_work_items();
+
+  return true;
+}
+
+bool TimesliceBuilderZeromq::send_requests(Connection& c) {
+  while (c.requested.size() < max_requests_ && may_request(c)) {
+    uint64_t ts = c.claims ? any_timeslice : ts_index(c.request_tpos);
+    if (!send_request(c, ts)) {
+      return false;
+    }
+    ++c.request_tpos;
   }
+  return true;
+}
 
-  // receive data answer (part 2), do not release
-  assert(zmq_msg_more(&c->desc_msg));
-  rc = zmq_msg_init(&c->data_msg);
-  assert(rc == 0);
+bool TimesliceBuilderZeromq::send_request(Connection& c, uint64_t ts) {
+  int rc;
   do {
-    rc = zmq_msg_recv(&c->data_msg, c->socket, 0);
+    rc = zmq_send(c.socket, &ts, sizeof(ts), 0);
   } while (rc == -1 && errno == EAGAIN && *signal_status_ == 0);
-  if (*signal_status_ != 0) {
-    return true;
+  if (rc == -1) {
+    return false;
+  }
+  c.requested.push_back(ts);
+  return true;
+}
+
+bool TimesliceBuilderZeromq::receive_reply(Connection& c) {
+  // part 0: header
+  zmq_msg_t header_msg;
+  int rc = zmq_msg_init(&header_msg);
+  assert(rc == 0);
+  rc = zmq_msg_recv(&header_msg, c.socket, ZMQ_DONTWAIT);
+  if (rc == -1) {
+    zmq_msg_close(&header_msg);
+    return false;
+  }
+  if (rc != sizeof(ComponentReplyHeader)) {
+    zmq_msg_close(&header_msg);
+    invalid_reply("unexpected header size");
+  }
+  ComponentReplyHeader header =
+      *static_cast<ComponentReplyHeader*>(zmq_msg_data(&header_msg));
+  uint64_t ts = header.ts_index;
+  bool more = zmq_msg_more(&header_msg) != 0;
+  zmq_msg_close(&header_msg);
+
+  // replies of one input server arrive in the order of the requests
+  if (c.claims) {
+    if (c.requested.empty() || c.requested.front() != any_timeslice) {
+      invalid_reply("unrequested timeslice assignment");
+    }
+    c.requested.pop_front();
+    if (ts == any_timeslice) {
+      // all timeslices have been assigned, no parts follow
+      if (more) {
+        invalid_reply("unexpected parts after end of assignment");
+      }
+      assignment_finished_ = true;
+      return true;
+    }
+    assigned_.push_back(ts);
+  } else {
+    if (c.requested.empty() || c.requested.front() != ts) {
+      invalid_reply("unrequested timeslice component");
+    }
+    c.requested.pop_front();
   }
-  assert(rc != -1);
 
-  uint64_t size_required =
-      zmq_msg_size(&c->desc_msg) + zmq_msg_size(&c->data_msg);
+  // receive desc parts and data parts (one each unless wrapped at input)
+  uint32_t num_parts = header.desc_parts + header.data_parts;
+  if (!more || header.desc_parts < 1 || header.desc_parts > 2 ||
+      header.data_parts < 1 || header.data_parts > 2) {
+    invalid_reply("unexpected number of parts");
+  }
+  zmq_msg_t parts[4];
+  uint64_t desc_size = 0;
+  uint64_t size_required = 0;
+  for (uint32_t i = 0; i < num_parts; ++i) {
+    rc = zmq_msg_init(&parts[i]);
+    assert(rc == 0);
+    // the parts of a message are delivered together with the first one
+    rc = zmq_msg_recv(&parts[i], c.socket, 0);
+    bool last = (rc != -1) && zmq_msg_more(&parts[i]) == 0;
+    if (rc == -1 || last != (i + 1 == num_parts)) {
+      int err = errno;
+      for (uint32_t j = 0; j <= i; ++j) {
+        zmq_msg_close(&parts[j]);
+      }
+      if (rc == -1 && err == EINTR && *signal_status_ != 0) {
+        return false;
+      }
+      invalid_reply(rc == -1 ? zmq_strerror(err)
+                             : "unexpected number of parts");
+    }
+    if (i < header.desc_parts) {
+      desc_size += zmq_msg_size(&parts[i]);
+    }
+    size_required += zmq_msg_size(&parts[i]);
+  }
 
-  while (c->data.size_available_contiguous() < size_required ||
-         c->desc.size_available() < 1) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    handle_timeslice_completions();
+  while (c.data.size_available_contiguous() < size_required ||
+         c.desc.size_available() < 1) {
+    if (*signal_status_ != 0) {
+      for (uint32_t i = 0; i < num_parts; ++i) {
+        zmq_msg_close(&parts[i]);
+      }
+      return false;
+    }
+    handle_timeslice_completions(std::chrono::milliseconds(100));
   }
 
   // skip remaining bytes in data buffer to avoid fractured entry
-  c->data.skip_buffer_wrap(size_required);
+  c.data.skip_buffer_wrap(size_required);
 
   // generate timeslice component descriptor
-  assert(tpos_ == c->desc.write_index());
-  c->desc.append(
-      {ts_index_, c->data.write_index(), size_required,
-       zmq_msg_size(&c->desc_msg) / sizeof(fles::MicrosliceDescriptor)});
+  assert(ts == ts_index(c.received));
+  assert(c.received == c.desc.write_index());
+  c.desc.append({ts, c.data.write_index(), size_required,
+                 desc_size / sizeof(fles::MicrosliceDescriptor)});
+
+  // reassemble parts in shared memory and release messages
+  for (uint32_t i = 0; i < num_parts; ++i) {
+    c.data.append(static_cast<uint8_t*>(zmq_msg_data(&parts[i])),
+                  zmq_msg_size(&parts[i]));
+    zmq_msg_close(&parts[i]);
+  }
+  ++c.received;
 
-  // copy into shared memory and release messages
-  c->data.append(static_cast<uint8_t*>(zmq_msg_data(&c->desc_msg)),
-                 zmq_msg_size(&c->desc_msg));
-  c->data.append(static_cast<uint8_t*>(zmq_msg_data(&c->data_msg)),
-                 zmq_msg_size(&c->data_msg));
-  zmq_msg_close(&c->desc_msg);
-  zmq_msg_close(&c->data_msg);
+  return true;
+}
 
-  ++conn_;
-  if (conn_ == connections_.size()) {
-    conn_ = 0;
+void TimesliceBuilderZeromq::invalid_reply(const std::string& what) {
+  L_(error) << "[c" << compute_index_ << "] receiving component failed: "
+            << what;
+  throw std::runtime_error("zeromq receive failed");
+}
 
-    handle_timeslice_completions();
+void TimesliceBuilderZeromq::send_work_items() {
+  uint64_t complete = UINT64_MAX;
+  for (auto& c : connections_) {
+    complete = std::min(complete, c->received);
+  }
 
+  for (; tpos_ < complete; ++tpos_) {
+    fles::trace(fles::TraceStage::WorkItemSent, ts_index(tpos_));
     timeslice_buffer_.send_work_item(
-        {{ts_index_, tpos_, timeslice_size_,
+        {{ts_index(tpos_), tpos_, timeslice_size_,
           static_cast<uint32_t>(connections_.size())},
          timeslice_buffer_.get_data_size_exp(),
-         timeslice_buffer_.get_desc_size_exp()});
-    ++tpos_;
-    // next timeslice: round robin
-    ts_index_ += num_compute_nodes_;
+         timeslice_buffer_.get_desc_size_exp(), 0, {}});
+    if (dynamic_assignment_) {
+      assigned_.pop_front();
+    }
   }
-
-  return true;
 }
 
 void TimesliceBuilderZeromq::run_end() {
@@ -166,8 +285,7 @@ void TimesliceBuilderZeromq::run_end() {
 
   // wait until all pending timeslices have been acknowledged
   while (acked_ < tpos_) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    handle_timeslice_completions();
+    handle_timeslice_completions(std::chrono::milliseconds(100));
   }
   assert(timeslice_buffer_.get_num_work_items() == 0);
   assert(timeslice_buffer_.get_num_completions() == 0);
@@ -175,9 +293,14 @@ void TimesliceBuilderZeromq::run_end() {
   timeslice_buffer_.send_end_completion();
 }
 
-void TimesliceBuilderZeromq::handle_timeslice_completions() {
+void TimesliceBuilderZeromq::handle_timeslice_completions(
+    std::chrono::milliseconds timeout) {
   fles::TimesliceCompletion c;
-  while (timeslice_buffer_.try_receive_completion(c)) {
+  bool received =
+      (timeout.count() > 0)
+          ? timeslice_buffer_.timed_receive_completion(c, timeout)
+          : timeslice_buffer_.try_receive_completion(c);
+  for (; received; received = timeslice_buffer_.try_receive_completion(c)) {
     if (c.ts_pos == acked_) {
       do
         ++acked_;
@@ -7,7 +7,10 @@
 #include "TimesliceBuffer.hpp"
 #include <boost/format.hpp>
 #include <cassert>
+#include <chrono>
 #include <csignal>
+#include <deque>
+#include <string>
 #include <vector>
 #include <zmq.h>
 
@@ -15,7 +18,20 @@
 /** A TimesliceBuilderZeromq object initiates connections to input nodes
  * and
  * receives
- * timeslices to a timeslice buffer. */
+ * timeslices to a timeslice buffer.
+ *
+ * Requests for timeslice components are pipelined: up to a configurable
+ * number of requests per input node are kept outstanding, and the replies
+ * of all input nodes are received as they arrive. A timeslice is handed to
+ * the consumers as soon as all of its components have been received.
+ *
+ * Timeslices are assigned to compute nodes either statically (round-robin)
+ * or dynamically. With dynamic assignment, the builder claims the next
+ * unassigned timeslice at the first input node and requests the remaining
+ * components of each assigned timeslice from the other input nodes. The
+ * number of claimed but incomplete timeslices is limited to the number of
+ * outstanding requests, so a compute node claims new timeslices only as
+ * fast as it completes them. */
 
 class TimesliceBuilderZeromq {
 public:
@@ -26,6 +42,8 @@ public:
                          uint32_t num_compute_nodes,
                          uint32_t timeslice_size,
                          uint32_t max_timeslice_number,
+                         uint32_t max_requests,
+                         bool dynamic_assignment,
                          volatile sig_atomic_t* signal_status,
                          void* zmq_context);
 
@@ -57,24 +75,32 @@ private:
   /// Number of timeslices after which this run shall end.
   const uint32_t max_timeslice_number_;
 
+  /// Maximum number of outstanding requests per input server, also the
+  /// maximum lead of an input server over the slowest one (round-robin).
+  const uint32_t max_requests_;
+
+  /// Whether timeslices are claimed dynamically instead of round-robin.
+  const bool dynamic_assignment_;
+
   /// Pointer to global signal status variable.
   volatile sig_atomic_t* signal_status_;
 
   /// Index of acknowledged timeslices (local index).
   uint64_t acked_ = 0;
 
-  /// The global index of the timeslice currently being received.
-  uint64_t ts_index_;
-
-  /// The local buffer position of the timeslice currently being received.
+  /// The local buffer position of the next timeslice to be completed.
   uint64_t tpos_ = 0;
 
-  /// The index of the connection to receive from next.
-  uint64_t conn_ = 0;
-
   /// Buffer to store acknowledged status of timeslices.
   RingBuffer<uint64_t, true> ack_;
 
+  /// Global timeslice indexes assigned to the local buffer positions
+  /// starting at tpos_ (dynamic assignment only).
+  std::deque<uint64_t> assigned_;
+
+  /// Whether all timeslices have been assigned (dynamic assignment only).
+  bool assignment_finished_ = false;
+
   /// Connection struct, handles data for one input server.
   struct Connection {
     Connection(TimesliceBuffer& timeslice_buffer, size_t i)
@@ -87,13 +113,27 @@ private:
     ManagedRingBuffer<uint8_t> data;
 
     void* socket;
-    zmq_msg_t desc_msg;
-    zmq_msg_t data_msg;
+
+    /// Whether requests to this input server claim the next unassigned
+    /// timeslice (dynamic assignment only).
+    bool claims = false;
+
+    /// Global timeslice indexes of outstanding requests, in order.
+    std::deque<uint64_t> requested;
+
+    /// Local buffer position of the next new request.
+    uint64_t request_tpos = 0;
+
+    /// Number of components received (local buffer position).
+    uint64_t received = 0;
   };
 
   /// The vector of connections, one per input server.
   std::vector<std::unique_ptr<Connection>> connections_;
 
+  /// Poll items for the sockets of all connections.
+  std::vector<zmq_pollitem_t> poll_items_;
+
   /// Begin of operation (for performance statistics).
   std::chrono::high_resolution_clock::time_point time_begin_;
 
@@ -151,8 +191,64 @@ private:
   /// Cleanup at end of run.
   void run_end();
 
-  /// Handle pending timeslice completions and advance read indexes.
-  void handle_timeslice_completions();
+  /// Retrieve the global timeslice index of a local buffer position.
+  uint64_t ts_index(uint64_t tpos) const {
+    if (dynamic_assignment_) {
+      return assigned_.at(tpos - tpos_);
+    }
+    return compute_index_ + tpos * num_compute_nodes_;
+  }
+
+  /// Check if all timeslices of this compute node have been handed to the
+  /// consumers.
+  bool finished() const {
+    if (dynamic_assignment_) {
+      return assignment_finished_ && assigned_.empty();
+    }
+    return ts_index(tpos_) >= max_timeslice_number_;
+  }
+
+  /// Check if there is a next component to be requested from an input
+  /// server, regardless of buffer space.
+  bool has_next_request(const Connection& c) const {
+    if (c.claims) {
+      // credit: limit the number of claimed but incomplete timeslices
+      return !assignment_finished_ &&
+             assigned_.size() + c.requested.size() < max_requests_;
+    }
+    if (dynamic_assignment_) {
+      return c.request_tpos < tpos_ + assigned_.size();
+    }
+    // do not run ahead of the slowest input server, otherwise the buffers
+    // could fill up with components of timeslices that cannot complete
+    return ts_index(c.request_tpos) < max_timeslice_number_ &&
+           c.request_tpos < tpos_ + max_requests_;
+  }
+
+  /// Check if the next component may be requested from an input server.
+  bool may_request(const Connection& c) const {
+    return has_next_request(c) && c.request_tpos < acked_ + c.desc.size();
+  }
+
+  /// Send new requests to an input server as far as buffer space allows.
+  bool send_requests(Connection& c);
+
+  /// Send a single request for a timeslice component.
+  bool send_request(Connection& c, uint64_t ts);
+
+  /// Receive a single reply if available, return false otherwise.
+  bool receive_reply(Connection& c);
+
+  /// Report a reply that violates the protocol or could not be received.
+  [[noreturn]] void invalid_reply(const std::string& what);
+
+  /// Hand all timeslices received from all input servers to the consumers.
+  void send_work_items();
+
+  /// Handle pending timeslice completions and advance read indexes. Wait up
+  /// to `timeout` for the first completion.
+  void handle_timeslice_completions(
+      std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
 
   /// Print a (periodic) buffer status report.
   void report_status();
@@ -0,0 +1,157 @@
+#define BOOST_TEST_MODULE test_Crc32c
+#include <boost/test/unit_test.hpp>
+
+#include "Crc32c.hpp"
+#include "MicrosliceReceiver.hpp"
+#include "MicrosliceTransmitter.hpp"
+#include "RingBuffer.hpp"
+#include "interface.h" // crcutil_interface
+#include <boost/crc.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Scalar reference implementation of CRC-32C
+uint32_t reference_crc(const uint8_t* data, std::size_t size) {
+  boost::crc_optimal<32, 0x1EDC6F41, 0xFFFFFFFF, 0xFFFFFFFF, true, true> crc;
+  crc.process_bytes(data, size);
+  return crc();
+}
+
+std::vector<uint8_t> random_bytes(std::size_t size) {
+  std::mt19937 rng(5);
+  std::vector<uint8_t> data(size);
+  for (auto& b : data) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return data;
+}
+
+// In-memory input buffer connecting a transmitter and a receiver
+class LoopbackBuffer : public InputBufferWriteInterface,
+                       public InputBufferReadInterface {
+public:
+  LoopbackBuffer(std::size_t data_size_exp, std::size_t desc_size_exp)
+      : data_(data_size_exp), desc_(desc_size_exp),
+        data_view_(data_.ptr(), data_size_exp),
+        desc_view_(desc_.ptr(), desc_size_exp) {}
+
+  RingBufferView<uint8_t>& data_buffer() override { return data_view_; }
+  RingBufferView<fles::MicrosliceDescriptor>& desc_buffer() override {
+    return desc_view_;
+  }
+  DualIndex get_read_index() override { return read_index_; }
+  void set_read_index(DualIndex index) override { read_index_ = index; }
+  DualIndex get_write_index() override { return write_index_; }
+  void set_write_index(DualIndex index) override { write_index_ = index; }
+  bool get_eof() override { return eof_; }
+  void set_eof(bool eof) override { eof_ = eof; }
+
+private:
+  RingBuffer<uint8_t> data_;
+  RingBuffer<fles::MicrosliceDescriptor> desc_;
+  RingBufferView<uint8_t> data_view_;
+  RingBufferView<fles::MicrosliceDescriptor> desc_view_;
+  DualIndex read_index_{0, 0};
+  DualIndex write_index_{0, 0};
+  bool eof_ = false;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(crc32c_test) {
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  BOOST_CHECK_EQUAL(fles::crc32c(check, sizeof(check)), 0xE3069283);
+
+  std::vector<uint8_t> data = random_bytes(40000);
+  for (std::size_t size : {0, 1, 7, 8, 9, 3071, 3072, 3073, 6144, 10007,
+                           39990}) {
+    for (std::size_t offset : {0, 1, 5}) {
+      BOOST_CHECK_EQUAL(fles::crc32c(data.data() + offset, size),
+                        reference_crc(data.data() + offset, size));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chained_crc32c_test) {
+  std::vector<uint8_t> data = random_bytes(20000);
+  uint32_t expected = reference_crc(data.data(), data.size());
+  for (std::size_t split : {0, 1, 3000, 9999, 20000}) {
+    uint32_t crc = fles::crc32c(data.data(), split);
+    crc = fles::crc32c(data.data() + split, data.size() - split, crc);
+    BOOST_CHECK_EQUAL(crc, expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(copy_crc32c_test) {
+  std::vector<uint8_t> data = random_bytes(30000);
+  for (std::size_t size : {0, 3, 64, 3072, 9217, 29999}) {
+    std::vector<uint8_t> copy(size + 2, 0xAA);
+    uint32_t crc = fles::copy_crc32c(copy.data() + 1, data.data() + 1, size);
+    BOOST_CHECK_EQUAL(crc, reference_crc(data.data() + 1, size));
+    BOOST_CHECK(std::equal(data.begin() + 1, data.begin() + 1 + size,
+                           copy.begin() + 1));
+    BOOST_CHECK_EQUAL(copy.front(), 0xAA);
+    BOOST_CHECK_EQUAL(copy.back(), 0xAA);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(transmit_receive_test) {
+  LoopbackBuffer buffer(14, 5);
+  fles::MicrosliceTransmitter transmitter(buffer);
+  fles::MicrosliceReceiver receiver(buffer);
+
+  std::vector<uint8_t> data = random_bytes(5000);
+  for (uint32_t i = 0; i < 100; ++i) {
+    fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+    desc.idx = i;
+    desc.flags = static_cast<uint16_t>(fles::MicrosliceFlags::CrcValid);
+    std::vector<uint8_t> content(data.begin() + i, data.begin() + 3000 + i);
+    auto ms = std::make_shared<fles::StorableMicroslice>(desc, content);
+    ms->initialize_crc();
+    if (i % 10 == 3) {
+      ms->desc().crc ^= 1;
+    }
+    transmitter.put(ms);
+
+    auto received = receiver.get();
+    BOOST_REQUIRE(received);
+    BOOST_CHECK(std::equal(content.begin(), content.end(),
+                           received->content()));
+    BOOST_CHECK_EQUAL(received->check_crc(), i % 10 != 3);
+  }
+  BOOST_CHECK_EQUAL(transmitter.crc_errors(), 10);
+  BOOST_CHECK_EQUAL(receiver.crc_errors(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(crcutil_pclmul_test) {
+  if (!crcutil_interface::CRC::IsPCLMULAvailable()) {
+    BOOST_TEST_MESSAGE("PCLMULQDQ not available, skipping comparison");
+    return;
+  }
+  crcutil_interface::CRC* sse42 =
+      crcutil_interface::CRC::Create(0x82f63b78, 0, 32, true, 0, 0, 0, true,
+                                     false, nullptr);
+  crcutil_interface::CRC* pclmul = crcutil_interface::CRC::Create(
+      0x82f63b78, 0, 32, true, 0, 0, 0, true, true, nullptr);
+
+  std::vector<uint8_t> data = random_bytes(100000);
+  for (std::size_t size : {0, 1, 63, 255, 256, 257, 320, 1023, 1024, 1087,
+                           4097, 65536, 99990}) {
+    for (std::size_t offset : {0, 3, 8}) {
+      crcutil_interface::UINT64 crc_sse42 = 0x1234;
+      crcutil_interface::UINT64 crc_pclmul = 0x1234;
+      sse42->Compute(data.data() + offset, size, &crc_sse42);
+      pclmul->Compute(data.data() + offset, size, &crc_pclmul);
+      BOOST_CHECK_EQUAL(crc_pclmul, crc_sse42);
+
+      crcutil_interface::UINT64 crc = 0;
+      pclmul->Compute(data.data() + offset, size, &crc);
+      BOOST_CHECK_EQUAL(crc, reference_crc(data.data() + offset, size));
+    }
+  }
+
+  sse42->Delete();
+  pclmul->Delete();
+}
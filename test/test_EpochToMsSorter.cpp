@@ -0,0 +1,230 @@
+#define BOOST_TEST_MODULE test_EpochToMsSorter
+#include <boost/test/unit_test.hpp>
+
+#include "GdpbEpochToMsSorter.hpp"
+#include "MicrosliceInputArchive.hpp"
+#include "NdpbEpochToMsSorter.hpp"
+#include "StorableMicroslice.hpp"
+#include "rocMess_wGet4v1.h"
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+using ms_vector = std::vector<std::shared_ptr<const fles::Microslice>>;
+using content_vector = std::vector<std::vector<uint64_t>>;
+
+std::vector<uint64_t> words(const fles::Microslice& ms) {
+  const uint64_t* p = reinterpret_cast<const uint64_t*>(ms.content());
+  return std::vector<uint64_t>(p, p + ms.desc().size / sizeof(uint64_t));
+}
+
+std::shared_ptr<const fles::Microslice>
+make_microslice(uint64_t idx, const std::vector<uint64_t>& data) {
+  fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+  desc.hdr_id = static_cast<uint8_t>(fles::HeaderFormatIdentifier::Standard);
+  desc.idx = idx;
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+  return std::make_shared<fles::StorableMicroslice>(
+      desc, std::vector<uint8_t>(p, p + data.size() * sizeof(uint64_t)));
+}
+
+// Synthetic nDPB stream: per epoch an epoch message followed by hits with
+// random timestamps and a few aux/sync messages.
+ms_vector make_ndpb_stream(std::size_t nb_ms, std::size_t ep_per_ms,
+                           std::size_t hits_per_ep) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<uint32_t> ts_dist(0, 0x3fff);
+  std::uniform_int_distribution<uint32_t> bit_dist(0, 1);
+
+  ms_vector stream;
+  uint32_t epoch = 1000;
+  for (std::size_t m = 0; m < nb_ms; ++m) {
+    std::vector<uint64_t> data;
+    for (std::size_t e = 0; e < ep_per_ms; ++e, ++epoch) {
+      ngdpb::Message ep;
+      ep.setMessageType(ngdpb::MSG_EPOCH);
+      ep.setField(8, 32, epoch);
+      data.push_back(ep.getData());
+      for (std::size_t h = 0; h < hits_per_ep; ++h) {
+        ngdpb::Message hit;
+        hit.setMessageType(ngdpb::MSG_HIT);
+        hit.setField(11, 14, ts_dist(rng));
+        hit.setField(25, 7, h % 128);
+        hit.setBit(47, bit_dist(rng));
+        data.push_back(hit.getData());
+        if (h % 64 == 0) {
+          ngdpb::Message aux;
+          aux.setMessageType(h % 128 == 0 ? ngdpb::MSG_AUX : ngdpb::MSG_SYNC);
+          aux.setField(13, 13, ts_dist(rng) >> 1);
+          data.push_back(aux.getData());
+        }
+      }
+    }
+    stream.push_back(make_microslice(m, data));
+  }
+  return stream;
+}
+
+// Previous nDPB sorting algorithm: one std::multiset insertion per message
+content_vector multiset_reference(const ms_vector& stream,
+                                  uint32_t ep_per_ms) {
+  content_vector result;
+  std::multiset<ngdpb::FullMessage> buffer;
+  uint32_t nb_ep_in_buff = 0;
+  bool first_ep_found = false;
+  uint32_t current_epoch = 0;
+  uint32_t current_cycle = 0;
+  uint64_t long_epoch = 0;
+
+  for (const auto& ms : stream) {
+    for (uint64_t data : words(*ms)) {
+      ngdpb::Message mess(data);
+      if (mess.isEpoch2Msg() || mess.isGet4Msg() || mess.isGet4SlCtrMsg() ||
+          mess.isGet4Hit32Msg() || mess.isGet4SysMsg() || mess.isSyncMsg()) {
+        continue;
+      }
+      if (mess.isEpochMsg()) {
+        if ((mess.getEpochNumber() < current_epoch) &&
+            (0xEFFFFFFF < current_epoch - mess.getEpochNumber())) {
+          current_cycle++;
+        }
+        current_epoch = mess.getEpochNumber();
+        long_epoch = (static_cast<uint64_t>(current_cycle) << 32) +
+                     current_epoch;
+        if (first_ep_found) {
+          if (ep_per_ms == ++nb_ep_in_buff) {
+            std::vector<uint64_t> content;
+            for (const auto& m : buffer) {
+              content.push_back(m.getData());
+            }
+            result.push_back(content);
+            buffer.clear();
+            nb_ep_in_buff = 0;
+          }
+        } else {
+          first_ep_found = true;
+        }
+      }
+      if (first_ep_found) {
+        buffer.insert(ngdpb::FullMessage(mess, long_epoch));
+      }
+    }
+  }
+  return result;
+}
+
+template <class Filter>
+content_vector run_filter(Filter& filter, const ms_vector& stream) {
+  content_vector result;
+  for (const auto& ms : stream) {
+    auto out = filter.exchange_item(ms);
+    while (out.first) {
+      result.push_back(words(*out.first));
+      if (!out.second) {
+        break;
+      }
+      out = filter.exchange_item(nullptr);
+    }
+  }
+  return result;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ndpb_sorter_synthetic_test) {
+  constexpr uint32_t ep_per_ms = 4;
+  ms_vector stream = make_ndpb_stream(100, 10, 200);
+
+  content_vector reference = multiset_reference(stream, ep_per_ms);
+
+  fles::NdpbEpochToMsSorter sorter(ep_per_ms, true);
+  content_vector sorted = run_filter(sorter, stream);
+
+  BOOST_REQUIRE_EQUAL(sorted.size(), reference.size());
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    BOOST_CHECK(sorted[i] == reference[i]);
+  }
+  BOOST_CHECK_EQUAL(sorter.ignored_messages(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ndpb_sorter_reference_data_test) {
+  ms_vector stream;
+  fles::MicrosliceInputArchive source("example2.msa");
+  while (auto ms = source.get()) {
+    stream.push_back(std::move(ms));
+  }
+
+  content_vector reference = multiset_reference(stream, 1);
+
+  fles::NdpbEpochToMsSorter sorter(1, true);
+  content_vector sorted = run_filter(sorter, stream);
+
+  BOOST_REQUIRE_EQUAL(sorted.size(), reference.size());
+  for (std::size_t i = 0; i < sorted.size(); ++i) {
+    BOOST_CHECK(sorted[i] == reference[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ndpb_sorter_unsorted_test) {
+  ms_vector stream = make_ndpb_stream(3, 2, 10);
+
+  fles::NdpbEpochToMsSorter sorter(1, false);
+  content_vector out = run_filter(sorter, stream);
+
+  // one microslice per completed epoch, messages in input order
+  BOOST_REQUIRE_EQUAL(out.size(), 5);
+  std::vector<uint64_t> input = words(*stream[0]);
+  std::vector<uint64_t> expected;
+  for (uint64_t data : input) {
+    if (!ngdpb::Message(data).isSyncMsg()) {
+      expected.push_back(data);
+    }
+    if (expected.size() > 1 && ngdpb::Message(data).isEpochMsg()) {
+      expected.pop_back();
+      break;
+    }
+  }
+  BOOST_CHECK(out[0] == expected);
+}
+
+BOOST_AUTO_TEST_CASE(gdpb_sorter_test) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<uint32_t> ts_dist(0, 0x7ffff);
+
+  std::vector<uint64_t> data;
+  for (uint32_t epoch = 1; epoch <= 3; ++epoch) {
+    ngdpb::Message ep;
+    ep.setMessageType(ngdpb::MSG_EPOCH);
+    ep.setField(8, 32, epoch);
+    data.push_back(ep.getData());
+    ngdpb::Message ep2;
+    ep2.setMessageType(ngdpb::MSG_EPOCH2);
+    ep2.setField(10, 31, epoch);
+    data.push_back(ep2.getData());
+    for (int h = 0; h < 100; ++h) {
+      ngdpb::Message hit;
+      hit.setMessageType(ngdpb::MSG_GET4_32B);
+      hit.setField(21, 19, ts_dist(rng));
+      data.push_back(hit.getData());
+    }
+  }
+  ms_vector stream{make_microslice(0, data)};
+
+  fles::GdpbEpochToMsSorter sorter(1, 0x1);
+  content_vector out = run_filter(sorter, stream);
+
+  BOOST_REQUIRE_EQUAL(out.size(), 2);
+  for (const auto& content : out) {
+    BOOST_CHECK_EQUAL(content.size(), 102);
+    uint32_t last_ts = 0;
+    for (uint64_t word : content) {
+      ngdpb::Message mess(word);
+      if (mess.isGet4Hit32Msg()) {
+        BOOST_CHECK_LE(last_ts, mess.getGdpbHitFullTs());
+        last_ts = mess.getGdpbHitFullTs();
+      }
+    }
+  }
+}
@@ -0,0 +1,47 @@
+#define BOOST_TEST_MODULE test_ExponentialBackoff
+#include <boost/test/unit_test.hpp>
+
+#include "ExponentialBackoff.hpp"
+
+using std::chrono::milliseconds;
+
+BOOST_AUTO_TEST_CASE(schedule_test) {
+  ExponentialBackoff b(milliseconds(10), milliseconds(50));
+  ExponentialBackoff::clock::time_point t0;
+  auto now = t0 + milliseconds(1000);
+  BOOST_CHECK(b.due(now));
+  BOOST_CHECK_EQUAL(b.failures(), 0);
+
+  b.failed(now);
+  BOOST_CHECK(!b.due(now + milliseconds(9)));
+  BOOST_CHECK(b.due(now + milliseconds(10)));
+
+  now += milliseconds(10);
+  b.failed(now);
+  BOOST_CHECK(b.next_attempt() == now + milliseconds(20));
+
+  now += milliseconds(20);
+  b.failed(now);
+  BOOST_CHECK(b.next_attempt() == now + milliseconds(40));
+
+  // limited to the maximum delay
+  now += milliseconds(40);
+  b.failed(now);
+  BOOST_CHECK(b.next_attempt() == now + milliseconds(50));
+  now += milliseconds(50);
+  b.failed(now);
+  BOOST_CHECK(b.next_attempt() == now + milliseconds(50));
+  BOOST_CHECK_EQUAL(b.failures(), 5);
+}
+
+BOOST_AUTO_TEST_CASE(reset_test) {
+  ExponentialBackoff b(milliseconds(10), milliseconds(1000));
+  auto now = ExponentialBackoff::clock::now();
+  b.failed(now);
+  b.failed(now);
+  b.reset();
+  BOOST_CHECK_EQUAL(b.failures(), 0);
+  BOOST_CHECK(b.due(now));
+  b.failed(now);
+  BOOST_CHECK(b.next_attempt() == now + milliseconds(10));
+}
@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE test_FlesnetPattern
+#include <boost/test/unit_test.hpp>
+
+#include "FlesnetPatternChecker.hpp"
+#include "FlesnetPatternGenerator.hpp"
+#include "FlesnetPatternKernel.hpp"
+#include "MicrosliceReceiver.hpp"
+#include "StorableMicroslice.hpp"
+#include <vector>
+
+namespace {
+
+using flesnet_pattern::Isa;
+
+const std::vector<Isa> all_isas{Isa::Scalar, Isa::AVX2, Isa::AVX512};
+
+// Reference implementation: the original word-by-word loop
+uint32_t reference_pattern(std::vector<uint64_t>& data,
+                           uint64_t tag,
+                           std::size_t words) {
+  data.resize(words);
+  uint32_t crc = 0;
+  for (std::size_t pos = 0; pos < words; ++pos) {
+    uint64_t data_word = (tag << 48) | (pos * sizeof(uint64_t));
+    data[pos] = data_word;
+    crc ^= (data_word & 0xffffffff) ^ (data_word >> 32);
+  }
+  return crc;
+}
+
+fles::StorableMicroslice make_microslice(const std::vector<uint64_t>& data,
+                                         uint32_t crc) {
+  fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+  desc.crc = crc;
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+  return fles::StorableMicroslice(
+      desc, std::vector<uint8_t>(p, p + data.size() * sizeof(uint64_t)));
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(fill_test) {
+  for (Isa isa : all_isas) {
+    if (!flesnet_pattern::is_supported(isa)) {
+      continue;
+    }
+    for (std::size_t words : {0, 1, 3, 4, 7, 8, 9, 63, 64, 65, 1000}) {
+      for (std::size_t split : {std::size_t(0), words / 3, words}) {
+        std::vector<uint64_t> reference;
+        uint32_t reference_crc = reference_pattern(reference, 0xE001, words);
+
+        // fill in two segments as done at ring buffer wrap-around
+        std::vector<uint64_t> data(words + 1, 0);
+        uint64_t sum =
+            flesnet_pattern::fill(data.data(), split, 0xE001, 0, isa);
+        sum ^= flesnet_pattern::fill(data.data() + split, words - split,
+                                     0xE001, split, isa);
+        BOOST_CHECK_EQUAL(data.back(), 0);
+        data.pop_back();
+        BOOST_CHECK(data == reference);
+        BOOST_CHECK_EQUAL(flesnet_pattern::fold(sum), reference_crc);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(checker_test) {
+  for (Isa isa : all_isas) {
+    if (!flesnet_pattern::is_supported(isa)) {
+      continue;
+    }
+    for (std::size_t words : {0, 1, 5, 8, 64, 67, 200}) {
+      std::vector<uint64_t> data;
+      uint32_t crc = reference_pattern(data, 3, words);
+
+      uint64_t sum = 0;
+      BOOST_CHECK(flesnet_pattern::check(data.data(), words, 3, 0, sum, isa));
+      BOOST_CHECK_EQUAL(flesnet_pattern::fold(sum), crc);
+
+      // every single corrupted word must be detected
+      for (std::size_t pos = 0; pos < words; ++pos) {
+        data[pos] ^= UINT64_C(1) << (pos % 64);
+        BOOST_CHECK(
+            !flesnet_pattern::check(data.data(), words, 3, 0, sum, isa));
+        data[pos] ^= UINT64_C(1) << (pos % 64);
+      }
+    }
+  }
+
+  std::vector<uint64_t> data;
+  uint32_t crc = reference_pattern(data, 2, 100);
+  FlesnetPatternChecker checker(2);
+  BOOST_CHECK(checker.check(make_microslice(data, crc)));
+  BOOST_CHECK(!checker.check(make_microslice(data, crc ^ 1)));
+  FlesnetPatternChecker wrong_component(1);
+  BOOST_CHECK(!wrong_component.check(make_microslice(data, crc)));
+}
+
+BOOST_AUTO_TEST_CASE(generator_test) {
+  // small data buffer to exercise wrap-around
+  FlesnetPatternGenerator generator(14, 6, 5, 1000, true, true);
+  fles::MicrosliceReceiver receiver(generator);
+  FlesnetPatternChecker checker(5);
+
+  for (std::size_t i = 0; i < 1000; ++i) {
+    auto ms = receiver.get();
+    BOOST_REQUIRE(ms);
+    std::vector<uint64_t> reference;
+    uint32_t crc =
+        reference_pattern(reference, 5, ms->desc().size / sizeof(uint64_t));
+    BOOST_CHECK_EQUAL(ms->desc().crc, crc);
+    BOOST_CHECK(
+        std::equal(reference.begin(), reference.end(),
+                   reinterpret_cast<const uint64_t*>(ms->content())));
+    BOOST_CHECK(checker.check(*ms));
+  }
+}
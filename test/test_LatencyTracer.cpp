@@ -0,0 +1,92 @@
+#define BOOST_TEST_MODULE test_LatencyTracer
+#include <boost/test/unit_test.hpp>
+
+#include "LatencyTracer.hpp"
+#include <thread>
+
+using namespace fles;
+
+BOOST_AUTO_TEST_CASE(histogram_test) {
+  LatencyHistogram h;
+  for (uint64_t v = 1; v <= 100000; ++v) {
+    h.record(v);
+  }
+  BOOST_CHECK_EQUAL(h.count(), 100000);
+  BOOST_CHECK_EQUAL(h.min(), 1);
+  BOOST_CHECK_EQUAL(h.max(), 100000);
+  BOOST_CHECK_CLOSE(h.mean(), 50000.5, 0.001);
+  // relative error is bounded by the sub-bucket resolution
+  BOOST_CHECK_CLOSE(static_cast<double>(h.percentile(50)), 50000, 3.2);
+  BOOST_CHECK_CLOSE(static_cast<double>(h.percentile(99)), 99000, 3.2);
+  BOOST_CHECK_EQUAL(h.percentile(100), 100000);
+
+  LatencyHistogram small;
+  small.record(7);
+  h.merge(small);
+  BOOST_CHECK_EQUAL(h.count(), 100001);
+  BOOST_CHECK_EQUAL(h.percentile(0), 1);
+
+  LatencyHistogram huge;
+  huge.record(UINT64_MAX);
+  BOOST_CHECK_EQUAL(huge.percentile(50), UINT64_MAX);
+}
+
+BOOST_AUTO_TEST_CASE(summary_test) {
+  std::vector<TraceEvent> events;
+  for (uint64_t ts = 0; ts < 10; ++ts) {
+    uint64_t t = 1000000 * (ts + 1);
+    // two components, the later one determines the progress
+    events.push_back({ts, t, TraceStage::SenderStart});
+    events.push_back({ts, t + 100, TraceStage::SenderStart});
+    events.push_back({ts, t + 1100, TraceStage::TransferComplete});
+    events.push_back({ts, t + 3100, TraceStage::ConsumerReceived});
+  }
+  LatencySummary summary(events);
+  BOOST_CHECK_EQUAL(summary.stage(TraceStage::SenderStart).count(), 0);
+  BOOST_CHECK_EQUAL(summary.stage(TraceStage::TransferComplete).count(), 10);
+  BOOST_CHECK_EQUAL(summary.stage(TraceStage::TransferComplete).max(), 1000);
+  BOOST_CHECK_EQUAL(summary.stage(TraceStage::WorkItemSent).count(), 0);
+  BOOST_CHECK_EQUAL(summary.stage(TraceStage::ConsumerReceived).min(), 2000);
+  BOOST_CHECK_EQUAL(summary.total().max(), 3000);
+}
+
+BOOST_AUTO_TEST_CASE(tracer_test) {
+  LatencyTracer& tracer = LatencyTracer::instance();
+  tracer.enable("", 16);
+  BOOST_REQUIRE(tracer.enabled());
+  tracer.clear();
+
+  tracer.set_timeslice_geometry(4, 1);
+  for (uint64_t m = 0; m < 14; ++m) {
+    trace_microslice(m);
+  }
+  std::thread other([] {
+    for (uint64_t ts = 0; ts < 100; ++ts) {
+      trace(TraceStage::Completed, ts);
+    }
+  });
+  other.join();
+
+  auto events = tracer.events();
+  uint64_t written = 0;
+  uint64_t completed = 0;
+  for (const auto& event : events) {
+    if (event.stage == TraceStage::MicrosliceWritten) {
+      // microslices 4, 8, 12 complete timeslices 0, 1, 2
+      BOOST_CHECK_EQUAL(event.ts_index, written);
+      ++written;
+    } else {
+      BOOST_CHECK_EQUAL(static_cast<int>(event.stage),
+                        static_cast<int>(TraceStage::Completed));
+      // ring buffer keeps only the latest events
+      BOOST_CHECK_GE(event.ts_index, 84);
+      ++completed;
+    }
+  }
+  BOOST_CHECK_EQUAL(written, 3);
+  BOOST_CHECK_GE(completed, 15);
+  BOOST_CHECK_LE(completed, 16);
+
+  tracer.clear();
+  BOOST_CHECK(tracer.events().empty());
+}
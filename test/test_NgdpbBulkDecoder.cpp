@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE test_NgdpbBulkDecoder
+#include <boost/test/unit_test.hpp>
+
+#include "NgdpbBulkDecoder.hpp"
+#include "NgdpbDebugger.hpp"
+#include "StorableMicroslice.hpp"
+#include "rocMess_wGet4v1.h"
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+std::vector<uint64_t> random_messages(std::size_t count) {
+  std::mt19937_64 rng(1234);
+  std::vector<uint64_t> messages(count);
+  for (auto& m : messages) {
+    m = rng();
+  }
+  return messages;
+}
+
+void check_equal(const ngdpb::MessageBlock& a, const ngdpb::MessageBlock& b) {
+  BOOST_REQUIRE_EQUAL(a.size, b.size);
+  for (std::size_t i = 0; i < a.size; ++i) {
+    BOOST_CHECK_EQUAL(a.type[i], b.type[i]);
+    BOOST_CHECK_EQUAL(a.epoch[i], b.epoch[i]);
+    BOOST_CHECK_EQUAL(a.chip[i], b.chip[i]);
+    BOOST_CHECK_EQUAL(a.channel[i], b.channel[i]);
+  }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(scalar_fields_test) {
+  ngdpb::Message hit;
+  hit.setMessageType(ngdpb::MSG_HIT);
+  hit.setField(6, 2, 3);
+  hit.setField(25, 7, 100);
+  ngdpb::Message epoch;
+  epoch.setMessageType(ngdpb::MSG_EPOCH);
+  epoch.setField(8, 32, 0xDEADBEEF);
+  ngdpb::Message get4;
+  get4.setMessageType(ngdpb::MSG_GET4_32B);
+  get4.setField(42, 6, 47);
+  get4.setField(40, 2, 2);
+  std::vector<uint64_t> messages{hit.getData(), epoch.getData(),
+                                 get4.getData()};
+
+  ngdpb::BulkDecoder decoder(false);
+  ngdpb::MessageBlock block;
+  BOOST_REQUIRE_EQUAL(decoder.decode(messages.data(), messages.size(), block),
+                      3);
+  BOOST_CHECK_EQUAL(block.type[0], ngdpb::MSG_HIT);
+  BOOST_CHECK_EQUAL(block.chip[0], 3);
+  BOOST_CHECK_EQUAL(block.channel[0], 100);
+  BOOST_CHECK_EQUAL(block.epoch[1], 0xDEADBEEF);
+  BOOST_CHECK_EQUAL(block.chip[2], 47);
+  BOOST_CHECK_EQUAL(block.channel[2], 2);
+}
+
+BOOST_AUTO_TEST_CASE(avx2_matches_scalar_test) {
+  if (!ngdpb::BulkDecoder::is_avx2_available()) {
+    BOOST_TEST_MESSAGE("AVX2 not available, skipping comparison");
+    return;
+  }
+
+  // odd count to exercise the scalar tail of the AVX2 implementation
+  std::vector<uint64_t> messages = random_messages(100003);
+
+  ngdpb::BulkDecoder scalar(false);
+  ngdpb::BulkDecoder avx2(true);
+  BOOST_REQUIRE(avx2.uses_avx2());
+
+  ngdpb::MessageBlock block_scalar;
+  ngdpb::MessageBlock block_avx2;
+  for (std::size_t pos = 0; pos < messages.size();) {
+    std::size_t n = scalar.decode(&messages[pos], messages.size() - pos,
+                                  block_scalar);
+    avx2.decode(&messages[pos], messages.size() - pos, block_avx2);
+    check_equal(block_scalar, block_avx2);
+    pos += n;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(monitor_test) {
+  std::vector<uint64_t> messages;
+  for (uint32_t epoch = 10; epoch < 20; ++epoch) {
+    ngdpb::Message ep;
+    ep.setMessageType(ngdpb::MSG_EPOCH);
+    ep.setField(8, 32, epoch == 15 ? 16 : epoch);
+    messages.push_back(ep.getData());
+    for (uint32_t ch = 0; ch < 8; ++ch) {
+      ngdpb::Message hit;
+      hit.setMessageType(ngdpb::MSG_HIT);
+      hit.setField(6, 2, 1);
+      hit.setField(25, 7, ch);
+      messages.push_back(hit.getData());
+    }
+  }
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(messages.data());
+  auto ms = std::make_shared<fles::StorableMicroslice>(
+      fles::MicrosliceDescriptor(),
+      std::vector<uint8_t>(p, p + messages.size() * sizeof(uint64_t)));
+
+  std::ostringstream out;
+  NgdpbMicrosliceMonitor monitor(1, out);
+  monitor.put(ms);
+
+  BOOST_CHECK_EQUAL(monitor.type_histogram()[ngdpb::MSG_EPOCH], 10);
+  BOOST_CHECK_EQUAL(monitor.type_histogram()[ngdpb::MSG_HIT], 80);
+  BOOST_CHECK_EQUAL(monitor.nx_hit_histogram()[1 * 128 + 7], 10);
+  BOOST_CHECK_EQUAL(monitor.nx_hit_histogram()[0], 0);
+  // 14 -> 16 and 16 -> 16 are both gaps
+  BOOST_CHECK_EQUAL(monitor.epoch_gaps(), 2);
+  BOOST_CHECK(!out.str().empty());
+}
@@ -0,0 +1,26 @@
+#define BOOST_TEST_MODULE test_RequestIdentifier
+#include <boost/test/unit_test.hpp>
+
+#include "RequestIdentifier.hpp"
+
+using namespace tl_libfabric;
+
+BOOST_AUTO_TEST_CASE(descriptor_write_test) {
+  uint64_t wr_id = request_context(ID_WRITE_DESC, 1234, 987654321);
+  BOOST_CHECK_EQUAL(request_id(wr_id), ID_WRITE_DESC);
+  BOOST_CHECK_EQUAL(request_conn_index(wr_id), 1234u);
+  BOOST_CHECK_EQUAL(request_tag(wr_id), 987654321u);
+}
+
+BOOST_AUTO_TEST_CASE(failed_data_write_test) {
+  // data writes carry no tag, only the connection index identifies the
+  // compute node in InputChannelSender::on_completion_error()
+  for (uint64_t cn : {0, 1, 255, 256, 0xFFFF}) {
+    for (RequestIdentifier id : {ID_WRITE_DATA, ID_WRITE_DATA_WRAP}) {
+      uint64_t wr_id = request_context(id, cn);
+      BOOST_CHECK_EQUAL(request_id(wr_id), id);
+      BOOST_CHECK_EQUAL(request_conn_index(wr_id), cn);
+      BOOST_CHECK_EQUAL(request_tag(wr_id), 0u);
+    }
+  }
+}
@@ -7,6 +7,7 @@
 #include "System.hpp"
 #include "TimesliceInputArchive.hpp"
 #include "TimesliceOutputArchive.hpp"
+#include "TimesliceWorkItem.hpp"
 #include <array>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
@@ -175,3 +176,35 @@ BOOST_AUTO_TEST_CASE(invalid_archive_test) {
   BOOST_CHECK_THROW(fles::TimesliceInputArchive source(filename2),
                     std::runtime_error);
 }
+
+BOOST_AUTO_TEST_CASE(missing_components_test) {
+  fles::TimesliceWorkItem wi = {{1, 1, 100, 200}, 20, 10, 0, {}};
+  BOOST_CHECK(!wi.component_missing(0));
+
+  wi.set_component_missing(3);
+  wi.set_component_missing(130);
+  wi.set_component_missing(3);
+  BOOST_CHECK_EQUAL(wi.num_missing_components, 2);
+  BOOST_CHECK(wi.component_missing(3));
+  BOOST_CHECK(wi.component_missing(130));
+  BOOST_CHECK(!wi.component_missing(2));
+  BOOST_CHECK(!wi.component_missing(67));
+  BOOST_CHECK(!wi.component_missing(fles::max_flagged_components));
+}
+
+BOOST_FIXTURE_TEST_CASE(empty_component_test, F) {
+  // a component without microslices is not missing
+  uint32_t c = ts0.append_component(0);
+  BOOST_CHECK_EQUAL(ts0.num_microslices(c), 0);
+  BOOST_CHECK(!ts0.component_missing(c));
+  BOOST_CHECK(!ts0.component_missing(0));
+
+  std::stringstream s;
+  boost::archive::binary_oarchive oa(s);
+  oa << ts0;
+  boost::archive::binary_iarchive ia(s);
+  fles::StorableTimeslice ts1{0};
+  ia >> ts1;
+  BOOST_CHECK_EQUAL(ts1.num_components(), 3);
+  BOOST_CHECK(!ts1.component_missing(c));
+}
@@ -0,0 +1,86 @@
+#define BOOST_TEST_MODULE test_TimesliceAnalyzer
+#include <boost/test/unit_test.hpp>
+
+#include "FlesnetPatternKernel.hpp"
+#include "StorableTimeslice.hpp"
+#include "TimesliceAnalyzer.hpp"
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Timeslice with FLESnet ramp pattern content in all components
+std::shared_ptr<fles::StorableTimeslice>
+make_timeslice(uint64_t index,
+               uint32_t num_components,
+               uint32_t num_microslices,
+               std::size_t words_per_microslice) {
+  auto ts = std::make_shared<fles::StorableTimeslice>(num_microslices, index);
+  std::vector<uint64_t> data(words_per_microslice);
+  for (uint32_t c = 0; c < num_components; ++c) {
+    ts->append_component(num_microslices);
+    for (uint32_t m = 0; m < num_microslices; ++m) {
+      fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+      desc.hdr_id =
+          static_cast<uint8_t>(fles::HeaderFormatIdentifier::Standard);
+      desc.sys_id = static_cast<uint8_t>(fles::SubsystemIdentifier::FLES);
+      desc.sys_ver =
+          static_cast<uint8_t>(fles::SubsystemFormatFLES::BasicRampPattern);
+      desc.idx = index * num_microslices + m;
+      desc.size = static_cast<uint32_t>(data.size() * sizeof(uint64_t));
+      desc.crc = flesnet_pattern::fold(
+          flesnet_pattern::fill(data.data(), data.size(), c, 0));
+      ts->append_microslice(c, m, desc,
+                            reinterpret_cast<const uint8_t*>(data.data()));
+    }
+  }
+  return ts;
+}
+
+std::string analyze(const std::vector<std::shared_ptr<fles::StorableTimeslice>>&
+                        timeslices,
+                    unsigned num_threads) {
+  std::ostringstream out;
+  {
+    TimesliceAnalyzer analyzer(1, out, "", num_threads);
+    for (const auto& ts : timeslices) {
+      analyzer.put(ts);
+    }
+  }
+  return out.str();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(parallel_matches_serial_test) {
+  std::vector<std::shared_ptr<fles::StorableTimeslice>> timeslices;
+  for (uint64_t i = 0; i < 20; ++i) {
+    timeslices.push_back(make_timeslice(i, 16, 10, 1024));
+  }
+
+  std::string serial = analyze(timeslices, 1);
+  std::string parallel = analyze(timeslices, 4);
+  BOOST_CHECK_EQUAL(serial, parallel);
+  BOOST_CHECK(serial.find("errors") == std::string::npos);
+  BOOST_CHECK(serial.find("timeslices checked: 20 ") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(error_output_test) {
+  std::vector<std::shared_ptr<fles::StorableTimeslice>> timeslices;
+  for (uint64_t i = 0; i < 3; ++i) {
+    timeslices.push_back(make_timeslice(i, 12, 4, 64));
+  }
+  // corrupt two components of the second timeslice
+  const_cast<uint8_t*>(timeslices[1]->content(9, 2))[17] ^= 0x10;
+  const_cast<uint8_t*>(timeslices[1]->content(5, 3))[8] ^= 0x01;
+
+  std::string serial = analyze(timeslices, 1);
+  BOOST_CHECK(serial.find("pattern error in timeslice 1, microslice 3, "
+                          "component 5") != std::string::npos);
+  BOOST_CHECK(serial.find("component 9") == std::string::npos);
+  BOOST_CHECK(serial.find("[1 errors]") != std::string::npos);
+
+  for (unsigned num_threads : {0u, 2u, 3u, 8u}) {
+    BOOST_CHECK_EQUAL(analyze(timeslices, num_threads), serial);
+  }
+}
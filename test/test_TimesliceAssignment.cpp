@@ -0,0 +1,90 @@
+#define BOOST_TEST_MODULE test_TimesliceAssignment
+#include <boost/test/unit_test.hpp>
+
+#include "TimesliceAssignment.hpp"
+#include <vector>
+
+using std::chrono::milliseconds;
+
+BOOST_AUTO_TEST_CASE(select_by_credit_test) {
+  TimesliceAssignment a(4, milliseconds(100));
+  std::vector<uint64_t> free_space = {10, 40, 40, 20};
+  std::vector<bool> usable = {true, true, true, true};
+  auto is_usable = [&](int cn) { return usable[cn]; };
+  auto get_free = [&](int cn) { return free_space[cn]; };
+
+  // ties are resolved starting at the round-robin target
+  BOOST_CHECK(a.select_by_credit(0, is_usable, get_free) == 1);
+  BOOST_CHECK(a.select_by_credit(2, is_usable, get_free) == 2);
+  BOOST_CHECK(a.select_by_credit(7, is_usable, get_free) == 1);
+
+  // a slowed consumer with little free space is avoided
+  free_space = {5, 5, 1, 5};
+  BOOST_CHECK(a.select_by_credit(2, is_usable, get_free) == 3);
+
+  usable = {false, true, false, false};
+  BOOST_CHECK(a.select_by_credit(0, is_usable, get_free) == 1);
+
+  usable = {false, false, false, false};
+  BOOST_CHECK(a.select_by_credit(0, is_usable, get_free) ==
+              TimesliceAssignment::pending);
+}
+
+BOOST_AUTO_TEST_CASE(follow_test) {
+  TimesliceAssignment a(4, milliseconds(100));
+  TimesliceAssignment::clock::time_point t0;
+
+  a.assign(0, 3);
+  a.assign(1, 2);
+  BOOST_CHECK(a.follow(0, false, t0) == 3);
+  a.erase(0);
+  BOOST_CHECK(a.follow(1, false, t0) == 2);
+  a.erase(1);
+
+  // wait for the assignment until the timeout
+  BOOST_CHECK(a.follow(2, false, t0) == TimesliceAssignment::pending);
+  BOOST_CHECK(a.follow(2, false, t0 + milliseconds(99)) ==
+              TimesliceAssignment::pending);
+  a.assign(2, 1);
+  BOOST_CHECK(a.follow(2, false, t0 + milliseconds(150)) == 1);
+  BOOST_CHECK(!a.fallback());
+}
+
+BOOST_AUTO_TEST_CASE(lost_assignment_test) {
+  TimesliceAssignment a(4, milliseconds(100));
+  TimesliceAssignment::clock::time_point t0;
+
+  // a later timeslice has been assigned while a compute node has failed
+  a.assign(6, 0);
+  BOOST_CHECK(a.follow(5, true, t0) == TimesliceAssignment::pending);
+  BOOST_CHECK(a.follow(5, true, t0 + milliseconds(100)) ==
+              TimesliceAssignment::lost);
+  a.erase(5);
+  BOOST_CHECK(a.follow(6, true, t0 + milliseconds(100)) == 0);
+  BOOST_CHECK(!a.fallback());
+}
+
+BOOST_AUTO_TEST_CASE(fallback_test) {
+  TimesliceAssignment a(4, milliseconds(100));
+  TimesliceAssignment::clock::time_point t0;
+
+  // no assignments arrive at all, e.g. the deciding input has stopped
+  BOOST_CHECK(a.follow(5, false, t0) == TimesliceAssignment::pending);
+  BOOST_CHECK(a.follow(5, false, t0 + milliseconds(100)) == 1);
+  BOOST_CHECK(a.fallback());
+
+  // round-robin from now on, late assignments are ignored
+  a.assign(6, 0);
+  BOOST_CHECK(a.follow(6, false, t0 + milliseconds(100)) == 2);
+  BOOST_CHECK(a.follow(7, false, t0 + milliseconds(100)) == 3);
+}
+
+BOOST_AUTO_TEST_CASE(no_timeout_test) {
+  TimesliceAssignment a(4, milliseconds(0));
+  TimesliceAssignment::clock::time_point t0;
+
+  BOOST_CHECK(a.follow(0, false, t0) == TimesliceAssignment::pending);
+  BOOST_CHECK(a.follow(0, false, t0 + std::chrono::hours(1)) ==
+              TimesliceAssignment::pending);
+  BOOST_CHECK(!a.fallback());
+}
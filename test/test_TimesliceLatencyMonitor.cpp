@@ -0,0 +1,61 @@
+#define BOOST_TEST_MODULE test_TimesliceLatencyMonitor
+#include <boost/test/unit_test.hpp>
+
+#include "FlesnetPatternGenerator.hpp"
+#include "MicrosliceReceiver.hpp"
+#include "StorableTimeslice.hpp"
+#include "TimesliceLatencyMonitor.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+
+BOOST_AUTO_TEST_CASE(latency_test) {
+  const uint32_t num_components = 2;
+  const uint32_t num_microslices = 10;
+
+  fles::StorableTimeslice ts(num_microslices, 0);
+  uint64_t before = TimesliceLatencyMonitor::now_ns();
+  for (uint32_t c = 0; c < num_components; ++c) {
+    FlesnetPatternGenerator generator(16, 8, c, 1024, false, false, 0, true);
+    fles::MicrosliceReceiver receiver(generator);
+    ts.append_component(num_microslices);
+    for (uint32_t m = 0; m < num_microslices; ++m) {
+      auto ms = receiver.get();
+      ts.append_microslice(c, m, ms->desc(), ms->content());
+    }
+  }
+  uint64_t after = TimesliceLatencyMonitor::now_ns();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  uint64_t now = TimesliceLatencyMonitor::now_ns();
+  int64_t latency_ns = 0;
+  BOOST_REQUIRE(TimesliceLatencyMonitor::latency(ts, now, latency_ns));
+  BOOST_CHECK_GE(latency_ns, static_cast<int64_t>(now - after));
+  BOOST_CHECK_LE(latency_ns, static_cast<int64_t>(now - before));
+}
+
+BOOST_AUTO_TEST_CASE(trace_test) {
+  const std::string filename = "test_TimesliceLatencyMonitor.csv";
+  auto ts = std::make_shared<fles::StorableTimeslice>(1, 5);
+  ts->append_component(1);
+  fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+  desc.size = 4; // too small for a timestamp
+  uint8_t content[4] = {};
+  ts->append_microslice(0, 0, desc, content);
+
+  {
+    TimesliceLatencyMonitor monitor(filename);
+    monitor.put(ts);
+  }
+
+  std::ifstream in(filename);
+  std::string header;
+  std::string line;
+  std::getline(in, header);
+  std::getline(in, line);
+  BOOST_CHECK_EQUAL(header, "index,bytes,receive_ns,latency_ns");
+  BOOST_CHECK_EQUAL(line.substr(0, 4), "5,4,");
+  BOOST_CHECK_EQUAL(line.back(), ',');
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,145 @@
+#define BOOST_TEST_MODULE test_TimesliceMerger
+#include <boost/test/unit_test.hpp>
+
+#include "StorableTimeslice.hpp"
+#include "TimesliceMerger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+// message timestamp is the 64-bit message value itself
+struct WordTime {
+  uint64_t operator()(const uint8_t* message,
+                      const fles::MicrosliceDescriptor& /* desc */) const {
+    uint64_t word;
+    std::memcpy(&word, message, sizeof(word));
+    return word;
+  }
+};
+
+using WordDecoder = fles::FixedSizeMessageDecoder<sizeof(uint64_t), WordTime>;
+using IndexedWordDecoder =
+    fles::FixedSizeMessageDecoder<sizeof(uint64_t), WordTime, true>;
+
+// Timeslice with `num_components` components of `num_microslices`
+// microslices each, containing ascending random 64-bit timestamps
+fles::StorableTimeslice make_timeslice(uint32_t num_components,
+                                       uint64_t num_microslices,
+                                       std::size_t words_per_microslice,
+                                       std::vector<uint64_t>& all_times) {
+  std::mt19937_64 rng(99);
+  fles::StorableTimeslice ts(static_cast<uint32_t>(num_microslices), 0);
+  for (uint32_t c = 0; c < num_components; ++c) {
+    ts.append_component(num_microslices);
+    for (uint64_t m = 0; m < num_microslices; ++m) {
+      std::vector<uint64_t> words(words_per_microslice);
+      for (auto& w : words) {
+        w = m * 1000 + rng() % 1000;
+      }
+      std::sort(words.begin(), words.end());
+      all_times.insert(all_times.end(), words.begin(), words.end());
+
+      fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+      desc.idx = m * 1000;
+      desc.size = static_cast<uint32_t>(words.size() * sizeof(uint64_t));
+      ts.append_microslice(c, m, desc,
+                           reinterpret_cast<const uint8_t*>(words.data()));
+    }
+  }
+  std::sort(all_times.begin(), all_times.end());
+  return ts;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(microslice_merge_test) {
+  std::vector<uint64_t> all_times;
+  fles::StorableTimeslice ts = make_timeslice(5, 4, 3, all_times);
+
+  fles::TimesliceMerger<fles::MicrosliceMessageDecoder> merger(ts);
+  std::vector<uint64_t> idx;
+  std::vector<uint32_t> components;
+  merger.for_each([&](const fles::MergedMessage& m) {
+    idx.push_back(m.time);
+    components.push_back(m.component);
+  });
+
+  BOOST_REQUIRE_EQUAL(idx.size(), 20);
+  BOOST_CHECK(std::is_sorted(idx.begin(), idx.end()));
+  // equal timestamps in component order
+  for (std::size_t i = 0; i < 5; ++i) {
+    BOOST_CHECK_EQUAL(components[i], i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(message_merge_test) {
+  for (uint32_t num_components : {1u, 2u, 3u, 7u, 16u}) {
+    std::vector<uint64_t> all_times;
+    fles::StorableTimeslice ts =
+        make_timeslice(num_components, 10, 100, all_times);
+
+    fles::TimesliceMerger<WordDecoder> merger(ts);
+    std::vector<uint64_t> merged;
+    merger.for_each(
+        [&merged](const fles::MergedMessage& m) { merged.push_back(m.time); });
+
+    BOOST_CHECK(merged == all_times);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(empty_timeslice_test) {
+  fles::StorableTimeslice ts(1, 0);
+  fles::TimesliceMerger<WordDecoder> merger(ts);
+  fles::MergedMessage m;
+  BOOST_CHECK(!merger.next(m));
+
+  ts.append_component(0);
+  ts.append_component(2);
+  fles::MicrosliceDescriptor desc = fles::MicrosliceDescriptor();
+  ts.append_microslice(1, 0, desc, nullptr);
+  ts.append_microslice(1, 1, desc, nullptr);
+  fles::TimesliceMerger<WordDecoder> merger2(ts);
+  BOOST_CHECK(!merger2.next(m));
+}
+
+BOOST_AUTO_TEST_CASE(parallel_merge_test) {
+  std::vector<uint64_t> all_times;
+  fles::StorableTimeslice ts = make_timeslice(16, 64, 256, all_times);
+
+  std::vector<uint64_t> serial;
+  serial.reserve(all_times.size());
+  fles::TimesliceMerger<WordDecoder> merger(ts);
+  merger.for_each(
+      [&serial](const fles::MergedMessage& m) { serial.push_back(m.time); });
+  BOOST_CHECK(serial == all_times);
+
+  std::vector<uint64_t> split_times{16000, 32000, 48000};
+  std::vector<std::vector<uint64_t>> ranges(split_times.size() + 1);
+  fles::merge_parallel<IndexedWordDecoder>(
+      ts, split_times, [&ranges](std::size_t r, const fles::MergedMessage& m) {
+        ranges[r].push_back(m.time);
+      });
+
+  std::vector<uint64_t> parallel;
+  for (const auto& r : ranges) {
+    parallel.insert(parallel.end(), r.begin(), r.end());
+  }
+  BOOST_CHECK(parallel == all_times);
+
+  // same result when decoding all microslices in each range
+  for (auto& r : ranges) {
+    r.clear();
+  }
+  fles::merge_parallel<WordDecoder>(
+      ts, split_times, [&ranges](std::size_t r, const fles::MergedMessage& m) {
+        ranges[r].push_back(m.time);
+      });
+  parallel.clear();
+  for (const auto& r : ranges) {
+    parallel.insert(parallel.end(), r.begin(), r.end());
+  }
+  BOOST_CHECK(parallel == all_times);
+}
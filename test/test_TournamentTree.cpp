@@ -0,0 +1,56 @@
+#define BOOST_TEST_MODULE test_TournamentTree
+#include <boost/test/unit_test.hpp>
+
+#include "TournamentTree.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+BOOST_AUTO_TEST_CASE(initial_test) {
+  TournamentTree<uint64_t> t(5, 7);
+  BOOST_CHECK_EQUAL(t.size(), 5);
+  BOOST_CHECK_EQUAL(t.min(), 7);
+  BOOST_CHECK_EQUAL(t.min_index(), 0);
+
+  TournamentTree<uint64_t> single(1);
+  BOOST_CHECK_EQUAL(single.min(), 0);
+  single.update(0, 42);
+  BOOST_CHECK_EQUAL(single.min(), 42);
+  BOOST_CHECK_EQUAL(single.min_index(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(update_test) {
+  TournamentTree<uint64_t> t(3);
+  t.update(0, 10);
+  BOOST_CHECK_EQUAL(t.min(), 0);
+  BOOST_CHECK_EQUAL(t.min_index(), 1);
+  t.update(1, 5);
+  t.update(2, 5);
+  BOOST_CHECK_EQUAL(t.min(), 5);
+  BOOST_CHECK_EQUAL(t.min_index(), 1);
+  t.update(1, 20);
+  BOOST_CHECK_EQUAL(t.min(), 5);
+  BOOST_CHECK_EQUAL(t.min_index(), 2);
+  t.update(2, 30);
+  BOOST_CHECK_EQUAL(t.min(), 10);
+  BOOST_CHECK_EQUAL(t.min_index(), 0);
+  BOOST_CHECK_EQUAL(t.value(2), 30);
+}
+
+BOOST_AUTO_TEST_CASE(random_test) {
+  const std::size_t size = 217;
+  std::vector<uint64_t> reference(size, 0);
+  TournamentTree<uint64_t> t(size);
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<std::size_t> index(0, size - 1);
+  std::uniform_int_distribution<uint64_t> step(0, 3);
+  for (int i = 0; i < 100000; ++i) {
+    std::size_t in = index(rng);
+    reference[in] += step(rng);
+    t.update(in, reference[in]);
+    auto it = std::min_element(reference.begin(), reference.end());
+    BOOST_REQUIRE_EQUAL(t.min(), *it);
+    BOOST_REQUIRE_EQUAL(t.min_index(),
+                        static_cast<std::size_t>(it - reference.begin()));
+  }
+}